@@ -0,0 +1,6 @@
+--
+DELETE FROM `rbac_permissions` WHERE `id`=837;
+INSERT INTO `rbac_permissions` (`id`,`name`) VALUES (837,"Command: .server opcodestats");
+
+DELETE FROM `rbac_linked_permissions` WHERE `linkedId`=837;
+INSERT INTO `rbac_linked_permissions` (`id`,`linkedId`) VALUES (196, 837);
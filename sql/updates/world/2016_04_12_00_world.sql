@@ -0,0 +1,4 @@
+--
+DELETE FROM `command` WHERE `permission`=837;
+INSERT INTO `command` (`name`,`permission`,`help`) VALUES ("server opcodestats",837,"Syntax: .server opcodestats [#count|on|off|reset]
+Displays the #count (default 10) client opcodes whose handlers took most time since the last reset.\nUse on/off to enable or disable profiling (see OpcodeProfiler.Enable) and reset to clear the statistics.");
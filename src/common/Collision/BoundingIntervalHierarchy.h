@@ -334,6 +334,79 @@ class TC_COMMON_API BIH
             }
         }
 
+        template<typename IsectCallback>
+        void intersectBox(const G3D::AABox &box, IsectCallback& intersectCallback) const
+        {
+            if (!bounds.intersects(box))
+                return;
+
+            const G3D::Vector3& lo = box.low();
+            const G3D::Vector3& hi = box.high();
+
+            uint32 stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (true) {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    bool BVH2 = (tn & (1 << 29)) != 0;
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            // "normal" interior node
+                            float tl = intBitsToFloat(tree[node + 1]);
+                            float tr = intBitsToFloat(tree[node + 2]);
+                            bool left = lo[axis] <= tl;
+                            bool right = hi[axis] >= tr;
+                            // box is between clip zones
+                            if (!left && !right)
+                                break;
+                            int rightNode = offset + 3;
+                            node = left ? offset : rightNode;
+                            // box overlaps both nodes, push back right node
+                            if (left && right)
+                                stack[stackPos++] = rightNode;
+                            continue;
+                        }
+                        else
+                        {
+                            // leaf - report all objects
+                            int n = tree[node + 1];
+                            while (n > 0) {
+                                intersectCallback(objects[offset]);
+                                --n;
+                                ++offset;
+                            }
+                            break;
+                        }
+                    }
+                    else // BVH2 node (empty space cut off left and right)
+                    {
+                        if (axis>2)
+                            return; // should not happen
+                        float tl = intBitsToFloat(tree[node + 1]);
+                        float tr = intBitsToFloat(tree[node + 2]);
+                        node = offset;
+                        if (tl > hi[axis] || tr < lo[axis])
+                            break;
+                        continue;
+                    }
+                } // traversal loop
+
+                // stack is empty?
+                if (stackPos == 0)
+                    return;
+                // move back up the stack
+                stackPos--;
+                node = stack[stackPos];
+            }
+        }
+
         bool writeToFile(FILE* wf) const;
         bool readFromFile(FILE* rf);
 
@@ -26,6 +26,7 @@
 #include "Timer.h"
 #include "GameObjectModel.h"
 #include "ModelInstance.h"
+#include "RayPacket.h"
 
 #include <G3D/AABox.h>
 #include <G3D/Ray.h>
@@ -246,6 +247,43 @@ bool DynamicMapTree::isInLineOfSight(float x1, float y1, float z1, float x2, flo
     return !callback.did_hit;
 }
 
+uint64 DynamicMapTree::isInLineOfSight(const G3D::Vector3& origin, const G3D::Vector3* targets, uint32 count,
+                                       uint32 phasemask, uint64 rays) const
+{
+    ASSERT(count <= MAX_RAY_PACKET_SIZE);
+
+    RayPacketCandidates<GameObjectModel const*> candidates;
+    auto collect = [&candidates](GameObjectModel const& model)
+    {
+        if (model.isEnabled())
+            candidates.add(model.getBounds(), &model);
+    };
+    impl->intersectBox(RayPacketCandidates<GameObjectModel const*>::getPacketBounds(origin, targets, count), collect);
+
+    if (candidates.empty())
+        return rays;
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (!(rays & (UI64LIT(1) << i)))
+            continue;
+
+        float maxDist = (targets[i] - origin).magnitude();
+        if (!G3D::fuzzyGt(maxDist, 0))
+            continue;
+
+        G3D::Ray ray(origin, (targets[i] - origin) / maxDist);
+        auto intersectModel = [&ray, phasemask](GameObjectModel const* model, float maxDist)
+        {
+            return model->intersectRay(ray, maxDist, true, phasemask);
+        };
+        if (candidates.intersectRay(ray, maxDist, intersectModel))
+            rays &= ~(UI64LIT(1) << i);
+    }
+
+    return rays;
+}
+
 float DynamicMapTree::getHeight(float x, float y, float z, float maxSearchDist, uint32 phasemask) const
 {
     G3D::Vector3 v(x, y, z);
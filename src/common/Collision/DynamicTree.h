@@ -43,6 +43,10 @@ public:
     bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2,
                          float z2, uint32 phasemask) const;
 
+    // tests the rays from origin to the targets selected by rays (up to MAX_RAY_PACKET_SIZE), returns those that are not blocked
+    uint64 isInLineOfSight(const G3D::Vector3& origin, const G3D::Vector3* targets, uint32 count,
+                           uint32 phasemask, uint64 rays) const;
+
     bool getIntersectionTime(uint32 phasemask, const G3D::Ray& ray,
                              const G3D::Vector3& endPos, float& maxDist) const;
 
@@ -22,6 +22,11 @@
 #include <string>
 #include "Define.h"
 
+namespace G3D
+{
+    class Vector3;
+}
+
 //===========================================================
 
 /**
@@ -61,6 +66,11 @@ namespace VMAP
             virtual void unloadMap(unsigned int pMapId) = 0;
 
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
+            /**
+            test the line of sight from one position to up to MAX_RAY_PACKET_SIZE targets at once (world coordinates),
+            bit i of the result is set if targets[i] is visible
+            */
+            virtual uint64 isInLineOfSight(unsigned int pMapId, float x, float y, float z, const G3D::Vector3* targets, uint32 count) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
             test if we hit an object. return true if we hit one. rx, ry, rz will hold the hit position or the dest position, if no intersection was found
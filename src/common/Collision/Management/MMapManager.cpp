@@ -126,15 +126,117 @@ namespace MMAP
         if (!loadMapData(mapId))
             return false;
 
+        // check if we already have this tile loaded
+        {
+            MMapData* mmap = loadedMMaps[mapId];
+            std::lock_guard<std::mutex> lock(mmap->tilesLock);
+            if (mmap->mmapLoadedTiles.count(packTileID(x, y)))
+                return false;
+        }
+
+        uint32 dataSize = 0;
+        unsigned char* data = readTile(basePath, mapId, x, y, dataSize);
+        if (!data)
+            return false;
+
+        return loadMap(mapId, x, y, data, dataSize);
+    }
+
+    bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y, unsigned char* data, uint32 dataSize)
+    {
+        // make sure the mmap is loaded and ready to load tiles
+        if (!loadMapData(mapId))
+        {
+            dtFree(data);
+            return false;
+        }
+
         // get this mmap data
         MMapData* mmap = loadedMMaps[mapId];
         ASSERT(mmap->navMesh);
 
+        return changeTile(mmap, mapId, { x, y, data, dataSize });
+    }
+
+    bool MMapManager::changeTile(MMapData* mmap, uint32 mapId, PendingTileChange const& change)
+    {
+        // never wait for the navmesh here, the calling thread may be the one querying it
+        boost::unique_lock<boost::shared_mutex> lock(mmap->navMeshLock, boost::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            {
+                std::lock_guard<std::mutex> tilesLock(mmap->tilesLock);
+                mmap->pendingTileChanges.push_back(change);
+            }
+
+            // the last query may have finished before the change was queued, the change is applied with the
+            // others then, otherwise by the next writer
+            if (lock.try_lock())
+                applyPendingTileChanges(mmap, mapId);
+
+            return true;
+        }
+
+        applyPendingTileChanges(mmap, mapId);
+
+        if (change.data)
+            return addTile(mmap, mapId, change.x, change.y, change.data, change.dataSize);
+
+        return removeTile(mmap, mapId, change.x, change.y);
+    }
+
+    void MMapManager::applyPendingTileChanges(MMapData* mmap, uint32 mapId)
+    {
+        std::vector<PendingTileChange> changes;
+        {
+            std::lock_guard<std::mutex> lock(mmap->tilesLock);
+            if (mmap->pendingTileChanges.empty())
+                return;
+
+            std::swap(changes, mmap->pendingTileChanges);
+        }
+
+        for (PendingTileChange const& change : changes)
+        {
+            if (change.data)
+                addTile(mmap, mapId, change.x, change.y, change.data, change.dataSize);
+            else
+                removeTile(mmap, mapId, change.x, change.y);
+        }
+    }
+
+    bool MMapManager::addTile(MMapData* mmap, uint32 mapId, int32 x, int32 y, unsigned char* data, uint32 dataSize)
+    {
         // check if we already have this tile loaded
         uint32 packedGridPos = packTileID(x, y);
+        std::lock_guard<std::mutex> lock(mmap->tilesLock);
         if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
+        {
+            dtFree(data);
             return false;
+        }
+
+        dtMeshHeader* header = (dtMeshHeader*)data;
+        dtTileRef tileRef = 0;
+
+        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
+        if (dtStatusSucceed(mmap->navMesh->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, &tileRef)))
+        {
+            mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+            ++loadedTiles;
+            TC_LOG_DEBUG("maps", "MMAP:loadMap: Loaded mmtile %03i[%02i, %02i] into %03i[%02i, %02i]", mapId, x, y, mapId, header->x, header->y);
+            return true;
+        }
+        else
+        {
+            TC_LOG_ERROR("maps", "MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
+            dtFree(data);
+            return false;
+        }
+    }
 
+    unsigned char* MMapManager::readTile(const std::string& basePath, uint32 mapId, int32 x, int32 y, uint32& dataSize)
+    {
         // load this tile :: mmaps/MMMXXYY.mmtile
         uint32 pathLen = basePath.length() + strlen("/%03i%02i%02i.mmtile") + 1;
         char *fileName = new char[pathLen];
@@ -146,7 +248,7 @@ namespace MMAP
         {
             TC_LOG_DEBUG("maps", "MMAP:loadMap: Could not open mmtile file '%s'", fileName);
             delete [] fileName;
-            return false;
+            return nullptr;
         }
         delete [] fileName;
 
@@ -156,7 +258,7 @@ namespace MMAP
         {
             TC_LOG_ERROR("maps", "MMAP:loadMap: Bad header in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
-            return false;
+            return nullptr;
         }
 
         if (fileHeader.mmapVersion != MMAP_VERSION)
@@ -164,7 +266,7 @@ namespace MMAP
             TC_LOG_ERROR("maps", "MMAP:loadMap: %03u%02i%02i.mmtile was built with generator v%i, expected v%i",
                 mapId, x, y, fileHeader.mmapVersion, MMAP_VERSION);
             fclose(file);
-            return false;
+            return nullptr;
         }
 
         unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
@@ -175,28 +277,14 @@ namespace MMAP
         {
             TC_LOG_ERROR("maps", "MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
-            return false;
+            dtFree(data);
+            return nullptr;
         }
 
         fclose(file);
 
-        dtMeshHeader* header = (dtMeshHeader*)data;
-        dtTileRef tileRef = 0;
-
-        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        if (dtStatusSucceed(mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef)))
-        {
-            mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
-            ++loadedTiles;
-            TC_LOG_DEBUG("maps", "MMAP:loadMap: Loaded mmtile %03i[%02i, %02i] into %03i[%02i, %02i]", mapId, x, y, mapId, header->x, header->y);
-            return true;
-        }
-        else
-        {
-            TC_LOG_ERROR("maps", "MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
-            dtFree(data);
-            return false;
-        }
+        dataSize = fileHeader.size;
+        return data;
     }
 
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
@@ -210,10 +298,14 @@ namespace MMAP
             return false;
         }
 
-        MMapData* mmap = itr->second;
+        return changeTile(itr->second, mapId, { x, y, nullptr, 0 });
+    }
 
+    bool MMapManager::removeTile(MMapData* mmap, uint32 mapId, int32 x, int32 y)
+    {
         // check if we have this tile loaded
         uint32 packedGridPos = packTileID(x, y);
+        std::lock_guard<std::mutex> lock(mmap->tilesLock);
         if (mmap->mmapLoadedTiles.find(packedGridPos) == mmap->mmapLoadedTiles.end())
         {
             // file may not exist, therefore not loaded
@@ -255,16 +347,22 @@ namespace MMAP
 
         // unload all tiles from given map
         MMapData* mmap = itr->second;
-        for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
         {
-            uint32 x = (i->first >> 16);
-            uint32 y = (i->first & 0x0000FFFF);
-            if (dtStatusFailed(mmap->navMesh->removeTile(i->second, NULL, NULL)))
-                TC_LOG_ERROR("maps", "MMAP:unloadMap: Could not unload %03u%02i%02i.mmtile from navmesh", mapId, x, y);
-            else
+            // no query may run on the navmesh while it is torn down
+            boost::unique_lock<boost::shared_mutex> lock(mmap->navMeshLock);
+            applyPendingTileChanges(mmap, mapId);
+
+            for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
             {
-                --loadedTiles;
-                TC_LOG_DEBUG("maps", "MMAP:unloadMap: Unloaded mmtile %03i[%02i, %02i] from %03i", mapId, x, y, mapId);
+                uint32 x = (i->first >> 16);
+                uint32 y = (i->first & 0x0000FFFF);
+                if (dtStatusFailed(mmap->navMesh->removeTile(i->second, NULL, NULL)))
+                    TC_LOG_ERROR("maps", "MMAP:unloadMap: Could not unload %03u%02i%02i.mmtile from navmesh", mapId, x, y);
+                else
+                {
+                    --loadedTiles;
+                    TC_LOG_DEBUG("maps", "MMAP:unloadMap: Unloaded mmtile %03i[%02i, %02i] from %03i", mapId, x, y, mapId);
+                }
             }
         }
 
@@ -275,33 +373,6 @@ namespace MMAP
         return true;
     }
 
-    bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
-    {
-        // check if we have this map loaded
-        MMapDataSet::const_iterator itr = GetMMapData(mapId);
-        if (itr == loadedMMaps.end())
-        {
-            // file may not exist, therefore not loaded
-            TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %03u", mapId);
-            return false;
-        }
-
-        MMapData* mmap = itr->second;
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
-        {
-            TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %03u instanceId %u", mapId, instanceId);
-            return false;
-        }
-
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
-
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
-        TC_LOG_DEBUG("maps", "MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
-
-        return true;
-    }
-
     dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     {
         MMapDataSet::const_iterator itr = GetMMapData(mapId);
@@ -311,29 +382,63 @@ namespace MMAP
         return itr->second->navMesh;
     }
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId)
     {
         MMapDataSet::const_iterator itr = GetMMapData(mapId);
         if (itr == loadedMMaps.end())
             return NULL;
 
         MMapData* mmap = itr->second;
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        std::thread::id threadId = std::this_thread::get_id();
+
+        std::lock_guard<std::mutex> lock(mmap->navMeshQueriesLock);
+        NavMeshQuerySet::const_iterator queryItr = mmap->navMeshQueries.find(threadId);
+        if (queryItr != mmap->navMeshQueries.end())
+            return queryItr->second;
+
+        // allocate mesh query
+        dtNavMeshQuery* query = dtAllocNavMeshQuery();
+        ASSERT(query);
+        if (dtStatusFailed(query->init(mmap->navMesh, 1024)))
         {
-            // allocate mesh query
-            dtNavMeshQuery* query = dtAllocNavMeshQuery();
-            ASSERT(query);
-            if (dtStatusFailed(query->init(mmap->navMesh, 1024)))
-            {
-                dtFreeNavMeshQuery(query);
-                TC_LOG_ERROR("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-                return NULL;
-            }
+            dtFreeNavMeshQuery(query);
+            TC_LOG_ERROR("maps", "MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u", mapId);
+            return NULL;
+        }
+
+        TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u, %u threads use the navmesh", mapId, uint32(mmap->navMeshQueries.size() + 1));
+        mmap->navMeshQueries.insert(NavMeshQuerySet::value_type(threadId, query));
+        return query;
+    }
 
-            TC_LOG_DEBUG("maps", "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
+    // ######################## NavMeshReadGuard ########################
+    NavMeshReadGuard::NavMeshReadGuard(MMapManager* manager, uint32 mapId) : _manager(manager), _data(nullptr), _mapId(mapId)
+    {
+        MMapDataSet::const_iterator itr = manager->GetMMapData(mapId);
+        if (itr == manager->loadedMMaps.end())
+            return;
+
+        _data = itr->second;
+        _data->navMeshLock.lock_shared();
+    }
+
+    NavMeshReadGuard::~NavMeshReadGuard()
+    {
+        if (!_data)
+            return;
+
+        _data->navMeshLock.unlock_shared();
+
+        {
+            std::lock_guard<std::mutex> lock(_data->tilesLock);
+            if (_data->pendingTileChanges.empty())
+                return;
         }
 
-        return mmap->navMeshQueries[instanceId];
+        // apply the tile changes queued while we were querying, unless someone else still queries
+        // the navmesh - then it is up to them
+        boost::unique_lock<boost::shared_mutex> lock(_data->navMeshLock, boost::try_to_lock);
+        if (lock.owns_lock())
+            _manager->applyPendingTileChanges(_data, _mapId);
     }
 }
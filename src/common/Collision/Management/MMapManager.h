@@ -23,7 +23,12 @@
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
 
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -31,7 +36,16 @@
 namespace MMAP
 {
     typedef std::unordered_map<uint32, dtTileRef> MMapTileSet;
-    typedef std::unordered_map<uint32, dtNavMeshQuery*> NavMeshQuerySet;
+    typedef std::unordered_map<std::thread::id, dtNavMeshQuery*> NavMeshQuerySet;
+
+    // tile added or removed while the navmesh was queried, data is nullptr for removals
+    struct PendingTileChange
+    {
+        int32 x;
+        int32 y;
+        unsigned char* data;
+        uint32 dataSize;
+    };
 
     // dummy struct to hold map's mmap data
     struct MMapData
@@ -42,36 +56,74 @@ namespace MMAP
             for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
                 dtFreeNavMeshQuery(i->second);
 
+            for (PendingTileChange const& change : pendingTileChanges)
+                if (change.data)
+                    dtFree(change.data);
+
             if (navMesh)
                 dtFreeNavMesh(navMesh);
         }
 
         dtNavMesh* navMesh;
 
-        // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
-        NavMeshQuerySet navMeshQueries;     // instanceId to query
+        // the navmesh is shared by all threads and instances, it is only modified while holding
+        // navMeshLock exclusively, queries hold it shared (see NavMeshReadGuard)
+        boost::shared_mutex navMeshLock;
+
+        // dtNavMeshQuery is not thread safe, every thread gets its own one
+        std::mutex navMeshQueriesLock;
+        NavMeshQuerySet navMeshQueries;     // thread to query
+
+        std::mutex tilesLock;
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
+        std::vector<PendingTileChange> pendingTileChanges;
     };
 
 
     typedef std::unordered_map<uint32, MMapData*> MMapDataSet;
 
+    class MMapManager;
+
+    // keeps the navmesh of a map unchanged while it is alive
+    // tiles loaded or unloaded meanwhile are queued and applied once the last guard is released,
+    // so threads loading grids never wait for path calculations to finish
+    class TC_COMMON_API NavMeshReadGuard
+    {
+        public:
+            NavMeshReadGuard(MMapManager* manager, uint32 mapId);
+            ~NavMeshReadGuard();
+
+        private:
+            NavMeshReadGuard(NavMeshReadGuard const&) = delete;
+            NavMeshReadGuard& operator=(NavMeshReadGuard const&) = delete;
+
+            MMapManager* _manager;
+            MMapData* _data;
+            uint32 _mapId;
+    };
+
     // singleton class
     // holds all all access to mmap loading unloading and meshes
     class TC_COMMON_API MMapManager
     {
+        friend class NavMeshReadGuard;
+
         public:
             MMapManager() : loadedTiles(0), thread_safe_environment(true) {}
             ~MMapManager();
 
             void InitializeThreadUnsafe(const std::vector<uint32>& mapIds);
             bool loadMap(const std::string& basePath, uint32 mapId, int32 x, int32 y);
+            // adds tile data previously read by readTile, takes ownership of the data
+            bool loadMap(uint32 mapId, int32 x, int32 y, unsigned char* data, uint32 dataSize);
+            // reads and validates the tile file without touching the navmesh, safe to call from any thread
+            // returned data is allocated with dtAlloc
+            static unsigned char* readTile(const std::string& basePath, uint32 mapId, int32 x, int32 y, uint32& dataSize);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
-            bool unloadMapInstance(uint32 mapId, uint32 instanceId);
 
-            // the returned [dtNavMeshQuery const*] is NOT threadsafe
-            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
+            // returns the query of the calling thread, hold a NavMeshReadGuard while using it
+            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
@@ -80,9 +132,17 @@ namespace MMAP
             bool loadMapData(uint32 mapId);
             uint32 packTileID(int32 x, int32 y);
 
+            // must be called with navMeshLock held exclusively
+            bool addTile(MMapData* mmap, uint32 mapId, int32 x, int32 y, unsigned char* data, uint32 dataSize);
+            bool removeTile(MMapData* mmap, uint32 mapId, int32 x, int32 y);
+            void applyPendingTileChanges(MMapData* mmap, uint32 mapId);
+
+            // applies the change now if nobody queries the navmesh, queues it otherwise
+            bool changeTile(MMapData* mmap, uint32 mapId, PendingTileChange const& change);
+
             MMapDataSet::const_iterator GetMMapData(uint32 mapId) const;
             MMapDataSet loadedMMaps;
-            uint32 loadedTiles;
+            std::atomic<uint32> loadedTiles;
             bool thread_safe_environment;
     };
 }
@@ -22,6 +22,7 @@
 #include <sstream>
 #include "VMapManager2.h"
 #include "MapTree.h"
+#include "RayPacket.h"
 #include "ModelInstance.h"
 #include "WorldModel.h"
 #include <G3D/Vector3.h>
@@ -181,6 +182,24 @@ namespace VMAP
         return true;
     }
 
+    uint64 VMapManager2::isInLineOfSight(unsigned int mapId, float x, float y, float z, const G3D::Vector3* targets, uint32 count)
+    {
+        uint64 all = count < 64 ? (UI64LIT(1) << count) - 1 : ~UI64LIT(0);
+        if (!isLineOfSightCalcEnabled() || IsVMAPDisabledForPtr(mapId, VMAP_DISABLE_LOS))
+            return all;
+
+        InstanceTreeMap::const_iterator instanceTree = GetMapTree(mapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return all;
+
+        ASSERT(count <= MAX_RAY_PACKET_SIZE);
+        Vector3 internalTargets[MAX_RAY_PACKET_SIZE];
+        for (uint32 i = 0; i < count; ++i)
+            internalTargets[i] = convertPositionToInternalRep(targets[i].x, targets[i].y, targets[i].z);
+
+        return instanceTree->second->isInLineOfSight(convertPositionToInternalRep(x, y, z), internalTargets, count);
+    }
+
     /**
     get the hit position and return true if we hit something
     otherwise the result pos will be the dest pos
@@ -281,23 +300,39 @@ namespace VMAP
 
     WorldModel* VMapManager2::acquireModelInstance(const std::string& basepath, const std::string& filename)
     {
-        //! Critical section, thread safe access to iLoadedModelFiles
+        {
+            //! Critical section, thread safe access to iLoadedModelFiles
+            std::lock_guard<std::mutex> lock(LoadedModelFilesLock);
+
+            ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
+            if (model != iLoadedModelFiles.end())
+            {
+                model->second.incRefCount();
+                return model->second.getModel();
+            }
+        }
+
+        // read the file outside of the lock, other threads only wait for it when they need the very same model
+        WorldModel* worldmodel = new WorldModel();
+        if (!worldmodel->readFile(basepath + filename + ".vmo"))
+        {
+            VMAP_ERROR_LOG("misc", "VMapManager2: could not load '%s%s.vmo'", basepath.c_str(), filename.c_str());
+            delete worldmodel;
+            return NULL;
+        }
+
         std::lock_guard<std::mutex> lock(LoadedModelFilesLock);
 
         ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
         if (model == iLoadedModelFiles.end())
         {
-            WorldModel* worldmodel = new WorldModel();
-            if (!worldmodel->readFile(basepath + filename + ".vmo"))
-            {
-                VMAP_ERROR_LOG("misc", "VMapManager2: could not load '%s%s.vmo'", basepath.c_str(), filename.c_str());
-                delete worldmodel;
-                return NULL;
-            }
             VMAP_DEBUG_LOG("maps", "VMapManager2: loading file '%s%s'", basepath.c_str(), filename.c_str());
             model = iLoadedModelFiles.insert(std::pair<std::string, ManagedModel>(filename, ManagedModel())).first;
             model->second.setModel(worldmodel);
         }
+        else // loaded by another thread in the meantime
+            delete worldmodel;
+
         model->second.incRefCount();
         return model->second.getModel();
     }
@@ -321,6 +356,35 @@ namespace VMAP
         }
     }
 
+    void VMapManager2::preloadMapTile(const std::string& basePath, unsigned int mapId, int x, int y, std::vector<std::string>& acquiredModels)
+    {
+        if (!isMapLoadingEnabled())
+            return;
+
+        std::string tileFile = basePath + StaticMapTree::getTileFileName(mapId, x, y);
+        FILE* tf = fopen(tileFile.c_str(), "rb");
+        if (!tf)
+            return;
+
+        char chunk[8];
+        uint32 numSpawns = 0;
+        if (readChunk(tf, chunk, VMAP_MAGIC, 8) && fread(&numSpawns, sizeof(uint32), 1, tf) == 1)
+        {
+            for (uint32 i = 0; i < numSpawns; ++i)
+            {
+                ModelSpawn spawn;
+                uint32 referencedVal;
+                if (!ModelSpawn::readFromFile(tf, spawn) || fread(&referencedVal, sizeof(uint32), 1, tf) != 1)
+                    break;
+
+                if (acquireModelInstance(basePath, spawn.name))
+                    acquiredModels.push_back(spawn.name);
+            }
+        }
+
+        fclose(tf);
+    }
+
     bool VMapManager2::existsMap(const char* basePath, unsigned int mapId, int x, int y)
     {
         return StaticMapTree::CanLoadMap(std::string(basePath), mapId, x, y);
@@ -108,6 +108,7 @@ namespace VMAP
             void unloadMap(unsigned int mapId) override;
 
             bool isInLineOfSight(unsigned int mapId, float x1, float y1, float z1, float x2, float y2, float z2) override ;
+            uint64 isInLineOfSight(unsigned int mapId, float x, float y, float z, const G3D::Vector3* targets, uint32 count) override;
             /**
             fill the hit pos and return true, if an object was hit
             */
@@ -122,6 +123,10 @@ namespace VMAP
             WorldModel* acquireModelInstance(const std::string& basepath, const std::string& filename);
             void releaseModelInstance(const std::string& filename);
 
+            // Thread safe: acquires the models spawned in a tile without touching the map trees, so a later
+            // loadMap of that tile finds them loaded. Every model added to acquiredModels must be released.
+            void preloadMapTile(const std::string& basePath, unsigned int mapId, int x, int y, std::vector<std::string>& acquiredModels);
+
             // what's the use of this? o.O
             virtual std::string getDirFileName(unsigned int mapId, int /*x*/, int /*y*/) const override
             {
@@ -20,6 +20,7 @@
 #include "ModelInstance.h"
 #include "VMapManager2.h"
 #include "VMapDefinitions.h"
+#include "RayPacket.h"
 #include "Log.h"
 #include "Errors.h"
 
@@ -174,6 +175,48 @@ namespace VMAP
     }
     //=========================================================
     /**
+    Checks the line of sight from origin to up to MAX_RAY_PACKET_SIZE targets at once.
+    Bit i of the result is set if targets[i] is visible.
+    */
+
+    uint64 StaticMapTree::isInLineOfSight(const Vector3& origin, const Vector3* targets, uint32 count) const
+    {
+        ASSERT(count <= MAX_RAY_PACKET_SIZE);
+
+        RayPacketCandidates<ModelInstance const*> candidates;
+        auto collect = [this, &candidates](uint32 entry)
+        {
+            candidates.add(iTreeValues[entry].getBounds(), &iTreeValues[entry]);
+        };
+        iTree.intersectBox(RayPacketCandidates<ModelInstance const*>::getPacketBounds(origin, targets, count), collect);
+
+        uint64 visible = 0;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            float maxDist = (targets[i] - origin).magnitude();
+            // same guards as the single ray version
+            if (maxDist == std::numeric_limits<float>::max() || !std::isfinite(maxDist))
+                continue;
+
+            if (maxDist < 1e-10f || candidates.empty())
+            {
+                visible |= UI64LIT(1) << i;
+                continue;
+            }
+
+            G3D::Ray ray = G3D::Ray::fromOriginAndDirection(origin, (targets[i] - origin) / maxDist);
+            auto intersectModel = [&ray](ModelInstance const* model, float maxDist)
+            {
+                return model->intersectRay(ray, maxDist, true);
+            };
+            if (!candidates.intersectRay(ray, maxDist, intersectModel))
+                visible |= UI64LIT(1) << i;
+        }
+
+        return visible;
+    }
+    //=========================================================
+    /**
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
     Return the hit pos or the original dest pos
     */
@@ -22,6 +22,8 @@
 #include <G3D/Vector3.h>
 #include <G3D/Matrix3.h>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 
 #include "ModelInstance.h"
@@ -62,6 +64,7 @@ namespace VMAP
     };
 
     typedef std::map<uint32, MapSpawns*> MapData;
+    typedef std::set<std::string> ModelFileSet;
     //===============================================
 
     struct TC_COMMON_API GroupModel_Raw
@@ -99,13 +102,21 @@ namespace VMAP
             G3D::Table<std::string, unsigned int > iUniqueNameIds;
             unsigned int iCurrentUniqueNameId;
             MapData mapData;
-            std::set<std::string> spawnedModelFiles;
+            ModelFileSet spawnedModelFiles;
+            uint32 iThreads;
+
+            // raw models read while calculating spawn bounds, most M2s are spawned many times
+            std::map<std::string, std::shared_ptr<WorldModel_Raw>> iRawModels;
+            std::mutex iRawModelsLock;
+
+            std::shared_ptr<WorldModel_Raw> getRawModel(const std::string& pModelFilename);
 
         public:
-            TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName);
+            TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName, uint32 threads = 1);
             virtual ~TileAssembler();
 
             bool convertWorld2();
+            bool convertMap(uint32 mapID, MapSpawns& spawns, ModelFileSet& modelFiles);
             bool readMapSpawns();
             bool calculateTransformedBound(ModelSpawn &spawn);
             void exportGameobjectModels();
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RAYPACKET_H
+#define _RAYPACKET_H
+
+#include "Define.h"
+
+#include <G3D/AABox.h>
+#include <G3D/Ray.h>
+#include <G3D/Vector3.h>
+
+#include <algorithm>
+#include <vector>
+
+/// Rays are tested in packets of this size, results are returned as bitmasks
+#define MAX_RAY_PACKET_SIZE 64
+
+/**
+    Bounds of the objects a packet of rays sharing one origin can hit.
+
+    The tree is traversed only once per packet with the box around all rays
+    to collect the candidates, whose bounds are then tested against each ray.
+    Bounds are stored per coordinate so the ray/box tests of one ray against
+    all candidates are a plain loop the compiler turns into vector instructions.
+*/
+template<class T>
+class RayPacketCandidates
+{
+    public:
+        static G3D::AABox getPacketBounds(const G3D::Vector3& origin, const G3D::Vector3* targets, uint32 count)
+        {
+            G3D::Vector3 lo = origin, hi = origin;
+            for (uint32 i = 0; i < count; ++i)
+            {
+                lo = lo.min(targets[i]);
+                hi = hi.max(targets[i]);
+            }
+            return G3D::AABox(lo, hi);
+        }
+
+        void clear()
+        {
+            _loX.clear(); _loY.clear(); _loZ.clear();
+            _hiX.clear(); _hiY.clear(); _hiZ.clear();
+            _objects.clear();
+        }
+
+        bool empty() const { return _objects.empty(); }
+
+        void add(const G3D::AABox& bounds, T object)
+        {
+            _loX.push_back(bounds.low().x);  _loY.push_back(bounds.low().y);  _loZ.push_back(bounds.low().z);
+            _hiX.push_back(bounds.high().x); _hiY.push_back(bounds.high().y); _hiZ.push_back(bounds.high().z);
+            _objects.push_back(object);
+        }
+
+        /// Calls callback(object, maxDist) for every candidate whose bounds the ray passes within maxDist,
+        /// stops and returns true as soon as the callback reports a hit
+        template<typename HitCallback>
+        bool intersectRay(const G3D::Ray& ray, float maxDist, HitCallback& callback)
+        {
+            uint32 count = uint32(_objects.size());
+            _hits.resize(count);
+
+            // axis parallel rays get a huge but finite inverse to keep NaNs out of the slab test
+            float ox = ray.origin().x, oy = ray.origin().y, oz = ray.origin().z;
+            float ix = 1.0f / (ray.direction().x != 0.0f ? ray.direction().x : 1e-30f);
+            float iy = 1.0f / (ray.direction().y != 0.0f ? ray.direction().y : 1e-30f);
+            float iz = 1.0f / (ray.direction().z != 0.0f ? ray.direction().z : 1e-30f);
+
+            float const* loX = _loX.data(); float const* loY = _loY.data(); float const* loZ = _loZ.data();
+            float const* hiX = _hiX.data(); float const* hiY = _hiY.data(); float const* hiZ = _hiZ.data();
+            uint8* hits = _hits.data();
+
+            for (uint32 i = 0; i < count; ++i)
+            {
+                float x1 = (loX[i] - ox) * ix, x2 = (hiX[i] - ox) * ix;
+                float y1 = (loY[i] - oy) * iy, y2 = (hiY[i] - oy) * iy;
+                float z1 = (loZ[i] - oz) * iz, z2 = (hiZ[i] - oz) * iz;
+                float tNear = std::max(std::max(std::min(x1, x2), std::min(y1, y2)), std::max(std::min(z1, z2), 0.0f));
+                float tFar = std::min(std::min(std::max(x1, x2), std::max(y1, y2)), std::min(std::max(z1, z2), maxDist));
+                hits[i] = uint8(tNear <= tFar);
+            }
+
+            for (uint32 i = 0; i < count; ++i)
+                if (hits[i] && callback(_objects[i], maxDist))
+                    return true;
+
+            return false;
+        }
+
+    private:
+        std::vector<float> _loX, _loY, _loZ;
+        std::vector<float> _hiX, _hiY, _hiZ;
+        std::vector<T> _objects;
+        std::vector<uint8> _hits;
+};
+
+#endif // _RAYPACKET_H
@@ -194,6 +194,17 @@ public:
             node->intersectPoint(point, intersectCallback);
     }
 
+    template<typename IsectCallback>
+    void intersectBox(const G3D::AABox& box, IsectCallback& intersectCallback)
+    {
+        Cell low = Cell::ComputeCell(box.low().x, box.low().y);
+        Cell high = Cell::ComputeCell(box.high().x, box.high().y);
+        for (int x = std::max(low.x, 0); x <= std::min(high.x, int(CELL_NUMBER) - 1); ++x)
+            for (int y = std::max(low.y, 0); y <= std::min(high.y, int(CELL_NUMBER) - 1); ++y)
+                if (Node* node = nodes[x][y])
+                    node->intersectBox(box, intersectCallback);
+    }
+
     // Optimized verson of intersectRay function for rays with vertical directions
     template<typename RayCallback>
     void intersectZAllignedRay(const G3D::Ray& ray, RayCallback& intersectCallback, float& max_dist)
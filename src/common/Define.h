@@ -64,10 +64,14 @@
 #  ifndef DECLSPEC_DEPRECATED
 #    define DECLSPEC_DEPRECATED __declspec(deprecated)
 #  endif //DECLSPEC_DEPRECATED
+#  ifndef DECLSPEC_ALIGN
+#    define DECLSPEC_ALIGN(N) __declspec(align(N))
+#  endif //DECLSPEC_ALIGN
 #else //PLATFORM != PLATFORM_WINDOWS
 #  define TRINITY_PATH_MAX PATH_MAX
 #  define DECLSPEC_NORETURN
 #  define DECLSPEC_DEPRECATED
+#  define DECLSPEC_ALIGN(N) __attribute__((__aligned__(N)))
 #endif //PLATFORM
 
 #if !defined(COREDEBUG)
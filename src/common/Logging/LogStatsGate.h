@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_LOGSTATSGATE_H
+#define TRINITY_LOGSTATSGATE_H
+
+#include "Define.h"
+
+#include <atomic>
+
+/**
+ * Tells hot paths whether their statistics counters are read at all.
+ *
+ * Counters shared by all map threads are expensive to update, they should only be touched while
+ * IsEnabled() returns true. The periodic function logging the counters calls Refresh(), which
+ * checks whether the debug log of the category is enabled.
+ */
+class TC_COMMON_API LogStatsGate
+{
+    public:
+        explicit LogStatsGate(char const* category) : _category(category), _enabled(false) { }
+
+        bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+        /// Checks the log configuration again, returns whether the statistics should be logged now
+        bool Refresh();
+
+    private:
+        char const* _category;
+        std::atomic<bool> _enabled;
+};
+
+#endif
@@ -19,6 +19,8 @@
 #define MPSCQueue_h__
 
 #include <atomic>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 // C++ implementation of Dmitry Vyukov's lock free MPSC queue
@@ -80,4 +82,80 @@ private:
     MPSCQueue& operator=(MPSCQueue const&) = delete;
 };
 
+// Intrusive variant of MPSCQueue, the link to the next element is stored in the element itself
+// so Enqueue does not allocate. An element can only be in one queue using the same link at a time.
+// http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+template<typename T, std::atomic<T*> T::* IntrusiveLink>
+class MPSCQueueIntrusive
+{
+public:
+    MPSCQueueIntrusive() : _dummyPtr(reinterpret_cast<T*>(&_dummy)), _head(_dummyPtr), _tail(_dummyPtr)
+    {
+        // _dummy is never constructed as T, only its link is used
+        std::atomic<T*>* dummyNext = new (&(_dummyPtr->*IntrusiveLink)) std::atomic<T*>();
+        dummyNext->store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~MPSCQueueIntrusive()
+    {
+        T* output;
+        while (Dequeue(output))
+            delete output;
+    }
+
+    void Enqueue(T* input)
+    {
+        (input->*IntrusiveLink).store(nullptr, std::memory_order_release);
+        T* prevHead = _head.exchange(input, std::memory_order_acq_rel);
+        (prevHead->*IntrusiveLink).store(input, std::memory_order_release);
+    }
+
+    bool Dequeue(T*& result)
+    {
+        T* tail = _tail.load(std::memory_order_relaxed);
+        T* next = (tail->*IntrusiveLink).load(std::memory_order_acquire);
+        if (tail == _dummyPtr)
+        {
+            if (!next)
+                return false;
+
+            _tail.store(next, std::memory_order_release);
+            tail = next;
+            next = (next->*IntrusiveLink).load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            _tail.store(next, std::memory_order_release);
+            result = tail;
+            return true;
+        }
+
+        T* head = _head.load(std::memory_order_acquire);
+        if (tail != head)
+            return false;   // a producer is in the middle of Enqueue
+
+        // tail is the last element, push the dummy behind it to be able to take it out
+        Enqueue(_dummyPtr);
+        next = (tail->*IntrusiveLink).load(std::memory_order_acquire);
+        if (next)
+        {
+            _tail.store(next, std::memory_order_release);
+            result = tail;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _dummy;
+    T* _dummyPtr;
+    std::atomic<T*> _head;
+    std::atomic<T*> _tail;
+
+    MPSCQueueIntrusive(MPSCQueueIntrusive const&) = delete;
+    MPSCQueueIntrusive& operator=(MPSCQueueIntrusive const&) = delete;
+};
+
 #endif // MPSCQueue_h__
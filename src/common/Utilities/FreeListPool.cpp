@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FreeListPool.h"
+#include "Log.h"
+
+#include <boost/thread/tss.hpp>
+#include <new>
+
+// sizes are rounded up to multiples of the granularity, larger blocks are not pooled
+#define FREE_LIST_GRANULARITY 16
+#define FREE_LIST_MAX_SIZE 1024
+#define FREE_LIST_COUNT (FREE_LIST_MAX_SIZE / FREE_LIST_GRANULARITY)
+
+// blocks kept per free list and thread, the rest goes back to the heap
+#define FREE_LIST_MAX_BLOCKS 4096
+
+std::atomic<uint64> FreeListPool::_allocations(0);
+std::atomic<uint64> FreeListPool::_reused(0);
+LogStatsGate FreeListPool::_statsGate("misc");
+
+namespace
+{
+    struct FreeBlock
+    {
+        FreeBlock* Next;
+    };
+
+    struct FreeLists
+    {
+        FreeLists()
+        {
+            for (uint32 i = 0; i < FREE_LIST_COUNT; ++i)
+            {
+                Heads[i] = nullptr;
+                Sizes[i] = 0;
+            }
+        }
+
+        ~FreeLists()
+        {
+            for (uint32 i = 0; i < FREE_LIST_COUNT; ++i)
+            {
+                while (FreeBlock* block = Heads[i])
+                {
+                    Heads[i] = block->Next;
+                    ::operator delete(block);
+                }
+            }
+        }
+
+        FreeBlock* Heads[FREE_LIST_COUNT];
+        uint32 Sizes[FREE_LIST_COUNT];
+    };
+
+    // set once the storage is gone, objects freed by static destructors after that go straight back to the heap
+    bool freeListsDestroyed = false;
+
+    struct ThreadFreeLists
+    {
+        ~ThreadFreeLists() { freeListsDestroyed = true; }
+
+        boost::thread_specific_ptr<FreeLists> Lists;
+    } threadFreeLists;
+
+    FreeLists* GetFreeLists(bool create)
+    {
+        if (freeListsDestroyed)
+            return nullptr;
+
+        FreeLists* lists = threadFreeLists.Lists.get();
+
+        if (!lists && create)
+        {
+            lists = new FreeLists();
+            threadFreeLists.Lists.reset(lists);
+        }
+
+        return lists;
+    }
+
+    inline uint32 GetFreeListIndex(std::size_t size)
+    {
+        return uint32((size + FREE_LIST_GRANULARITY - 1) / FREE_LIST_GRANULARITY) - 1;
+    }
+}
+
+void* FreeListPool::Allocate(std::size_t size)
+{
+    bool statsEnabled = _statsGate.IsEnabled();
+    if (statsEnabled)
+        ++_allocations;
+
+    if (!size || size > FREE_LIST_MAX_SIZE)
+        return ::operator new(size);
+
+    uint32 index = GetFreeListIndex(size);
+    FreeLists* freeLists = GetFreeLists(true);
+    if (FreeBlock* block = freeLists ? freeLists->Heads[index] : nullptr)
+    {
+        freeLists->Heads[index] = block->Next;
+        --freeLists->Sizes[index];
+        if (statsEnabled)
+            ++_reused;
+        return block;
+    }
+
+    // allocate the full size of the free list so the block can be reused for any size of it
+    return ::operator new((index + 1) * FREE_LIST_GRANULARITY);
+}
+
+void FreeListPool::Free(void* ptr, std::size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (!size || size > FREE_LIST_MAX_SIZE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    // the free lists of this thread are already cleaned up, or were never needed
+    FreeLists* freeLists = GetFreeLists(false);
+    if (!freeLists)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    uint32 index = GetFreeListIndex(size);
+    if (freeLists->Sizes[index] >= FREE_LIST_MAX_BLOCKS)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->Next = freeLists->Heads[index];
+    freeLists->Heads[index] = block;
+    ++freeLists->Sizes[index];
+}
+
+void FreeListPool::LogStats()
+{
+    bool statsEnabled = _statsGate.Refresh();
+
+    uint64 allocations = _allocations.exchange(0);
+    uint64 reused = _reused.exchange(0);
+
+    if (!allocations || !statsEnabled)
+        return;
+
+    TC_LOG_DEBUG("misc", "FreeListPool: " UI64FMTD " allocations, %.1f%% served from free lists",
+        allocations, float(reused) * 100.0f / float(allocations));
+}
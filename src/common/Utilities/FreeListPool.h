@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_FREELISTPOOL_H
+#define TRINITY_FREELISTPOOL_H
+
+#include "Define.h"
+#include "LogStatsGate.h"
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Memory of small objects that are created and destroyed at a high rate, like auras.
+ *
+ * Freed blocks are kept in free lists of the freeing thread, sorted by size, and handed out again
+ * by the next allocation of that size on the thread. Objects may be freed on another thread than
+ * they were allocated on, e.g. when their owner moved to another map, their memory then stays
+ * with the freeing thread. Use it through class specific operator new and delete.
+ */
+class TC_COMMON_API FreeListPool
+{
+    public:
+        static void* Allocate(std::size_t size);
+        static void Free(void* ptr, std::size_t size);
+
+        /// Writes the allocation count and the share served from free lists to the log and resets the counters
+        static void LogStats();
+
+    private:
+        static std::atomic<uint64> _allocations;
+        static std::atomic<uint64> _reused;
+        static LogStatsGate _statsGate;
+};
+
+#endif
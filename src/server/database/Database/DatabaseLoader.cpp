@@ -51,7 +51,15 @@ DatabaseLoader& DatabaseLoader::AddDatabase(DatabaseWorkerPool<T>& pool, std::st
 
         uint8 const synchThreads = uint8(sConfigMgr->GetIntDefault(name + "Database.SynchThreads", 1));
 
-        pool.SetConnectionInfo(dbString, asyncThreads, synchThreads);
+        uint8 const bulkThreads = uint8(sConfigMgr->GetIntDefault(name + "Database.BulkWorkerThreads", 0));
+        if (bulkThreads > 32)
+        {
+            TC_LOG_ERROR(_logger, "%s database: invalid number of bulk worker threads specified. "
+                "Please pick a value between 0 and 32.", name.c_str());
+            return false;
+        }
+
+        pool.SetConnectionInfo(dbString, asyncThreads, synchThreads, bulkThreads);
         if (uint32 error = pool.Open())
         {
             // Database does not exist
@@ -51,6 +51,7 @@ void DatabaseWorker::WorkerThread()
         if (_cancelationToken || !operation)
             return;
 
+        operation->SetDequeued();
         operation->SetConnection(_connection);
         operation->call();
 
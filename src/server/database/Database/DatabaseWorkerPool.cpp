@@ -23,9 +23,11 @@
 
 template <class T>
 DatabaseWorkerPool<T>::DatabaseWorkerPool()
-    : _queue(new ProducerConsumerQueue<SQLOperation*>()),
-      _async_threads(0), _synch_threads(0)
+    : _async_threads(0), _synch_threads(0), _bulk_threads(0)
 {
+    for (auto& queue : _queues)
+        queue = Trinity::make_unique<ProducerConsumerQueue<SQLOperation*>>();
+
     WPFatal(mysql_thread_safe(), "Used MySQL library isn't thread-safe.");
     WPFatal(mysql_get_client_version() >= MIN_MYSQL_CLIENT_VERSION, "TrinityCore does not support MySQL versions below 5.1");
     WPFatal(mysql_get_client_version() == MYSQL_VERSION_ID, "Used MySQL library version (%s) does not match the version used to compile TrinityCore (%s).",
@@ -34,12 +36,13 @@ DatabaseWorkerPool<T>::DatabaseWorkerPool()
 
 template <class T>
 void DatabaseWorkerPool<T>::SetConnectionInfo(std::string const& infoString,
-    uint8 const asyncThreads, uint8 const synchThreads)
+    uint8 const asyncThreads, uint8 const synchThreads, uint8 const bulkThreads /*= 0*/)
 {
     _connectionInfo = Trinity::make_unique<MySQLConnectionInfo>(infoString);
 
     _async_threads = asyncThreads;
     _synch_threads = synchThreads;
+    _bulk_threads = bulkThreads;
 }
 
 template <class T>
@@ -48,11 +51,16 @@ uint32 DatabaseWorkerPool<T>::Open()
     WPFatal(_connectionInfo.get(), "Connection info was not set!");
 
     TC_LOG_INFO("sql.driver", "Opening DatabasePool '%s'. "
-        "Asynchronous connections: %u, synchronous connections: %u.",
-        GetDatabaseName(), _async_threads, _synch_threads);
+        "Asynchronous connections: %u (bulk: %u), synchronous connections: %u.",
+        GetDatabaseName(), _async_threads, _bulk_threads, _synch_threads);
 
     uint32 error = OpenConnections(IDX_ASYNC, _async_threads);
 
+    if (error)
+        return error;
+
+    error = OpenConnections(IDX_ASYNC_BULK, _bulk_threads);
+
     if (error)
         return error;
 
@@ -62,7 +70,7 @@ uint32 DatabaseWorkerPool<T>::Open()
     {
         TC_LOG_INFO("sql.driver", "DatabasePool '%s' opened successfully. " SZFMTD
                     " total connections running.", GetDatabaseName(),
-                    (_connections[IDX_SYNCH].size() + _connections[IDX_ASYNC].size()));
+                    (_connections[IDX_SYNCH].size() + _connections[IDX_ASYNC].size() + _connections[IDX_ASYNC_BULK].size()));
     }
 
     return error;
@@ -75,6 +83,7 @@ void DatabaseWorkerPool<T>::Close()
 
     //! Closes the actualy MySQL connection.
     _connections[IDX_ASYNC].clear();
+    _connections[IDX_ASYNC_BULK].clear();
 
     TC_LOG_INFO("sql.driver", "Asynchronous connections on DatabasePool '%s' terminated. "
                 "Proceeding with synchronous connections.",
@@ -156,27 +165,27 @@ QueryResultFuture DatabaseWorkerPool<T>::AsyncQuery(const char* sql)
 }
 
 template <class T>
-PreparedQueryResultFuture DatabaseWorkerPool<T>::AsyncQuery(PreparedStatement* stmt)
+PreparedQueryResultFuture DatabaseWorkerPool<T>::AsyncQuery(PreparedStatement* stmt, DatabaseQueuePriority priority /*= DB_QUEUE_PRIORITY_INTERACTIVE*/)
 {
     PreparedStatementTask* task = new PreparedStatementTask(stmt, true);
     // Store future result before enqueueing - task might get already processed and deleted before returning from this method
     PreparedQueryResultFuture result = task->GetFuture();
-    Enqueue(task);
+    Enqueue(task, priority);
     return result;
 }
 
 template <class T>
-QueryResultHolderFuture DatabaseWorkerPool<T>::DelayQueryHolder(SQLQueryHolder* holder)
+QueryResultHolderFuture DatabaseWorkerPool<T>::DelayQueryHolder(SQLQueryHolder* holder, DatabaseQueuePriority priority /*= DB_QUEUE_PRIORITY_INTERACTIVE*/)
 {
     SQLQueryHolderTask* task = new SQLQueryHolderTask(holder);
     // Store future result before enqueueing - task might get already processed and deleted before returning from this method
     QueryResultHolderFuture result = task->GetFuture();
-    Enqueue(task);
+    Enqueue(task, priority);
     return result;
 }
 
 template <class T>
-void DatabaseWorkerPool<T>::CommitTransaction(SQLTransaction transaction)
+void DatabaseWorkerPool<T>::CommitTransaction(SQLTransaction transaction, DatabaseQueuePriority priority /*= DB_QUEUE_PRIORITY_INTERACTIVE*/)
 {
 #ifdef TRINITY_DEBUG
     //! Only analyze transaction weaknesses in Debug mode.
@@ -195,35 +204,25 @@ void DatabaseWorkerPool<T>::CommitTransaction(SQLTransaction transaction)
     }
 #endif // TRINITY_DEBUG
 
-    Enqueue(new TransactionTask(transaction));
+    Transaction::OnCommit(transaction);
+    Enqueue(new TransactionTask(transaction), priority);
 }
 
 template <class T>
 void DatabaseWorkerPool<T>::DirectCommitTransaction(SQLTransaction& transaction)
 {
-    T* connection = GetFreeConnection();
-    int errorCode = connection->ExecuteTransaction(transaction);
-    if (!errorCode)
-    {
-        connection->Unlock();      // OK, operation succesful
-        return;
-    }
+    Transaction::OnCommit(transaction);
 
-    //! Handle MySQL Errno 1213 without extending deadlock to the core itself
-    /// @todo More elegant way
-    if (errorCode == ER_LOCK_DEADLOCK)
+    // already run by a transaction committed after it to the same chain
+    if (!transaction->TryClaim())
     {
-        uint8 loopBreaker = 5;
-        for (uint8 i = 0; i < loopBreaker; ++i)
-        {
-            if (!connection->ExecuteTransaction(transaction))
-                break;
-        }
+        transaction->WaitUntilExecuted();
+        return;
     }
 
-    //! Clean up now.
-    transaction->Cleanup();
-
+    //! Executes the transactions it depends on first and handles MySQL Errno 1213 like asynchronous transactions
+    T* connection = GetFreeConnection();
+    TransactionTask::ExecuteTransaction(connection, transaction);
     connection->Unlock();
 }
 
@@ -258,6 +257,31 @@ void DatabaseWorkerPool<T>::KeepAlive()
     auto const count = _connections[IDX_ASYNC].size();
     for (uint8 i = 0; i < count; ++i)
         Enqueue(new PingOperation);
+
+    auto const bulkCount = _connections[IDX_ASYNC_BULK].size();
+    for (uint8 i = 0; i < bulkCount; ++i)
+        Enqueue(new PingOperation, DB_QUEUE_PRIORITY_BULK);
+}
+
+template <class T>
+void DatabaseWorkerPool<T>::LogQueueStats()
+{
+    if (!sLog->ShouldLog("sql.driver", LOG_LEVEL_DEBUG))
+        return;
+
+    static char const* const laneNames[MAX_DB_QUEUE_PRIORITY] = { "interactive", "bulk" };
+    for (uint8 i = 0; i < MAX_DB_QUEUE_PRIORITY; ++i)
+    {
+        DatabaseQueueStats& stats = _queueStats[i];
+        uint32 processed = stats.Processed.exchange(0);
+        uint64 totalWaitTime = stats.TotalWaitTime.exchange(0);
+        uint32 maxWaitTime = stats.MaxWaitTime.exchange(0);
+        if (!processed && !stats.Queued)
+            continue;
+
+        TC_LOG_DEBUG("sql.driver", "DatabasePool '%s' %s queue: %u queued, %u processed, wait time avg %u ms, max %u ms.",
+            GetDatabaseName(), laneNames[i], uint32(stats.Queued), processed, uint32(processed ? totalWaitTime / processed : 0), maxWaitTime);
+    }
 }
 
 template <class T>
@@ -270,7 +294,9 @@ uint32 DatabaseWorkerPool<T>::OpenConnections(InternalIndex type, uint8 numConne
             switch (type)
             {
             case IDX_ASYNC:
-                return Trinity::make_unique<T>(_queue.get(), *_connectionInfo);
+                return Trinity::make_unique<T>(_queues[DB_QUEUE_PRIORITY_INTERACTIVE].get(), *_connectionInfo);
+            case IDX_ASYNC_BULK:
+                return Trinity::make_unique<T>(_queues[DB_QUEUE_PRIORITY_BULK].get(), *_connectionInfo);
             case IDX_SYNCH:
                 return Trinity::make_unique<T>(*_connectionInfo);
             default:
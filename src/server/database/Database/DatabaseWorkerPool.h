@@ -34,6 +34,17 @@
 #include <memory>
 #include <array>
 
+/*! Asynchronous operations are queued in one of these lanes. Each lane is served by its own
+    connections, so a burst of background writes can't delay latency sensitive queries.
+    Without connections of its own the bulk lane is merged into the interactive one. */
+enum DatabaseQueuePriority
+{
+    DB_QUEUE_PRIORITY_INTERACTIVE,                          // logins, queries somebody waits for (default)
+    DB_QUEUE_PRIORITY_BULK,                                 // periodic saves, logs and other background writes
+
+    MAX_DB_QUEUE_PRIORITY
+};
+
 class PingOperation : public SQLOperation
 {
     //! Operation for idle delaythreads
@@ -51,6 +62,7 @@ class DatabaseWorkerPool
         enum InternalIndex
         {
             IDX_ASYNC,
+            IDX_ASYNC_BULK,
             IDX_SYNCH,
             IDX_SIZE
         };
@@ -61,10 +73,11 @@ class DatabaseWorkerPool
 
         ~DatabaseWorkerPool()
         {
-            _queue->Cancel();
+            for (auto& queue : _queues)
+                queue->Cancel();
         }
 
-        void SetConnectionInfo(std::string const& infoString, uint8 const asyncThreads, uint8 const synchThreads);
+        void SetConnectionInfo(std::string const& infoString, uint8 const asyncThreads, uint8 const synchThreads, uint8 const bulkThreads = 0);
 
         uint32 Open();
 
@@ -106,10 +119,10 @@ class DatabaseWorkerPool
 
         //! Enqueues a one-way SQL operation in prepared statement format that will be executed asynchronously.
         //! Statement must be prepared with CONNECTION_ASYNC flag.
-        void Execute(PreparedStatement* stmt)
+        void Execute(PreparedStatement* stmt, DatabaseQueuePriority priority = DB_QUEUE_PRIORITY_INTERACTIVE)
         {
             PreparedStatementTask* task = new PreparedStatementTask(stmt);
-            Enqueue(task);
+            Enqueue(task, priority);
         }
 
         /**
@@ -205,13 +218,13 @@ class DatabaseWorkerPool
         //! Enqueues a query in prepared format that will set the value of the PreparedQueryResultFuture return object as soon as the query is executed.
         //! The return value is then processed in ProcessQueryCallback methods.
         //! Statement must be prepared with CONNECTION_ASYNC flag.
-        PreparedQueryResultFuture AsyncQuery(PreparedStatement* stmt);
+        PreparedQueryResultFuture AsyncQuery(PreparedStatement* stmt, DatabaseQueuePriority priority = DB_QUEUE_PRIORITY_INTERACTIVE);
 
         //! Enqueues a vector of SQL operations (can be both adhoc and prepared) that will set the value of the QueryResultHolderFuture
         //! return object as soon as the query is executed.
         //! The return value is then processed in ProcessQueryCallback methods.
         //! Any prepared statements added to this holder need to be prepared with the CONNECTION_ASYNC flag.
-        QueryResultHolderFuture DelayQueryHolder(SQLQueryHolder* holder);
+        QueryResultHolderFuture DelayQueryHolder(SQLQueryHolder* holder, DatabaseQueuePriority priority = DB_QUEUE_PRIORITY_INTERACTIVE);
 
         /**
             Transaction context methods.
@@ -225,7 +238,8 @@ class DatabaseWorkerPool
 
         //! Enqueues a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
         //! were appended to the transaction will be respected during execution.
-        void CommitTransaction(SQLTransaction transaction);
+        //! Transactions committed to different lanes are not ordered, see TransactionChain.
+        void CommitTransaction(SQLTransaction transaction, DatabaseQueuePriority priority = DB_QUEUE_PRIORITY_INTERACTIVE);
 
         //! Directly executes a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
         //! were appended to the transaction will be respected during execution.
@@ -271,6 +285,11 @@ class DatabaseWorkerPool
         //! Keeps all our MySQL connections alive, prevent the server from disconnecting us.
         void KeepAlive();
 
+        DatabaseQueueStats const& GetQueueStats(DatabaseQueuePriority priority) const { return _queueStats[priority]; }
+
+        //! Logs depth and wait times of the asynchronous queues and resets the wait time counters.
+        void LogQueueStats();
+
     private:
         uint32 OpenConnections(InternalIndex type, uint8 numConnections);
 
@@ -283,9 +302,13 @@ class DatabaseWorkerPool
                 _connections[IDX_SYNCH].front()->GetHandle(), to, from, length);
         }
 
-        void Enqueue(SQLOperation* op)
+        void Enqueue(SQLOperation* op, DatabaseQueuePriority priority = DB_QUEUE_PRIORITY_INTERACTIVE)
         {
-            _queue->Push(op);
+            if (priority == DB_QUEUE_PRIORITY_BULK && _connections[IDX_ASYNC_BULK].empty())
+                priority = DB_QUEUE_PRIORITY_INTERACTIVE;
+
+            op->SetQueued(&_queueStats[priority]);
+            _queues[priority]->Push(op);
         }
 
         //! Gets a free connection in the synchronous connection pool.
@@ -297,11 +320,12 @@ class DatabaseWorkerPool
             return _connectionInfo->database.c_str();
         }
 
-        //! Queue shared by async worker threads.
-        std::unique_ptr<ProducerConsumerQueue<SQLOperation*>> _queue;
+        //! Queues shared by async worker threads, one per lane.
+        std::array<std::unique_ptr<ProducerConsumerQueue<SQLOperation*>>, MAX_DB_QUEUE_PRIORITY> _queues;
+        std::array<DatabaseQueueStats, MAX_DB_QUEUE_PRIORITY> _queueStats;
         std::array<std::vector<std::unique_ptr<T>>, IDX_SIZE> _connections;
         std::unique_ptr<MySQLConnectionInfo> _connectionInfo;
-        uint8 _async_threads, _synch_threads;
+        uint8 _async_threads, _synch_threads, _bulk_threads;
 };
 
 #endif
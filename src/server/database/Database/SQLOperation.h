@@ -19,6 +19,9 @@
 #define _SQLOPERATION_H
 
 #include "QueryResult.h"
+#include "Timer.h"
+
+#include <atomic>
 
 //- Forward declare (don't include header to prevent circular includes)
 class PreparedStatement;
@@ -53,12 +56,47 @@ union SQLResultSetUnion
 
 class MySQLConnection;
 
+//- Depth and wait time counters of a DatabaseWorkerPool queue
+struct DatabaseQueueStats
+{
+    DatabaseQueueStats() : Queued(0), Processed(0), TotalWaitTime(0), MaxWaitTime(0) { }
+
+    std::atomic<uint32> Queued;                             // operations currently waiting for a connection
+    std::atomic<uint32> Processed;                          // operations dequeued since the last reset
+    std::atomic<uint64> TotalWaitTime;                      // in milliseconds, since the last reset
+    std::atomic<uint32> MaxWaitTime;                        // in milliseconds, since the last reset
+};
+
 class TC_DATABASE_API SQLOperation
 {
     public:
-        SQLOperation(): m_conn(NULL) { }
+        SQLOperation(): m_conn(NULL), m_queueStats(nullptr), m_queueTime(0) { }
         virtual ~SQLOperation() { }
 
+        //! Called when the operation is pushed into an asynchronous queue
+        void SetQueued(DatabaseQueueStats* stats)
+        {
+            m_queueStats = stats;
+            m_queueTime = getMSTime();
+            ++stats->Queued;
+        }
+
+        //! Called by the worker thread that picked the operation up
+        void SetDequeued()
+        {
+            if (!m_queueStats)
+                return;
+
+            uint32 waitTime = getMSTimeDiff(m_queueTime, getMSTime());
+            --m_queueStats->Queued;
+            ++m_queueStats->Processed;
+            m_queueStats->TotalWaitTime += waitTime;
+
+            uint32 maxWaitTime = m_queueStats->MaxWaitTime;
+            while (waitTime > maxWaitTime && !m_queueStats->MaxWaitTime.compare_exchange_weak(maxWaitTime, waitTime))
+                ;
+        }
+
         virtual int call()
         {
             Execute();
@@ -70,6 +108,9 @@ class TC_DATABASE_API SQLOperation
         MySQLConnection* m_conn;
 
     private:
+        DatabaseQueueStats* m_queueStats;
+        uint32 m_queueTime;
+
         SQLOperation(SQLOperation const& right) = delete;
         SQLOperation& operator=(SQLOperation const& right) = delete;
 };
@@ -18,6 +18,7 @@
 #include "DatabaseEnv.h"
 #include "Transaction.h"
 #include <mysqld_error.h>
+#include <algorithm>
 
 std::mutex TransactionTask::_deadlockLock;
 
@@ -39,6 +40,48 @@ void Transaction::Append(PreparedStatement* stmt)
     m_queries.push_back(data);
 }
 
+void Transaction::AppendToChain(SQLTransactionChain const& chain)
+{
+    if (std::find(_chains.begin(), _chains.end(), chain) == _chains.end())
+        _chains.push_back(chain);
+}
+
+void Transaction::OnCommit(std::shared_ptr<Transaction> const& transaction)
+{
+    // dependencies are only taken at commit time, so a transaction still being filled never runs ahead of its commit
+    for (SQLTransactionChain const& chain : transaction->_chains)
+    {
+        std::lock_guard<std::mutex> lock(chain->_lock);
+        if (SQLTransaction last = chain->_last.lock())
+            if (last != transaction && !last->IsExecuted())
+                transaction->_dependencies.push_back(last);
+
+        chain->_last = transaction;
+    }
+
+    transaction->_chains.clear();
+    transaction->_committed = true;
+}
+
+bool Transaction::TryClaim()
+{
+    bool expected = false;
+    return _claimed.compare_exchange_strong(expected, true);
+}
+
+void Transaction::SetExecuted()
+{
+    std::lock_guard<std::mutex> lock(_executedLock);
+    _executed = true;
+    _executedCondition.notify_all();
+}
+
+void Transaction::WaitUntilExecuted()
+{
+    std::unique_lock<std::mutex> lock(_executedLock);
+    _executedCondition.wait(lock, [this] { return _executed.load(); });
+}
+
 void Transaction::Cleanup()
 {
     // This might be called by explicit calls to Cleanup or by the auto-destructor
@@ -66,9 +109,34 @@ void Transaction::Cleanup()
 
 bool TransactionTask::Execute()
 {
-    int errorCode = m_conn->ExecuteTransaction(m_trans);
+    // already executed ahead of its queue position by a transaction depending on it
+    if (!m_trans->TryClaim())
+        return true;
+
+    return ExecuteTransaction(m_conn, m_trans);
+}
+
+bool TransactionTask::ExecuteTransaction(MySQLConnection* conn, SQLTransaction& trans)
+{
+    std::vector<SQLTransaction> dependencies;
+    std::swap(dependencies, trans->_dependencies);
+    for (SQLTransaction& dependency : dependencies)
+    {
+        // a transaction that was not committed yet may still be filled by its owner
+        ASSERT(dependency->_committed);
+
+        if (dependency->TryClaim())
+            ExecuteTransaction(conn, dependency);
+        else // being executed by another worker right now
+            dependency->WaitUntilExecuted();
+    }
+
+    int errorCode = conn->ExecuteTransaction(trans);
     if (!errorCode)
+    {
+        trans->SetExecuted();
         return true;
+    }
 
     if (errorCode == ER_LOCK_DEADLOCK)
     {
@@ -76,12 +144,18 @@ bool TransactionTask::Execute()
         std::lock_guard<std::mutex> lock(_deadlockLock);
         uint8 loopBreaker = 5;  // Handle MySQL Errno 1213 without extending deadlock to the core itself
         for (uint8 i = 0; i < loopBreaker; ++i)
-            if (!m_conn->ExecuteTransaction(m_trans))
+        {
+            if (!conn->ExecuteTransaction(trans))
+            {
+                trans->SetExecuted();
                 return true;
+            }
+        }
     }
 
     // Clean up now.
-    m_trans->Cleanup();
+    trans->Cleanup();
+    trans->SetExecuted();
 
     return false;
 }
@@ -21,8 +21,28 @@
 #include "SQLOperation.h"
 #include "StringFormat.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
 //- Forward declare (don't include header to prevent circular includes)
 class PreparedStatement;
+class Transaction;
+
+/*! Orders transactions writing the same data, e.g. all saves of one character.
+    Asynchronous transactions may be queued in different lanes of a DatabaseWorkerPool and executed out of order,
+    a transaction appended to a chain is executed after the one committed to the chain before it - if that one is
+    still waiting in its queue, it gets executed first on the same connection. */
+class TC_DATABASE_API TransactionChain
+{
+    friend class Transaction;
+
+    private:
+        std::mutex _lock;
+        std::weak_ptr<Transaction> _last;       // expires once executed
+};
+typedef std::shared_ptr<TransactionChain> SQLTransactionChain;
 
 /*! Transactions, high level class. */
 class TC_DATABASE_API Transaction
@@ -34,7 +54,7 @@ class TC_DATABASE_API Transaction
     friend class DatabaseWorkerPool;
 
     public:
-        Transaction() : _cleanedUp(false) { }
+        Transaction() : _cleanedUp(false), _committed(false), _claimed(false), _executed(false) { }
         ~Transaction() { Cleanup(); }
 
         void Append(PreparedStatement* statement);
@@ -47,13 +67,29 @@ class TC_DATABASE_API Transaction
 
         size_t GetSize() const { return m_queries.size(); }
 
+        //! Orders this transaction after the last one committed to the chain. Takes effect when the transaction is committed,
+        //! so statements may still be appended afterwards.
+        void AppendToChain(SQLTransactionChain const& chain);
+        bool IsExecuted() const { return _executed; }
+
     protected:
         void Cleanup();
         std::list<SQLElementData> m_queries;
 
     private:
-        bool _cleanedUp;
+        static void OnCommit(std::shared_ptr<Transaction> const& transaction);
+        bool TryClaim();
+        void SetExecuted();
+        void WaitUntilExecuted();
 
+        bool _cleanedUp;
+        std::atomic<bool> _committed;
+        std::atomic<bool> _claimed;
+        std::atomic<bool> _executed;
+        std::mutex _executedLock;
+        std::condition_variable _executedCondition;
+        std::vector<SQLTransactionChain> _chains;
+        std::vector<std::shared_ptr<Transaction>> _dependencies;    // committed transactions executed before this one
 };
 typedef std::shared_ptr<Transaction> SQLTransaction;
 
@@ -69,6 +105,7 @@ class TC_DATABASE_API TransactionTask : public SQLOperation
 
     protected:
         bool Execute() override;
+        static bool ExecuteTransaction(MySQLConnection* conn, SQLTransaction& trans);
 
         SQLTransaction m_trans;
         static std::mutex _deadlockLock;
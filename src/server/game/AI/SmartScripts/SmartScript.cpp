@@ -37,6 +37,10 @@
 #include "Vehicle.h"
 #include "GameEventMgr.h"
 
+std::array<std::atomic<uint32>, SMART_EVENT_END> SmartScript::_eventsFired;
+std::array<std::atomic<uint32>, SMART_EVENT_END> SmartScript::_eventsProcessed;
+LogStatsGate SmartScript::_eventStatsGate("scripts.ai");
+
 SmartScript::SmartScript()
 {
     go = NULL;
@@ -52,6 +56,7 @@ SmartScript::SmartScript()
     mTemplate = SMARTAI_TEMPLATE_BASIC;
     mScriptType = SMART_SCRIPT_TYPE_CREATURE;
     isProcessingTimedActionList = false;
+    mEventIndexOffsets.fill(0);
 }
 
 SmartScript::~SmartScript()
@@ -82,15 +87,60 @@ void SmartScript::OnReset()
 
 void SmartScript::ProcessEventsFor(SMART_EVENT e, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
-    for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
+    if (e == SMART_EVENT_LINK || e >= SMART_EVENT_END) // link events are only processed by the event they are linked to
+        return;
+
+    if (_eventStatsGate.IsEnabled())
+        ++_eventsFired[e];
+
+    for (uint16 i = mEventIndexOffsets[e]; i < mEventIndexOffsets[e + 1]; ++i)
     {
-        SMART_EVENT eventType = SMART_EVENT(i->GetEventType());
-        if (eventType == SMART_EVENT_LINK)//special handling
-            continue;
+        SmartScriptHolder& holder = mEvents[mEventIndex[i]];
+        if (IsMeetingConditions(holder, unit))
+            ProcessEvent(holder, unit, var0, var1, bvar, spell, gob);
+    }
+}
+
+bool SmartScript::IsMeetingConditions(SmartScriptHolder& e, Unit* unit)
+{
+    if (e.conditionsGeneration != sConditionMgr->GetLoadGeneration())
+        SmartAIMgr::ResolveConditions(e);
+
+    if (!e.conditions)
+        return true;
+
+    ConditionSourceInfo sourceInfo(unit, GetBaseObject());
+    return sConditionMgr->IsObjectMeetToConditions(sourceInfo, *e.conditions);
+}
+
+void SmartScript::BuildEventIndex()
+{
+    // counting sort by event type, events of the same type keep their order
+    mEventIndexOffsets.fill(0);
+    for (SmartScriptHolder const& e : mEvents)
+        ++mEventIndexOffsets[e.GetEventType() + 1];
+
+    for (uint32 i = 1; i <= SMART_EVENT_END; ++i)
+        mEventIndexOffsets[i] += mEventIndexOffsets[i - 1];
+
+    std::array<uint16, SMART_EVENT_END> next;
+    std::copy(mEventIndexOffsets.begin(), mEventIndexOffsets.end() - 1, next.begin());
+
+    mEventIndex.resize(mEvents.size());
+    for (size_t i = 0; i < mEvents.size(); ++i)
+        mEventIndex[next[mEvents[i].GetEventType()]++] = uint16(i);
+}
+
+void SmartScript::LogEventStats()
+{
+    bool statsEnabled = _eventStatsGate.Refresh();
 
-        if (eventType == e /*&& (!i->event.event_phase_mask || IsInPhase(i->event.event_phase_mask)) && !(i->event.event_flags & SMART_EVENT_FLAG_NOT_REPEATABLE && i->runOnce)*/)
-            if (sConditionMgr->IsObjectMeetingSmartEventConditions(i->entryOrGuid, i->event_id, i->source_type, unit, GetBaseObject()))
-                ProcessEvent(*i, unit, var0, var1, bvar, spell, gob);
+    for (uint32 i = 0; i < SMART_EVENT_END; ++i)
+    {
+        uint32 fired = _eventsFired[i].exchange(0);
+        uint32 processed = _eventsProcessed[i].exchange(0);
+        if (statsEnabled && (fired || processed))
+            TC_LOG_DEBUG("scripts.ai", "SmartScript: event type %u fired %u times, %u events processed", i, fired, processed);
     }
 }
 
@@ -2362,7 +2412,7 @@ void SmartScript::ProcessAction(SmartScriptHolder& e, Unit* unit, uint32 var0, u
 
 void SmartScript::ProcessTimedAction(SmartScriptHolder& e, uint32 const& min, uint32 const& max, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
-    if (sConditionMgr->IsObjectMeetingSmartEventConditions(e.entryOrGuid, e.event_id, e.source_type, unit, GetBaseObject()))
+    if (IsMeetingConditions(e, unit))
         ProcessAction(e, unit, var0, var1, bvar, spell, gob);
 
     RecalcTimer(e, min, max);
@@ -2776,6 +2826,9 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
     if ((e.event.event_phase_mask && !IsInPhase(e.event.event_phase_mask)) || ((e.event.event_flags & SMART_EVENT_FLAG_NOT_REPEATABLE) && e.runOnce))
         return;
 
+    if (_eventStatsGate.IsEnabled())
+        ++_eventsProcessed[e.GetEventType()];
+
     switch (e.GetEventType())
     {
         case SMART_EVENT_LINK://special handling
@@ -3418,6 +3471,7 @@ void SmartScript::InstallEvents()
             mEvents.push_back(*i);//must be before UpdateTimers
 
         mInstallEvents.clear();
+        BuildEventIndex();
     }
 }
 
@@ -3505,6 +3559,8 @@ void SmartScript::FillScript(SmartAIEventList e, WorldObject* obj, AreaTriggerEn
         }
         mEvents.push_back((*i));//NOTE: 'world(0)' events still get processed in ANY instance mode
     }
+    BuildEventIndex();
+
     if (mEvents.empty() && obj)
         TC_LOG_ERROR("sql.sql", "SmartScript: Entry %u has events but no events added to list because of instance flags.", obj->GetEntry());
     if (mEvents.empty() && at)
@@ -24,10 +24,14 @@
 #include "Unit.h"
 #include "Spell.h"
 #include "GridNotifiers.h"
+#include "LogStatsGate.h"
 
 #include "SmartScriptMgr.h"
 //#include "SmartAI.h"
 
+#include <array>
+#include <atomic>
+
 class TC_GAME_API SmartScript
 {
     public:
@@ -51,6 +55,9 @@ class TC_GAME_API SmartScript
         void InstallTemplate(SmartScriptHolder const& e);
         SmartScriptHolder CreateEvent(SMART_EVENT e, uint32 event_flags, uint32 event_param1, uint32 event_param2, uint32 event_param3, uint32 event_param4, SMART_ACTION action, uint32 action_param1, uint32 action_param2, uint32 action_param3, uint32 action_param4, uint32 action_param5, uint32 action_param6, SMARTAI_TARGETS t, uint32 target_param1, uint32 target_param2, uint32 target_param3, uint32 phaseMask = 0);
         void AddEvent(SMART_EVENT e, uint32 event_flags, uint32 event_param1, uint32 event_param2, uint32 event_param3, uint32 event_param4, SMART_ACTION action, uint32 action_param1, uint32 action_param2, uint32 action_param3, uint32 action_param4, uint32 action_param5, uint32 action_param6, SMARTAI_TARGETS t, uint32 target_param1, uint32 target_param2, uint32 target_param3, uint32 phaseMask = 0);
+        /// Writes how often each event type was fired and processed to the log and resets the counters
+        static void LogEventStats();
+
         void SetPathId(uint32 id) { mPathId = id; }
         uint32 GetPathId() const { return mPathId; }
         WorldObject* GetBaseObject()
@@ -282,6 +289,18 @@ class TC_GAME_API SmartScript
         SMARTAI_TEMPLATE mTemplate;
         void InstallEvents();
 
+        // positions of the events in mEvents grouped by event type, the events of type t are
+        // mEventIndex[mEventIndexOffsets[t]] up to mEventIndex[mEventIndexOffsets[t + 1]]
+        std::vector<uint16> mEventIndex;
+        std::array<uint16, SMART_EVENT_END + 1> mEventIndexOffsets;
+        void BuildEventIndex();
+
+        bool IsMeetingConditions(SmartScriptHolder& e, Unit* unit);
+
+        static std::array<std::atomic<uint32>, SMART_EVENT_END> _eventsFired;       // ProcessEventsFor calls
+        static std::array<std::atomic<uint32>, SMART_EVENT_END> _eventsProcessed;   // events run through ProcessEvent
+        static LogStatsGate _eventStatsGate;
+
         void RemoveStoredEvent(uint32 id)
         {
             if (!mStoredEvents.empty())
@@ -273,8 +273,11 @@ void SmartAIMgr::LoadSmartAIFromDB()
     {
         for (SmartAIEventMap::iterator itr = mEventMap[i].begin(); itr != mEventMap[i].end(); ++itr)
         {
-            for (SmartScriptHolder const& e : itr->second)
+            for (SmartScriptHolder& e : itr->second)
             {
+                // scripts copy their events from here, with the conditions already looked up
+                ResolveConditions(e);
+
                 if (e.link)
                 {
                     if (!FindLinkedEvent(itr->second, e.link))
@@ -301,6 +304,12 @@ void SmartAIMgr::LoadSmartAIFromDB()
     UnLoadHelperStores();
 }
 
+void SmartAIMgr::ResolveConditions(SmartScriptHolder& e)
+{
+    e.conditions = sConditionMgr->GetConditionsForSmartEvent(e.entryOrGuid, e.event_id, e.source_type);
+    e.conditionsGeneration = sConditionMgr->GetLoadGeneration();
+}
+
 bool SmartAIMgr::IsTargetValid(SmartScriptHolder const& e)
 {
     if (std::abs(e.target.o) > 2 * float(M_PI))
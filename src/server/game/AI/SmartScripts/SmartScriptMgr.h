@@ -19,6 +19,7 @@
 #define TRINITY_SMARTSCRIPTMGR_H
 
 #include "Common.h"
+#include "ConditionMgr.h"
 #include "Creature.h"
 #include "CreatureAI.h"
 #include "Unit.h"
@@ -1360,7 +1361,7 @@ struct SmartScriptHolder
 {
     SmartScriptHolder() : entryOrGuid(0), source_type(SMART_SCRIPT_TYPE_CREATURE)
         , event_id(0), link(0), event(), action(), target(), timer(0), active(false), runOnce(false)
-        , enableTimed(false) { }
+        , enableTimed(false), conditions(nullptr), conditionsGeneration(0) { }
 
     int32 entryOrGuid;
     SmartScriptType source_type;
@@ -1381,6 +1382,10 @@ struct SmartScriptHolder
     bool runOnce;
     bool enableTimed;
 
+    // conditions of the event, resolved in advance and valid while conditionsGeneration matches the condition store
+    ConditionContainer const* conditions;
+    uint32 conditionsGeneration;
+
     operator bool() const { return entryOrGuid != 0; }
 };
 
@@ -1496,6 +1501,9 @@ class TC_GAME_API SmartAIMgr
             }
         }
 
+        /// Looks up the conditions of the event in the condition store, done again after conditions were reloaded
+        static void ResolveConditions(SmartScriptHolder& e);
+
         static SmartScriptHolder& FindLinkedSourceEvent(SmartAIEventList& list, uint32 eventId)
         {
             SmartAIEventList::iterator itr = std::find_if(list.begin(), list.end(),
@@ -697,6 +697,7 @@ enum RBACPermissions
     // 799 - 834 6.x only
     RBAC_PERM_COMMAND_DEBUG_LOADCELLS                        = 835,
     RBAC_PERM_COMMAND_DEBUG_BOUNDARY                         = 836,
+    RBAC_PERM_COMMAND_SERVER_OPCODESTATS                     = 837,
 
     // custom permissions 1000+
     RBAC_PERM_MAX
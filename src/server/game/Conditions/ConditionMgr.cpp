@@ -27,6 +27,7 @@
 #include "ScriptMgr.h"
 #include "SpellAuras.h"
 #include "SpellMgr.h"
+#include "StartupTaskGraph.h"
 
 char const* const ConditionMgr::StaticSourceTypeData[CONDITION_SOURCE_TYPE_MAX] =
 {
@@ -677,7 +678,7 @@ std::string Condition::ToString(bool ext /*= false*/) const
     return ss.str();
 }
 
-ConditionMgr::ConditionMgr() { }
+ConditionMgr::ConditionMgr() : _loadGeneration(0) { }
 
 ConditionMgr::~ConditionMgr()
 {
@@ -897,6 +898,16 @@ bool ConditionMgr::IsObjectMeetingVehicleSpellConditions(uint32 creatureId, uint
 }
 
 bool ConditionMgr::IsObjectMeetingSmartEventConditions(int32 entryOrGuid, uint32 eventId, uint32 sourceType, Unit* unit, WorldObject* baseObject) const
+{
+    if (ConditionContainer const* conditions = GetConditionsForSmartEvent(entryOrGuid, eventId, sourceType))
+    {
+        ConditionSourceInfo sourceInfo(unit, baseObject);
+        return IsObjectMeetToConditions(sourceInfo, *conditions);
+    }
+    return true;
+}
+
+ConditionContainer const* ConditionMgr::GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType) const
 {
     SmartEventConditionContainer::const_iterator itr = SmartEventConditionStore.find(std::make_pair(entryOrGuid, sourceType));
     if (itr != SmartEventConditionStore.end())
@@ -905,11 +916,10 @@ bool ConditionMgr::IsObjectMeetingSmartEventConditions(int32 entryOrGuid, uint32
         if (i != itr->second.end())
         {
             TC_LOG_DEBUG("condition", "GetConditionsForSmartEvent: found conditions for Smart Event entry or guid %d eventId %u", entryOrGuid, eventId);
-            ConditionSourceInfo sourceInfo(unit, baseObject);
-            return IsObjectMeetToConditions(sourceInfo, i->second);
+            return &i->second;
         }
     }
-    return true;
+    return nullptr;
 }
 
 bool ConditionMgr::IsObjectMeetingVendorItemConditions(uint32 creatureId, uint32 itemId, Player* player, Creature* vendor) const
@@ -936,9 +946,13 @@ ConditionMgr* ConditionMgr::instance()
 
 void ConditionMgr::LoadConditions(bool isReload)
 {
+    StartupTaskGraph::Require("loot templates");
+    StartupTaskGraph::Require("gossip menus");
+
     uint32 oldMSTime = getMSTime();
 
     Clean();
+    ++_loadGeneration;
 
     //must clear all custom handled cases (groupped types) before reload
     if (isReload)
@@ -234,6 +234,8 @@ class TC_GAME_API ConditionMgr
         static ConditionMgr* instance();
 
         void LoadConditions(bool isReload = false);
+        // changes with every (re)load, condition containers kept by others are only valid as long as it does not
+        uint32 GetLoadGeneration() const { return _loadGeneration; }
         bool isConditionTypeValid(Condition* cond) const;
 
         uint32 GetSearcherTypeMaskForConditionList(ConditionContainer const& conditions) const;
@@ -249,6 +251,7 @@ class TC_GAME_API ConditionMgr
         ConditionContainer const* GetConditionsForSpellClickEvent(uint32 creatureId, uint32 spellId) const;
         bool IsObjectMeetingVehicleSpellConditions(uint32 creatureId, uint32 spellId, Player* player, Unit* vehicle) const;
         bool IsObjectMeetingSmartEventConditions(int32 entryOrGuid, uint32 eventId, uint32 sourceType, Unit* unit, WorldObject* baseObject) const;
+        ConditionContainer const* GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType) const;
         bool IsObjectMeetingVendorItemConditions(uint32 creatureId, uint32 itemId, Player* player, Creature* vendor) const;
 
         struct ConditionTypeInfo
@@ -280,6 +283,8 @@ class TC_GAME_API ConditionMgr
         ConditionEntriesByCreatureIdMap SpellClickEventConditionStore;
         ConditionEntriesByCreatureIdMap NpcVendorConditionContainerStore;
         SmartEventConditionContainer    SmartEventConditionStore;
+
+        uint32 _loadGeneration;
 };
 
 #define sConditionMgr ConditionMgr::instance()
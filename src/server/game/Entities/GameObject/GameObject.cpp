@@ -2295,6 +2295,18 @@ void GameObject::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* t
     data->append(fieldBuffer);
 }
 
+uint32 GameObject::GetValuesUpdateShareKey(Player const* target) const
+{
+    // GAMEOBJECT_DYNAMIC and group loot chest flags are rewritten per target in BuildValuesUpdate
+    if (_fieldNotifyFlags || _changesMask.GetBit(GAMEOBJECT_DYNAMIC))
+        return 0;
+
+    if (GetGoType() == GAMEOBJECT_TYPE_CHEST && GetGOInfo()->chest.groupLootRules)
+        return 0;
+
+    return Object::GetValuesUpdateShareKey(target);
+}
+
 void GameObject::GetRespawnPosition(float &x, float &y, float &z, float* ori /* = NULL*/) const
 {
     if (m_spawnId)
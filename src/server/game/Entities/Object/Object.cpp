@@ -533,7 +533,7 @@ void Object::ClearUpdateMask(bool remove)
     }
 }
 
-void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) const
+void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map, UpdateBlockCache* blockCache /*= nullptr*/) const
 {
     UpdateDataMapType::iterator iter = data_map.find(player);
 
@@ -544,9 +544,36 @@ void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) cons
         iter = p.first;
     }
 
+    if (blockCache)
+    {
+        if (uint32 shareKey = GetValuesUpdateShareKey(player))
+        {
+            std::shared_ptr<ByteBuffer const>& block = (*blockCache)[shareKey];
+            if (!block)
+            {
+                std::shared_ptr<ByteBuffer> buf = std::make_shared<ByteBuffer>(500);
+                *buf << uint8(UPDATETYPE_VALUES);
+                *buf << GetPackGUID();
+
+                BuildValuesUpdate(UPDATETYPE_VALUES, buf.get(), player);
+                block = std::move(buf);
+            }
+
+            iter->second.AddUpdateBlock(block);
+            return;
+        }
+    }
+
     BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
 }
 
+uint32 Object::GetValuesUpdateShareKey(Player const* target) const
+{
+    // Object::BuildValuesUpdate only depends on the visible field flags of the target
+    uint32* flags = NULL;
+    return GetUpdateFieldData(target, flags);
+}
+
 uint32 Object::GetUpdateFieldData(Player const* target, uint32*& flags) const
 {
     uint32 visibleFlag = UF_FLAG_PUBLIC;
@@ -2452,6 +2479,7 @@ struct WorldObjectChangeAccumulator
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
     GuidSet plr_list;
+    UpdateBlockCache i_blockCache;
     WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj) { }
     void Visit(PlayerMapType &m)
     {
@@ -2509,7 +2537,7 @@ struct WorldObjectChangeAccumulator
         // Only send update once to a player
         if (plr_list.find(player->GetGUID()) == plr_list.end() && player->HaveAtClient(&i_object))
         {
-            i_object.BuildFieldsUpdate(player, i_updateDatas);
+            i_object.BuildFieldsUpdate(player, i_updateDatas, &i_blockCache);
             plr_list.insert(player->GetGUID());
         }
     }
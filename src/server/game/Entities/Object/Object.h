@@ -84,11 +84,14 @@ class TempSummon;
 class Transport;
 class Unit;
 class UpdateData;
+class ByteBuffer;
 class WorldObject;
 class WorldPacket;
 class ZoneScript;
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
+// values update blocks already built during one BuildUpdate, keyed by GetValuesUpdateShareKey
+typedef std::unordered_map<uint32, std::shared_ptr<ByteBuffer const>> UpdateBlockCache;
 
 class TC_GAME_API Object
 {
@@ -174,7 +177,7 @@ class TC_GAME_API Object
         virtual bool hasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool hasInvolvedQuest(uint32 /* quest_id */) const { return false; }
         virtual void BuildUpdate(UpdateDataMapType&) { }
-        void BuildFieldsUpdate(Player*, UpdateDataMapType &) const;
+        void BuildFieldsUpdate(Player*, UpdateDataMapType &, UpdateBlockCache* blockCache = nullptr) const;
 
         void SetFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags |= flag; }
         void RemoveFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags &= uint16(~flag); }
@@ -212,6 +215,9 @@ class TC_GAME_API Object
 
         void BuildMovementUpdate(ByteBuffer* data, uint16 flags) const;
         virtual void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const;
+        // Returns a key under which the values update built for target can be shared with every other
+        // target returning the same key, 0 if the update has to be built for target alone
+        virtual uint32 GetValuesUpdateShareKey(Player const* target) const;
 
         uint16 m_objectType;
 
@@ -23,6 +23,7 @@
 #include "Opcodes.h"
 #include "World.h"
 #include "zlib.h"
+#include <boost/thread/tss.hpp>
 
 UpdateData::UpdateData() : m_blockCount(0) { }
 
@@ -42,90 +43,196 @@ void UpdateData::AddUpdateBlock(const ByteBuffer &block)
     ++m_blockCount;
 }
 
-void UpdateData::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
+void UpdateData::AddUpdateBlock(SharedUpdateBlock const& block)
 {
-    z_stream c_stream;
+    m_sharedBlocks.emplace_back(m_data.wpos(), block);
+    ++m_blockCount;
+}
+
+size_t UpdateData::GetBlockSize() const
+{
+    size_t size = m_data.wpos();
+    for (auto const& shared : m_sharedBlocks)
+        size += shared.second->wpos();
 
-    c_stream.zalloc = (alloc_func)nullptr;
-    c_stream.zfree = (free_func)nullptr;
-    c_stream.opaque = (voidpf)nullptr;
+    return size;
+}
 
-    // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld->getIntConfig(CONFIG_COMPRESSION));
-    if (z_res != Z_OK)
+namespace
+{
+    // deflate state (~256KB) is kept per thread and reset between packets instead of
+    // being allocated and freed by deflateInit/deflateEnd for every compressed update
+    class UpdateCompressionStream
     {
-        TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+        public:
+            UpdateCompressionStream() : _level(-1)
+            {
+                _stream.zalloc = (alloc_func)nullptr;
+                _stream.zfree = (free_func)nullptr;
+                _stream.opaque = (voidpf)nullptr;
+            }
+
+            ~UpdateCompressionStream()
+            {
+                Close();
+            }
 
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
+            z_stream* Open(int level)
+            {
+                if (_level == level)
+                {
+                    int z_res = deflateReset(&_stream);
+                    if (z_res == Z_OK)
+                        return &_stream;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
-    if (z_res != Z_OK)
+                    TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
+                    Close();
+                }
+
+                // first use on this thread or compression level changed by config reload
+                Close();
+
+                int z_res = deflateInit(&_stream, level);
+                if (z_res != Z_OK)
+                {
+                    TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                    return nullptr;
+                }
+
+                _level = level;
+                return &_stream;
+            }
+
+            void Close()
+            {
+                if (_level < 0)
+                    return;
+
+                deflateEnd(&_stream);
+                _level = -1;
+            }
+
+        private:
+            z_stream _stream;
+            int _level;
+    };
+
+    boost::thread_specific_ptr<UpdateCompressionStream> compressionStream;
+
+    UpdateCompressionStream* GetCompressionStream()
     {
-        TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
+        UpdateCompressionStream* stream = compressionStream.get();
+
+        if (!stream)
+        {
+            stream = new UpdateCompressionStream();
+            compressionStream.reset(stream);
+        }
+
+        return stream;
     }
+}
+
+void UpdateData::Compress(void* dst, uint32 *dst_size, Segments const& src)
+{
+    UpdateCompressionStream* stream = GetCompressionStream();
 
-    if (c_stream.avail_in != 0)
+    // default Z_BEST_SPEED (1)
+    z_stream* c_stream = stream->Open(sWorld->getIntConfig(CONFIG_COMPRESSION));
+    if (!c_stream)
     {
-        TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflate not greedy)");
         *dst_size = 0;
         return;
     }
 
-    z_res = deflate(&c_stream, Z_FINISH);
-    if (z_res != Z_STREAM_END)
+    c_stream->next_out = (Bytef*)dst;
+    c_stream->avail_out = *dst_size;
+
+    int z_res;
+
+    // feed the segments one after another, shared blocks are read in place
+    for (Segments::value_type const& segment : src)
     {
-        TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
+        c_stream->next_in = (Bytef*)segment.first;
+        c_stream->avail_in = (uInt)segment.second;
+
+        z_res = deflate(c_stream, Z_NO_FLUSH);
+        if (z_res != Z_OK)
+        {
+            TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
+            stream->Close();
+            *dst_size = 0;
+            return;
+        }
+
+        if (c_stream->avail_in != 0)
+        {
+            TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflate not greedy)");
+            stream->Close();
+            *dst_size = 0;
+            return;
+        }
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
+    z_res = deflate(c_stream, Z_FINISH);
+    if (z_res != Z_STREAM_END)
     {
-        TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
+        TC_LOG_ERROR("misc", "Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
+        stream->Close();
         *dst_size = 0;
         return;
     }
 
-    *dst_size = c_stream.total_out;
+    *dst_size = c_stream->total_out;
 }
 
 bool UpdateData::BuildPacket(WorldPacket* packet)
 {
     ASSERT(packet->empty());                                // shouldn't happen
 
-    ByteBuffer buf(4 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()) + m_data.wpos());
+    ByteBuffer header(4 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()));
 
-    buf << (uint32) (!m_outOfRangeGUIDs.empty() ? m_blockCount + 1 : m_blockCount);
+    header << (uint32) (!m_outOfRangeGUIDs.empty() ? m_blockCount + 1 : m_blockCount);
 
     if (!m_outOfRangeGUIDs.empty())
     {
-        buf << uint8(UPDATETYPE_OUT_OF_RANGE_OBJECTS);
-        buf << uint32(m_outOfRangeGUIDs.size());
+        header << uint8(UPDATETYPE_OUT_OF_RANGE_OBJECTS);
+        header << uint32(m_outOfRangeGUIDs.size());
 
         for (GuidSet::const_iterator i = m_outOfRangeGUIDs.begin(); i != m_outOfRangeGUIDs.end(); ++i)
-            buf << i->WriteAsPacked();
+            header << i->WriteAsPacked();
+    }
+
+    // the packet is assembled from the header, our own blocks and the shared blocks
+    // interleaved in the order they were added, without building it in a temporary buffer first
+    Segments segments;
+    segments.reserve(2 + 2 * m_sharedBlocks.size());
+    segments.emplace_back(header.contents(), header.wpos());
+
+    size_t dataPos = 0;
+    for (auto const& shared : m_sharedBlocks)
+    {
+        if (shared.first > dataPos)
+            segments.emplace_back(m_data.contents() + dataPos, shared.first - dataPos);
+
+        segments.emplace_back(shared.second->contents(), shared.second->wpos());
+        dataPos = shared.first;
     }
 
-    buf.append(m_data);
+    if (m_data.wpos() > dataPos)
+        segments.emplace_back(m_data.contents() + dataPos, m_data.wpos() - dataPos);
 
-    size_t pSize = buf.wpos();                              // use real used data size
+    size_t pSize = 0;                                       // use real used data size
+    for (Segments::value_type const& segment : segments)
+        pSize += segment.second;
 
-    if (pSize > 100)                                       // compress large packets
+    if (pSize > sWorld->getIntConfig(CONFIG_COMPRESSION_THRESHOLD))     // compress large packets
     {
         uint32 destsize = compressBound(pSize);
         packet->resize(destsize + sizeof(uint32));
 
         packet->put<uint32>(0, pSize);
-        Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
+        Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, segments);
         if (destsize == 0)
             return false;
 
@@ -134,7 +241,9 @@ bool UpdateData::BuildPacket(WorldPacket* packet)
     }
     else                                                    // send small packets without compression
     {
-        packet->append(buf);
+        for (Segments::value_type const& segment : segments)
+            packet->append(segment.first, segment.second);
+
         packet->SetOpcode(SMSG_UPDATE_OBJECT);
     }
 
@@ -144,6 +253,7 @@ bool UpdateData::BuildPacket(WorldPacket* packet)
 void UpdateData::Clear()
 {
     m_data.clear();
+    m_sharedBlocks.clear();
     m_outOfRangeGUIDs.clear();
     m_blockCount = 0;
 }
@@ -21,7 +21,9 @@
 
 #include "ByteBuffer.h"
 #include "ObjectGuid.h"
+#include <memory>
 #include <set>
+#include <vector>
 
 class WorldPacket;
 
@@ -50,31 +52,45 @@ enum OBJECT_UPDATE_FLAGS
     UPDATEFLAG_ROTATION             = 0x0200
 };
 
+// Update block serialized once and referenced by every receiver's UpdateData
+typedef std::shared_ptr<ByteBuffer const> SharedUpdateBlock;
+
 class UpdateData
 {
     public:
         UpdateData();
         UpdateData(UpdateData&& right) : m_blockCount(right.m_blockCount),
             m_outOfRangeGUIDs(std::move(right.m_outOfRangeGUIDs)),
-            m_data(std::move(right.m_data))
+            m_data(std::move(right.m_data)), m_sharedBlocks(std::move(right.m_sharedBlocks))
         {
         }
 
         void AddOutOfRangeGUID(GuidSet& guids);
         void AddOutOfRangeGUID(ObjectGuid guid);
         void AddUpdateBlock(const ByteBuffer &block);
+        void AddUpdateBlock(SharedUpdateBlock const& block);
         bool BuildPacket(WorldPacket* packet);
         bool HasData() const { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
         void Clear();
 
         GuidSet const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
 
+        // block bytes held by this UpdateData, counting shared blocks in full
+        size_t GetBlockSize() const;
+        // block bytes serialized for this UpdateData alone
+        size_t GetOwnBlockSize() const { return m_data.wpos(); }
+        std::vector<std::pair<size_t, SharedUpdateBlock>> const& GetSharedBlocks() const { return m_sharedBlocks; }
+
     protected:
+        typedef std::vector<std::pair<uint8 const*, size_t>> Segments;
+
         uint32 m_blockCount;
         GuidSet m_outOfRangeGUIDs;
         ByteBuffer m_data;
+        // shared blocks with the m_data write position they were added at
+        std::vector<std::pair<size_t, SharedUpdateBlock>> m_sharedBlocks;
 
-        void Compress(void* dst, uint32 *dst_size, void* src, int src_size);
+        void Compress(void* dst, uint32 *dst_size, Segments const& src);
 
         UpdateData(UpdateData const& right) = delete;
         UpdateData& operator=(UpdateData const& right) = delete;
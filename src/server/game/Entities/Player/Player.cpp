@@ -295,6 +295,8 @@ Player::Player(WorldSession* session): Unit(true)
     m_speakTime = 0;
     m_speakCount = 0;
 
+    m_saveChain = std::make_shared<TransactionChain>();
+
     m_objectType |= TYPEMASK_PLAYER;
     m_objectTypeId = TYPEID_PLAYER;
 
@@ -1443,7 +1445,7 @@ void Player::Update(uint32 p_time)
         if (p_time >= m_nextSave)
         {
             // m_nextSave reset in SaveToDB call
-            SaveToDB();
+            SaveToDB(false, DB_QUEUE_PRIORITY_BULK);
             TC_LOG_DEBUG("entities.player", "Player::Update: Player '%s' (%s) saved", GetName().c_str(), GetGUID().ToString().c_str());
         }
         else
@@ -18913,7 +18915,7 @@ bool Player::_LoadHomeBind(PreparedQueryResult result)
 /***                   SAVE SYSTEM                     ***/
 /*********************************************************/
 
-void Player::SaveToDB(bool create /*=false*/)
+void Player::SaveToDB(bool create /*=false*/, DatabaseQueuePriority priority /*= DB_QUEUE_PRIORITY_INTERACTIVE*/)
 {
     // delay auto save at any saves (manual, in code, or autosave)
     m_nextSave = sWorld->getIntConfig(CONFIG_INTERVAL_SAVE);
@@ -19212,7 +19214,8 @@ void Player::SaveToDB(bool create /*=false*/)
     if (m_session->isLogingOut() || !sWorld->getBoolConfig(CONFIG_STATS_SAVE_ONLY_ON_LOGOUT))
         _SaveStats(trans);
 
-    CharacterDatabase.CommitTransaction(trans);
+    trans->AppendToChain(m_saveChain);
+    CharacterDatabase.CommitTransaction(trans, priority);
 
     // save pet (hunter pet level and experience and all type pets health/mana).
     if (Pet* pet = GetPet())
@@ -19228,6 +19231,9 @@ void Player::SaveInventoryAndGoldToDB(SQLTransaction& trans)
 
 void Player::SaveGoldToDB(SQLTransaction& trans) const
 {
+    // an older periodic save must not overwrite inventory and money saved here, nor may a later save be overwritten by this one
+    trans->AppendToChain(m_saveChain);
+
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_CHAR_MONEY);
     stmt->setUInt32(0, GetMoney());
     stmt->setUInt32(1, GetGUID().GetCounter());
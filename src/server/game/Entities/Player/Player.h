@@ -1439,7 +1439,7 @@ class TC_GAME_API Player : public Unit, public GridObject<Player>
         /***                   SAVE SYSTEM                     ***/
         /*********************************************************/
 
-        void SaveToDB(bool create = false);
+        void SaveToDB(bool create = false, DatabaseQueuePriority priority = DB_QUEUE_PRIORITY_INTERACTIVE);
         void SaveInventoryAndGoldToDB(SQLTransaction& trans);                    // fast save function for item/money cheating preventing
         void SaveGoldToDB(SQLTransaction& trans) const;
 
@@ -2380,6 +2380,7 @@ class TC_GAME_API Player : public Unit, public GridObject<Player>
 
         uint32 m_team;
         uint32 m_nextSave;
+        SQLTransactionChain m_saveChain;                    // all saves of this player, a save must not overtake an earlier one
         time_t m_speakTime;
         uint32 m_speakCount;
         Difficulty m_dungeonDifficulty;
@@ -92,6 +92,15 @@ float playerBaseMoveSpeed[MAX_MOVE_TYPE] =
     3.14f                  // MOVE_PITCH_RATE
 };
 
+std::atomic<uint32> Unit::_auraModifierQueries(0);
+std::atomic<uint32> Unit::_auraModifierRebuilds(0);
+LogStatsGate Unit::_auraModifierStatsGate("entities.unit");
+std::atomic<uint32> Unit::_procEvents(0);
+std::atomic<uint64> Unit::_procAurasApplied(0);
+std::atomic<uint64> Unit::_procAurasExamined(0);
+std::atomic<uint64> Unit::_procAurasTriggered(0);
+LogStatsGate Unit::_procStatsGate("spells");
+
 // Used for prepare can/can`t triggr aura
 static bool InitTriggerAuraData();
 // Define can trigger auras
@@ -3362,6 +3371,20 @@ void Unit::_AddAura(UnitAura* aura, Unit* caster)
     }
 }
 
+// proc flags ProcDamageAndSpellFor checks the aura against, 0 if it can't proc there (see IsTriggeredAtSpellProcEvent)
+static uint32 GetOldProcSystemFlags(SpellInfo const* spellInfo)
+{
+    // handled by new proc system
+    if (sSpellMgr->GetSpellProcEntry(spellInfo->Id))
+        return 0;
+
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr->GetSpellProcEvent(spellInfo->Id);
+    if (spellProcEvent && spellProcEvent->procFlags)
+        return spellProcEvent->procFlags;
+
+    return spellInfo->ProcFlags;
+}
+
 // creates aura application instance and registers it in lists
 // aura application effects are handled separately to prevent aura list corruption
 AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint8 effMask)
@@ -3387,6 +3410,15 @@ AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint8 effMask)
     AuraApplication * aurApp = new AuraApplication(this, caster, aura, effMask);
     m_appliedAuras.insert(AuraApplicationMap::value_type(aurId, aurApp));
 
+    if (uint32 procFlags = GetOldProcSystemFlags(aurSpellInfo))
+    {
+        // after the auras of the same spell, like m_appliedAuras
+        ProcAura procAura = { aurId, procFlags, aurApp };
+        ProcAuraList::iterator itr = std::upper_bound(m_procAuras.begin(), m_procAuras.end(), procAura,
+            [](ProcAura const& left, ProcAura const& right) { return left.SpellId < right.SpellId; });
+        m_procAuras.insert(itr, procAura);
+    }
+
     if (aurSpellInfo->AuraInterruptFlags)
     {
         m_interruptableAuras.push_back(aurApp);
@@ -3472,6 +3504,15 @@ void Unit::_UnapplyAura(AuraApplicationMap::iterator &i, AuraRemoveMode removeMo
     // Remove all pointers from lists here to prevent possible pointer invalidation on spellcast/auraapply/auraremove
     m_appliedAuras.erase(i);
 
+    for (ProcAuraList::iterator itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
+    {
+        if (itr->Application == aurApp)
+        {
+            m_procAuras.erase(itr);
+            break;
+        }
+    }
+
     if (aura->GetSpellInfo()->AuraInterruptFlags)
     {
         m_interruptableAuras.remove(aurApp);
@@ -3596,6 +3637,8 @@ void Unit::_RegisterAuraEffect(AuraEffect* aurEff, bool apply)
         m_modAuras[aurEff->GetAuraType()].push_back(aurEff);
     else
         m_modAuras[aurEff->GetAuraType()].remove(aurEff);
+
+    _InvalidateAuraModifiers(aurEff->GetAuraType());
 }
 
 // All aura base removes should go threw this function!
@@ -4629,73 +4672,132 @@ uint32 Unit::GetDoTsByCaster(ObjectGuid casterGUID) const
     return dots;
 }
 
-int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+Unit::AuraModifierCache const* Unit::GetAuraModifierCache(AuraType auratype) const
 {
     AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
     if (mTotalAuraList.empty())
-        return 0;
+        return NULL;
+
+    bool statsEnabled = _auraModifierStatsGate.IsEnabled();
+    if (statsEnabled)
+        ++_auraModifierQueries;
+
+    AuraModifierCache& cache = m_auraModifiers[auratype];
+    if (cache.Valid)
+        return &cache;
+
+    if (statsEnabled)
+        ++_auraModifierRebuilds;
 
     std::map<SpellGroup, int32> SameEffectSpellGroup;
-    int32 modifier = 0;
+    cache.Modifiers.clear();
+    cache.TotalModifier = 0;
+    cache.TotalMultiplier = 1.0f;
+    cache.MaxPositiveModifier = 0;
+    cache.MaxNegativeModifier = 0;
 
     for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-            modifier += (*i)->GetAmount();
+    {
+        AuraModifier modifier;
+        modifier.Effect = *i;
+        modifier.MiscValue = (*i)->GetMiscValue();
+        modifier.Amount = (*i)->GetAmount();
+        modifier.StackGroup = sSpellMgr->GetSameEffectStackRuleSpellGroup((*i)->GetSpellInfo());
+        cache.Modifiers.push_back(modifier);
+
+        if (!SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup(modifier.StackGroup), modifier.Amount, SameEffectSpellGroup))
+            cache.TotalModifier += modifier.Amount;
+
+        AddPct(cache.TotalMultiplier, modifier.Amount);
+        cache.MaxPositiveModifier = std::max(cache.MaxPositiveModifier, modifier.Amount);
+        cache.MaxNegativeModifier = std::min(cache.MaxNegativeModifier, modifier.Amount);
+    }
 
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
-        modifier += itr->second;
+        cache.TotalModifier += itr->second;
 
-    return modifier;
+    cache.Valid = true;
+    return &cache;
 }
 
-float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+void Unit::_InvalidateAuraModifiers(AuraType auratype)
 {
-    float multiplier = 1.0f;
+    std::unordered_map<uint32, AuraModifierCache>::iterator itr = m_auraModifiers.find(auratype);
+    if (itr == m_auraModifiers.end())
+        return;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        AddPct(multiplier, (*i)->GetAmount());
+    if (m_modAuras[auratype].empty())
+        m_auraModifiers.erase(itr);
+    else
+        itr->second.Valid = false;
+}
 
-    return multiplier;
+void Unit::LogProcStats()
+{
+    bool statsEnabled = _procStatsGate.Refresh();
+
+    uint32 events = _procEvents.exchange(0);
+    uint64 applied = _procAurasApplied.exchange(0);
+    uint64 examined = _procAurasExamined.exchange(0);
+    uint64 triggered = _procAurasTriggered.exchange(0);
+
+    if (!events || !statsEnabled)
+        return;
+
+    TC_LOG_DEBUG("spells", "ProcDamageAndSpell: %u events, per event %.1f auras applied, %.1f examined, %.2f triggered",
+        events, float(applied) / float(events), float(examined) / float(events), float(triggered) / float(events));
 }
 
-int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+void Unit::LogAuraModifierStats()
 {
-    int32 modifier = 0;
+    bool statsEnabled = _auraModifierStatsGate.Refresh();
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        if ((*i)->GetAmount() > modifier)
-            modifier = (*i)->GetAmount();
-    }
+    uint32 queries = _auraModifierQueries.exchange(0);
+    uint32 rebuilds = _auraModifierRebuilds.exchange(0);
+    if (!queries || !statsEnabled)
+        return;
 
-    return modifier;
+    TC_LOG_DEBUG("entities.unit", "Aura modifiers: %u queries, %.1f%% served from cache, %u caches rebuilt",
+        queries, float(queries - rebuilds) * 100.0f / float(queries), rebuilds);
 }
 
-int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
+int32 Unit::GetTotalAuraModifier(AuraType auratype) const
 {
-    int32 modifier = 0;
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    return cache ? cache->TotalModifier : 0;
+}
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetAmount() < modifier)
-            modifier = (*i)->GetAmount();
+float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+{
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    return cache ? cache->TotalMultiplier : 1.0f;
+}
 
-    return modifier;
+int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+{
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    return cache ? cache->MaxPositiveModifier : 0;
+}
+
+int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
+{
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    return cache ? cache->MaxNegativeModifier : 0;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetMiscValue() & miscMask)
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                modifier += (*i)->GetAmount();
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
+        if (i->MiscValue & miscMask)
+            if (!SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup(i->StackGroup), i->Amount, SameEffectSpellGroup))
+                modifier += i->Amount;
 
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
         modifier += itr->second;
@@ -4705,18 +4807,21 @@ int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) c
 
 float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 miscMask) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 1.0f;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if (((*i)->GetMiscValue() & miscMask))
+        if ((i->MiscValue & miscMask))
         {
             // Check if the Aura Effect has a the Same Effect Stack Rule and if so, use the highest amount of that SpellGroup
             // If the Aura Effect does not have this Stack Rule, it returns false so we can add to the multiplier as usual
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                AddPct(multiplier, (*i)->GetAmount());
+            if (!SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup(i->StackGroup), i->Amount, SameEffectSpellGroup))
+                AddPct(multiplier, i->Amount);
         }
     }
     // Add the highest of the Same Effect Stack Rule SpellGroups to the multiplier
@@ -4728,13 +4833,16 @@ float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 miscMask)
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 miscMask, const AuraEffect* except) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if (except != (*i) && (*i)->GetMiscValue()& miscMask && (*i)->GetAmount() > modifier)
-            modifier = (*i)->GetAmount();
+        if (except != i->Effect && i->MiscValue & miscMask && i->Amount > modifier)
+            modifier = i->Amount;
     }
 
     return modifier;
@@ -4742,13 +4850,16 @@ int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 miscM
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 miscMask) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->GetMiscValue()& miscMask && (*i)->GetAmount() < modifier)
-            modifier = (*i)->GetAmount();
+        if (i->MiscValue & miscMask && i->Amount < modifier)
+            modifier = i->Amount;
     }
 
     return modifier;
@@ -4756,15 +4867,18 @@ int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 miscM
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->GetMiscValue() == miscValue)
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                modifier += (*i)->GetAmount();
+        if (i->MiscValue == miscValue)
+            if (!SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup(i->StackGroup), i->Amount, SameEffectSpellGroup))
+                modifier += i->Amount;
     }
 
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
@@ -4775,15 +4889,18 @@ int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 miscValue)
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 miscValue) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 1.0f;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->GetMiscValue() == miscValue)
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                AddPct(multiplier, (*i)->GetAmount());
+        if (i->MiscValue == miscValue)
+            if (!SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup(i->StackGroup), i->Amount, SameEffectSpellGroup))
+                AddPct(multiplier, i->Amount);
     }
 
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
@@ -4794,13 +4911,16 @@ float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 miscValue
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->GetMiscValue() == miscValue && (*i)->GetAmount() > modifier)
-            modifier = (*i)->GetAmount();
+        if (i->MiscValue == miscValue && i->Amount > modifier)
+            modifier = i->Amount;
     }
 
     return modifier;
@@ -4808,13 +4928,16 @@ int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 miscV
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 miscValue) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->GetMiscValue() == miscValue && (*i)->GetAmount() < modifier)
-            modifier = (*i)->GetAmount();
+        if (i->MiscValue == miscValue && i->Amount < modifier)
+            modifier = i->Amount;
     }
 
     return modifier;
@@ -4822,15 +4945,18 @@ int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 miscV
 
 int32 Unit::GetTotalAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->IsAffectedOnSpell(affectedSpell))
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                modifier += (*i)->GetAmount();
+        if (i->Effect->IsAffectedOnSpell(affectedSpell))
+            if (!SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup(i->StackGroup), i->Amount, SameEffectSpellGroup))
+                modifier += i->Amount;
     }
 
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
@@ -4841,15 +4967,18 @@ int32 Unit::GetTotalAuraModifierByAffectMask(AuraType auratype, SpellInfo const*
 
 float Unit::GetTotalAuraMultiplierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 1.0f;
+
     std::map<SpellGroup, int32> SameEffectSpellGroup;
     float multiplier = 1.0f;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->IsAffectedOnSpell(affectedSpell))
-            if (!sSpellMgr->AddSameEffectStackRuleSpellGroups((*i)->GetSpellInfo(), (*i)->GetAmount(), SameEffectSpellGroup))
-                AddPct(multiplier, (*i)->GetAmount());
+        if (i->Effect->IsAffectedOnSpell(affectedSpell))
+            if (!SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup(i->StackGroup), i->Amount, SameEffectSpellGroup))
+                AddPct(multiplier, i->Amount);
     }
 
     for (std::map<SpellGroup, int32>::const_iterator itr = SameEffectSpellGroup.begin(); itr != SameEffectSpellGroup.end(); ++itr)
@@ -4860,13 +4989,16 @@ float Unit::GetTotalAuraMultiplierByAffectMask(AuraType auratype, SpellInfo cons
 
 int32 Unit::GetMaxPositiveAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->IsAffectedOnSpell(affectedSpell) && (*i)->GetAmount() > modifier)
-            modifier = (*i)->GetAmount();
+        if (i->Effect->IsAffectedOnSpell(affectedSpell) && i->Amount > modifier)
+            modifier = i->Amount;
     }
 
     return modifier;
@@ -4874,13 +5006,16 @@ int32 Unit::GetMaxPositiveAuraModifierByAffectMask(AuraType auratype, SpellInfo
 
 int32 Unit::GetMaxNegativeAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const
 {
+    AuraModifierCache const* cache = GetAuraModifierCache(auratype);
+    if (!cache)
+        return 0;
+
     int32 modifier = 0;
 
-    AuraEffectList const& mTotalAuraList = GetAuraEffectsByType(auratype);
-    for (AuraEffectList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+    for (std::vector<AuraModifier>::const_iterator i = cache->Modifiers.begin(); i != cache->Modifiers.end(); ++i)
     {
-        if ((*i)->IsAffectedOnSpell(affectedSpell) && (*i)->GetAmount() < modifier)
-            modifier = (*i)->GetAmount();
+        if (i->Effect->IsAffectedOnSpell(affectedSpell) && i->Amount < modifier)
+            modifier = i->Amount;
     }
 
     return modifier;
@@ -14274,20 +14409,40 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
     HealInfo healInfo = HealInfo(actor, actionTarget, damage, procSpell, procSpell ? SpellSchoolMask(procSpell->SchoolMask) : SPELL_SCHOOL_MASK_NORMAL);
     ProcEventInfo eventInfo = ProcEventInfo(actor, actionTarget, target, procFlag, 0, 0, procExtra, nullptr, &damageInfo, &healInfo);
 
+    if (isVictim)
+        procExtra &= ~PROC_EX_INTERNAL_REQ_FAMILY;
+
+    // auras without any of the proc flags can't trigger (see SpellMgr::IsSpellProcEventCanTriggeredBy)
+    // copied, proc checks of scripts may apply or remove auras
+    ProcAuraList candidates;
+    for (ProcAuraList::const_iterator itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
+        if (itr->ProcFlags & procFlag)
+            candidates.push_back(*itr);
+
+    bool statsEnabled = _procStatsGate.IsEnabled();
+    if (statsEnabled)
+    {
+        ++_procEvents;
+        _procAurasApplied += m_appliedAuras.size();
+        _procAurasExamined += candidates.size();
+    }
+
     ProcTriggeredList procTriggered;
     // Fill procTriggered list
-    for (AuraApplicationMap::const_iterator itr = GetAppliedAuras().begin(); itr!= GetAppliedAuras().end(); ++itr)
+    for (ProcAuraList::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
     {
         // Do not allow auras to proc from effect triggered by itself
-        if (procAura && procAura->Id == itr->first)
+        if (procAura && procAura->Id == itr->SpellId)
+            continue;
+        AuraApplication* aurApp = itr->Application;
+        // removed by the checks of another aura
+        if (aurApp->GetRemoveMode())
             continue;
-        ProcTriggeredData triggerData(itr->second->GetBase());
+        ProcTriggeredData triggerData(aurApp->GetBase());
         // Defensive procs are active on absorbs (so absorption effects are not a hindrance)
         bool active = damage || (procExtra & PROC_EX_BLOCK && isVictim);
-        if (isVictim)
-            procExtra &= ~PROC_EX_INTERNAL_REQ_FAMILY;
 
-        SpellInfo const* spellProto = itr->second->GetBase()->GetSpellInfo();
+        SpellInfo const* spellProto = aurApp->GetBase()->GetSpellInfo();
 
         // only auras that has triggered spell should proc from fully absorbed damage
         if (procExtra & PROC_EX_ABSORB && isVictim)
@@ -14302,7 +14457,7 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
             continue;
 
         // AuraScript Hook
-        if (!triggerData.aura->CallScriptCheckProcHandlers(itr->second, eventInfo))
+        if (!triggerData.aura->CallScriptCheckProcHandlers(aurApp, eventInfo))
             continue;
 
         // Triggered spells not triggering additional spells
@@ -14311,9 +14466,9 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
 
         for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
         {
-            if (itr->second->HasEffect(i))
+            if (aurApp->HasEffect(i))
             {
-                AuraEffect* aurEff = itr->second->GetBase()->GetEffect(i);
+                AuraEffect* aurEff = aurApp->GetBase()->GetEffect(i);
                 // Skip this auras
                 if (isNonTriggerAura[aurEff->GetAuraType()])
                     continue;
@@ -14329,6 +14484,9 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
             procTriggered.push_front(triggerData);
     }
 
+    if (statsEnabled)
+        _procAurasTriggered += procTriggered.size();
+
     // Nothing found
     if (procTriggered.empty())
         return;
@@ -17968,6 +18126,31 @@ void Unit::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* target)
     data->append(fieldBuffer);
 }
 
+uint32 Unit::GetValuesUpdateShareKey(Player const* target) const
+{
+    // fields rewritten per target in BuildValuesUpdate can not be shared once they changed
+    if (_fieldNotifyFlags || HasFlag(UNIT_FIELD_AURASTATE, PER_CASTER_AURA_STATE_MASK))
+        return 0;
+
+    if (_changesMask.GetBit(UNIT_DYNAMIC_FLAGS) && (GetTypeId() == TYPEID_UNIT || HasFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_TRACK_UNIT)))
+        return 0;
+
+    if (_changesMask.GetBit(UNIT_NPC_FLAGS) && GetTypeId() == TYPEID_UNIT && HasFlag(UNIT_NPC_FLAGS, UNIT_NPC_FLAG_SPELLCLICK))
+        return 0;
+
+    if ((_changesMask.GetBit(UNIT_FIELD_BYTES_2) || _changesMask.GetBit(UNIT_FIELD_FACTIONTEMPLATE)) &&
+        IsControlledByPlayer() && sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_GROUP))
+        return 0;
+
+    uint32 shareKey = Object::GetValuesUpdateShareKey(target);
+
+    // UNIT_FIELD_FLAGS and UNIT_FIELD_DISPLAYID only differ for gamemasters, keep them apart
+    if (target->IsGameMaster())
+        shareKey |= 0x10000;
+
+    return shareKey;
+}
+
 int32 Unit::GetHighestExclusiveSameEffectSpellGroupValue(AuraEffect const* aurEff, AuraType auraType, bool checkMiscValue /*= false*/, int32 miscValue /*= 0*/) const
 {
     int32 val = 0;
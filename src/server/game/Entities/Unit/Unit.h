@@ -24,11 +24,16 @@
 #include "FollowerReference.h"
 #include "FollowerRefManager.h"
 #include "HostileRefManager.h"
+#include "LogStatsGate.h"
 #include "MotionMaster.h"
 #include "Object.h"
 #include "SpellAuraDefines.h"
 #include "ThreatManager.h"
 
+#include <atomic>
+
+#include <boost/container/flat_map.hpp>
+
 #define WORLD_TRIGGER   12999
 
 enum SpellInterruptFlags
@@ -1224,7 +1229,8 @@ class TC_GAME_API Unit : public WorldObject
         typedef std::pair<AuraApplicationMap::const_iterator, AuraApplicationMap::const_iterator> AuraApplicationMapBounds;
         typedef std::pair<AuraApplicationMap::iterator, AuraApplicationMap::iterator> AuraApplicationMapBoundsNonConst;
 
-        typedef std::multimap<AuraStateType,  AuraApplication*> AuraStateAurasMap;
+        // small and only changed when auras are applied or removed, looked up far more often
+        typedef boost::container::flat_multimap<AuraStateType, AuraApplication*> AuraStateAurasMap;
         typedef std::pair<AuraStateAurasMap::const_iterator, AuraStateAurasMap::const_iterator> AuraStateAurasMapBounds;
 
         typedef std::list<AuraEffect*> AuraEffectList;
@@ -1232,7 +1238,7 @@ class TC_GAME_API Unit : public WorldObject
         typedef std::list<AuraApplication *> AuraApplicationList;
         typedef std::list<DiminishingReturn> Diminishing;
 
-        typedef std::map<uint8, AuraApplication*> VisibleAuraMap;
+        typedef boost::container::flat_map<uint8, AuraApplication*> VisibleAuraMap;
 
         virtual ~Unit();
 
@@ -1410,6 +1416,8 @@ class TC_GAME_API Unit : public WorldObject
 
         void ProcDamageAndSpell(Unit* victim, uint32 procAttacker, uint32 procVictim, uint32 procEx, uint32 amount, WeaponAttackType attType = BASE_ATTACK, SpellInfo const* procSpell = NULL, SpellInfo const* procAura = NULL);
         void ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, SpellInfo const* procSpell, uint32 damage, SpellInfo const* procAura = NULL);
+        /// Writes the number of auras examined and procs triggered per proc event of all units to the log and resets the counters
+        static void LogProcStats();
 
         void GetProcAurasTriggeredOnEvent(AuraApplicationList& aurasTriggeringProc, AuraApplicationList* procAuras, ProcEventInfo eventInfo);
         void TriggerAurasProcOnEvent(CalcDamageInfo& damageInfo);
@@ -1685,6 +1693,7 @@ class TC_GAME_API Unit : public WorldObject
         void _RemoveNoStackAurasDueToAura(Aura* aura);
         bool _IsNoStackAuraDueToAura(Aura* appliedAura, Aura* existingAura) const;
         void _RegisterAuraEffect(AuraEffect* aurEff, bool apply);
+        void _InvalidateAuraModifiers(AuraType auratype);
 
         // m_ownedAuras container management
         AuraMap      & GetOwnedAuras()       { return m_ownedAuras; }
@@ -1794,6 +1803,9 @@ class TC_GAME_API Unit : public WorldObject
         int32 GetMaxPositiveAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
         int32 GetMaxNegativeAuraModifierByAffectMask(AuraType auratype, SpellInfo const* affectedSpell) const;
 
+        /// Writes the hit rate of the aura modifier caches of all units to the log and resets the counters
+        static void LogAuraModifierStats();
+
         float GetResistanceBuffMods(SpellSchools school, bool positive) const;
         void SetResistanceBuffMods(SpellSchools school, bool positive, float val);
         void ApplyResistanceBuffModsMod(SpellSchools school, bool positive, float val, bool apply);
@@ -2151,6 +2163,7 @@ class TC_GAME_API Unit : public WorldObject
         explicit Unit (bool isWorldObject);
 
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const override;
+        uint32 GetValuesUpdateShareKey(Player const* target) const override;
 
         UnitAI* i_AI, *i_disabledAI;
 
@@ -2190,8 +2203,41 @@ class TC_GAME_API Unit : public WorldObject
         uint32 m_removedAurasCount;
 
         AuraEffectList m_modAuras[TOTAL_AURAS];
+
+        struct AuraModifier
+        {
+            AuraEffect const* Effect;
+            int32 MiscValue;
+            int32 Amount;
+            uint32 StackGroup;                              // SPELL_GROUP_STACK_RULE_EXCLUSIVE_SAME_EFFECT group of the spell, only the highest amount of a group counts
+        };
+
+        /// Contiguous copy of m_modAuras[type] and its aggregates, rebuilt on first use after an effect of the type was added, removed or changed its amount
+        struct AuraModifierCache
+        {
+            std::vector<AuraModifier> Modifiers;
+            int32 TotalModifier;
+            float TotalMultiplier;
+            int32 MaxPositiveModifier;
+            int32 MaxNegativeModifier;
+            bool Valid;
+        };
+
+        AuraModifierCache const* GetAuraModifierCache(AuraType auratype) const;
+
+        mutable std::unordered_map<uint32, AuraModifierCache> m_auraModifiers;  // by AuraType, only types with effects
         AuraList m_scAuras;                        // cast singlecast auras
         AuraApplicationList m_interruptableAuras;  // auras which have interrupt mask applied on unit
+
+        struct ProcAura
+        {
+            uint32 SpellId;
+            uint32 ProcFlags;                               // PROC_FLAG_* of the spell_proc_event entry or the spell
+            AuraApplication* Application;
+        };
+
+        typedef std::vector<ProcAura> ProcAuraList;
+        ProcAuraList m_procAuras;                  // applied auras handled by ProcDamageAndSpellFor that have proc flags, in m_appliedAuras order
         AuraStateAurasMap m_auraStateAuras;        // Used for improve performance of aura state checks on aura apply/remove
         uint32 m_interruptMask;
 
@@ -2271,6 +2317,15 @@ class TC_GAME_API Unit : public WorldObject
         time_t _lastDamagedTime; // Part of Evade mechanics
 
         SpellHistory* m_spellHistory;
+
+        static std::atomic<uint32> _auraModifierQueries;
+        static std::atomic<uint32> _auraModifierRebuilds;
+        static LogStatsGate _auraModifierStatsGate;
+        static std::atomic<uint32> _procEvents;
+        static std::atomic<uint64> _procAurasApplied;
+        static std::atomic<uint64> _procAurasExamined;
+        static std::atomic<uint64> _procAurasTriggered;
+        static LogStatsGate _procStatsGate;
 };
 
 namespace Trinity
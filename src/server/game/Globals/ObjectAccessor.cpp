@@ -37,45 +37,36 @@
 template<class T>
 void HashMapHolder<T>::Insert(T* o)
 {
-    boost::unique_lock<boost::shared_mutex> lock(*GetLock());
+    Shard& shard = GetShard(o->GetGUID());
+    boost::unique_lock<boost::shared_mutex> lock(shard.Lock);
 
-    GetContainer()[o->GetGUID()] = o;
+    shard.Objects[o->GetGUID()] = o;
 }
 
 template<class T>
 void HashMapHolder<T>::Remove(T* o)
 {
-    boost::unique_lock<boost::shared_mutex> lock(*GetLock());
+    Shard& shard = GetShard(o->GetGUID());
+    boost::unique_lock<boost::shared_mutex> lock(shard.Lock);
 
-    GetContainer().erase(o->GetGUID());
+    shard.Objects.erase(o->GetGUID());
 }
 
 template<class T>
 T* HashMapHolder<T>::Find(ObjectGuid guid)
 {
-    boost::shared_lock<boost::shared_mutex> lock(*GetLock());
+    Shard& shard = GetShard(guid);
+    boost::shared_lock<boost::shared_mutex> lock(shard.Lock);
 
-    typename MapType::iterator itr = GetContainer().find(guid);
-    return (itr != GetContainer().end()) ? itr->second : NULL;
+    typename MapType::iterator itr = shard.Objects.find(guid);
+    return (itr != shard.Objects.end()) ? itr->second : NULL;
 }
 
 template<class T>
-auto HashMapHolder<T>::GetContainer() -> MapType&
+auto HashMapHolder<T>::GetShard(uint32 index) -> Shard&
 {
-    static MapType _objectMap;
-    return _objectMap;
-}
-
-template<class T>
-boost::shared_mutex* HashMapHolder<T>::GetLock()
-{
-    static boost::shared_mutex _lock;
-    return &_lock;
-}
-
-HashMapHolder<Player>::MapType const& ObjectAccessor::GetPlayers()
-{
-    return HashMapHolder<Player>::GetContainer();
+    static Shard _shards[SHARD_COUNT];
+    return _shards[index];
 }
 
 template class TC_GAME_API HashMapHolder<Player>;
@@ -215,49 +206,45 @@ Player* ObjectAccessor::FindConnectedPlayer(ObjectGuid const& guid)
     return HashMapHolder<Player>::Find(guid);
 }
 
-Player* ObjectAccessor::FindPlayerByName(std::string const& name)
+static Player* FindPlayerByLowerCaseName(std::string const& nameStr, bool inWorldOnly)
 {
-    boost::shared_lock<boost::shared_mutex> lock(*HashMapHolder<Player>::GetLock());
-
-    std::string nameStr = name;
-    std::transform(nameStr.begin(), nameStr.end(), nameStr.begin(), ::tolower);
-    HashMapHolder<Player>::MapType const& m = GetPlayers();
-    for (HashMapHolder<Player>::MapType::const_iterator iter = m.begin(); iter != m.end(); ++iter)
+    for (uint32 i = 0; i < HashMapHolder<Player>::SHARD_COUNT; ++i)
     {
-        if (!iter->second->IsInWorld())
-            continue;
-        std::string currentName = iter->second->GetName();
-        std::transform(currentName.begin(), currentName.end(), currentName.begin(), ::tolower);
-        if (nameStr.compare(currentName) == 0)
-            return iter->second;
+        HashMapHolder<Player>::Shard& shard = HashMapHolder<Player>::GetShard(i);
+        boost::shared_lock<boost::shared_mutex> lock(shard.Lock);
+
+        for (HashMapHolder<Player>::MapType::const_iterator iter = shard.Objects.begin(); iter != shard.Objects.end(); ++iter)
+        {
+            if (inWorldOnly && !iter->second->IsInWorld())
+                continue;
+            std::string currentName = iter->second->GetName();
+            std::transform(currentName.begin(), currentName.end(), currentName.begin(), ::tolower);
+            if (nameStr.compare(currentName) == 0)
+                return iter->second;
+        }
     }
 
     return NULL;
 }
 
-Player* ObjectAccessor::FindConnectedPlayerByName(std::string const& name)
+Player* ObjectAccessor::FindPlayerByName(std::string const& name)
 {
-    boost::shared_lock<boost::shared_mutex> lock(*HashMapHolder<Player>::GetLock());
-
     std::string nameStr = name;
     std::transform(nameStr.begin(), nameStr.end(), nameStr.begin(), ::tolower);
-    HashMapHolder<Player>::MapType const& m = GetPlayers();
-    for (HashMapHolder<Player>::MapType::const_iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        std::string currentName = iter->second->GetName();
-        std::transform(currentName.begin(), currentName.end(), currentName.begin(), ::tolower);
-        if (nameStr.compare(currentName) == 0)
-            return iter->second;
-    }
+    return FindPlayerByLowerCaseName(nameStr, true);
+}
 
-    return NULL;
+Player* ObjectAccessor::FindConnectedPlayerByName(std::string const& name)
+{
+    std::string nameStr = name;
+    std::transform(nameStr.begin(), nameStr.end(), nameStr.begin(), ::tolower);
+    return FindPlayerByLowerCaseName(nameStr, false);
 }
 
 void ObjectAccessor::SaveAllPlayers()
 {
-    boost::shared_lock<boost::shared_mutex> lock(*HashMapHolder<Player>::GetLock());
-
-    HashMapHolder<Player>::MapType const& m = GetPlayers();
-    for (HashMapHolder<Player>::MapType::const_iterator itr = m.begin(); itr != m.end(); ++itr)
-        itr->second->SaveToDB();
+    DoForAllPlayers([](Player* player)
+    {
+        player->SaveToDB();
+    });
 }
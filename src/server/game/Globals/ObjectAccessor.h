@@ -19,7 +19,6 @@
 #ifndef TRINITY_OBJECTACCESSOR_H
 #define TRINITY_OBJECTACCESSOR_H
 
-#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <boost/thread/locks.hpp>
@@ -54,15 +53,38 @@ public:
 
     typedef std::unordered_map<ObjectGuid, T*> MapType;
 
+    // objects are spread over several independently locked shards so that lookups
+    // from different map threads don't all serialize on (and bounce) a single lock
+    static uint32 const SHARD_COUNT = 16;
+
+    struct DECLSPEC_ALIGN(64) Shard
+    {
+        boost::shared_mutex Lock;
+        MapType Objects;
+    };
+
     static void Insert(T* o);
 
     static void Remove(T* o);
 
     static T* Find(ObjectGuid guid);
 
-    static MapType& GetContainer();
+    // calls worker(T*) for every registered object, holding a read lock on one shard at a time
+    template<class Worker>
+    static void DoForAll(Worker&& worker)
+    {
+        for (uint32 i = 0; i < SHARD_COUNT; ++i)
+        {
+            Shard& shard = GetShard(i);
+            boost::shared_lock<boost::shared_mutex> lock(shard.Lock);
+            for (typename MapType::value_type const& pair : shard.Objects)
+                worker(pair.second);
+        }
+    }
+
+    static Shard& GetShard(uint32 index);
 
-    static boost::shared_mutex* GetLock();
+    static Shard& GetShard(ObjectGuid const& guid) { return GetShard(uint32(guid.GetCounter() % SHARD_COUNT)); }
 };
 
 namespace ObjectAccessor
@@ -90,8 +112,11 @@ namespace ObjectAccessor
     TC_GAME_API Player* FindConnectedPlayer(ObjectGuid const&);
     TC_GAME_API Player* FindConnectedPlayerByName(std::string const& name);
 
-    // when using this, you must use the hashmapholder's lock
-    TC_GAME_API HashMapHolder<Player>::MapType const& GetPlayers();
+    template<class Worker>
+    void DoForAllPlayers(Worker&& worker)
+    {
+        HashMapHolder<Player>::DoForAll(std::forward<Worker>(worker));
+    }
 
     template<class T>
     void AddObject(T* object)
@@ -41,6 +41,7 @@
 #include "SpellAuras.h"
 #include "SpellMgr.h"
 #include "SpellScript.h"
+#include "StartupTaskGraph.h"
 #include "UpdateMask.h"
 #include "Util.h"
 #include "Vehicle.h"
@@ -5455,6 +5456,8 @@ GossipText const* ObjectMgr::GetGossipText(uint32 Text_ID) const
 
 void ObjectMgr::LoadGossipText()
 {
+    StartupTaskGraph::Require("broadcast texts");
+
     uint32 oldMSTime = getMSTime();
 
     QueryResult result = WorldDatabase.Query("SELECT ID, "
@@ -7682,6 +7685,8 @@ PetNameInvalidReason ObjectMgr::CheckPetName(const std::string& name, LocaleCons
 
 void ObjectMgr::LoadGameObjectForQuests()
 {
+    StartupTaskGraph::Require("loot templates");
+
     uint32 oldMSTime = getMSTime();
 
     _gameObjectForQuestStore.clear();                         // need for reload case
@@ -8333,6 +8338,8 @@ void ObjectMgr::LoadVendors()
 
 void ObjectMgr::LoadGossipMenu()
 {
+    StartupTaskGraph::Require("npc texts");
+
     uint32 oldMSTime = getMSTime();
 
     _gossipMenusStore.clear();
@@ -8373,6 +8380,9 @@ void ObjectMgr::LoadGossipMenu()
 
 void ObjectMgr::LoadGossipMenuItems()
 {
+    StartupTaskGraph::Require("broadcast texts");
+    StartupTaskGraph::Require("points of interest");
+
     uint32 oldMSTime = getMSTime();
 
     _gossipMenuItemsStore.clear();
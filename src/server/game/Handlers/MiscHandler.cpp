@@ -246,42 +246,38 @@ void WorldSession::HandleWhoOpcode(WorldPacket& recvData)
     data << uint32(matchcount);                           // placeholder, count of players matching criteria
     data << uint32(displaycount);                         // placeholder, count of players displayed
 
-    boost::shared_lock<boost::shared_mutex> lock(*HashMapHolder<Player>::GetLock());
-
-    HashMapHolder<Player>::MapType const& m = ObjectAccessor::GetPlayers();
-    for (HashMapHolder<Player>::MapType::const_iterator itr = m.begin(); itr != m.end(); ++itr)
+    ObjectAccessor::DoForAllPlayers([&](Player* target)
     {
-        Player* target = itr->second;
         // player can see member of other team only if CONFIG_ALLOW_TWO_SIDE_WHO_LIST
         if (target->GetTeam() != team && !HasPermission(rbac::RBAC_PERM_TWO_SIDE_WHO_LIST))
-            continue;
+            return;
 
         // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
         if (!HasPermission(rbac::RBAC_PERM_WHO_SEE_ALL_SEC_LEVELS) && target->GetSession()->GetSecurity() > AccountTypes(gmLevelInWhoList))
-            continue;
+            return;
 
         // do not process players which are not in world
         if (!target->IsInWorld())
-            continue;
+            return;
 
         // check if target is globally visible for player
         if (!target->IsVisibleGloballyFor(_player))
-            continue;
+            return;
 
         // check if target's level is in level range
         uint8 lvl = target->getLevel();
         if (lvl < level_min || lvl > level_max)
-            continue;
+            return;
 
         // check if class matches classmask
         uint8 class_ = target->getClass();
         if (!(classmask & (1 << class_)))
-            continue;
+            return;
 
         // check if race matches racemask
         uint32 race = target->getRace();
         if (!(racemask & (1 << race)))
-            continue;
+            return;
 
         uint32 pzoneid = target->GetZoneId();
         uint8 gender = target->GetByteValue(PLAYER_BYTES_3, 0);
@@ -298,25 +294,25 @@ void WorldSession::HandleWhoOpcode(WorldPacket& recvData)
             z_show = false;
         }
         if (!z_show)
-            continue;
+            return;
 
         std::string pname = target->GetName();
         std::wstring wpname;
         if (!Utf8toWStr(pname, wpname))
-            continue;
+            return;
         wstrToLower(wpname);
 
         if (!(wplayer_name.empty() || wpname.find(wplayer_name) != std::wstring::npos))
-            continue;
+            return;
 
         std::string gname = sGuildMgr->GetGuildNameById(target->GetGuildId());
         std::wstring wgname;
         if (!Utf8toWStr(gname, wgname))
-            continue;
+            return;
         wstrToLower(wgname);
 
         if (!(wguild_name.empty() || wgname.find(wguild_name) != std::wstring::npos))
-            continue;
+            return;
 
         std::string aname;
         if (AreaTableEntry const* areaEntry = sAreaTableStore.LookupEntry(pzoneid))
@@ -338,12 +334,12 @@ void WorldSession::HandleWhoOpcode(WorldPacket& recvData)
             }
         }
         if (!s_show)
-            continue;
+            return;
 
         // 49 is maximum player count sent to client - can be overridden
         // through config, but is unstable
         if ((matchcount++) >= sWorld->getIntConfig(CONFIG_MAX_WHO))
-            continue;
+            return;
 
         data << pname;                                    // player name
         data << gname;                                    // guild name
@@ -354,7 +350,7 @@ void WorldSession::HandleWhoOpcode(WorldPacket& recvData)
         data << uint32(pzoneid);                          // player zone id
 
         ++displaycount;
-    }
+    });
 
     data.put(0, displaycount);                            // insert right count, count displayed
     data.put(4, matchcount);                              // insert right count, count of matches
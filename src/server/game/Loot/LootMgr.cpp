@@ -27,6 +27,7 @@
 #include "Group.h"
 #include "Player.h"
 #include "Containers.h"
+#include "StartupTaskGraph.h"
 
 static Rates const qualityToRate[MAX_ITEM_QUALITY] =
 {
@@ -1874,6 +1875,8 @@ void LoadLootTemplates_Reference()
 
 void LoadLootTables()
 {
+    StartupTaskGraph::Require("templates");
+
     LoadLootTemplates_Creature();
     LoadLootTemplates_Fishing();
     LoadLootTemplates_Gameobject();
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GridPreloader.h"
+#include "DisableMgr.h"
+#include "Log.h"
+#include "Map.h"
+#include "MMapFactory.h"
+#include "VMapFactory.h"
+#include "VMapManager2.h"
+#include "World.h"
+
+#include <chrono>
+
+#define PRELOADED_GRID_EXPIRY   60 * IN_MILLISECONDS
+
+PreloadedGrid::PreloadedGrid(uint32 mapId, uint32 gx, uint32 gy) : MapId(mapId), GridX(gx), GridY(gy),
+    MMapTile(nullptr), MMapTileSize(0), LoadTime(0)
+{
+}
+
+PreloadedGrid::~PreloadedGrid()
+{
+    // drop the references taken for the models, whatever the vmap tile did not pick up is unloaded again
+    if (!VMapModels.empty())
+        if (VMAP::VMapManager2* vmmgr2 = dynamic_cast<VMAP::VMapManager2*>(VMAP::VMapFactory::createOrGetVMapManager()))
+            for (std::string const& model : VMapModels)
+                vmmgr2->releaseModelInstance(model);
+
+    if (MMapTile)
+        dtFree(MMapTile);
+}
+
+GridPreloader::GridPreloader() : _cancelationToken(false), _time(0), _hits(0), _misses(0), _dropped(0), _stallAvoided(0), _stallTime(0)
+{
+}
+
+GridPreloader* GridPreloader::instance()
+{
+    static GridPreloader instance;
+    return &instance;
+}
+
+void GridPreloader::Initialize(uint32 threads)
+{
+    ASSERT(_workerThreads.empty());
+
+    for (uint32 i = 0; i < threads; ++i)
+        _workerThreads.push_back(std::thread(&GridPreloader::WorkerThread, this));
+}
+
+void GridPreloader::Deactivate()
+{
+    _cancelationToken = true;
+    _queue.Cancel();
+
+    for (std::thread& thread : _workerThreads)
+        thread.join();
+
+    _workerThreads.clear();
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries.clear();
+}
+
+void GridPreloader::Request(uint32 mapId, uint32 gx, uint32 gy)
+{
+    if (!IsEnabled())
+        return;
+
+    uint64 key = MakeKey(mapId, gx, gy);
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_entries.emplace(key, Entry()).second)
+            return;
+    }
+
+    _queue.Push(key);
+}
+
+std::unique_ptr<PreloadedGrid> GridPreloader::Take(uint32 mapId, uint32 gx, uint32 gy)
+{
+    if (!IsEnabled())
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    auto itr = _entries.find(MakeKey(mapId, gx, gy));
+    if (itr == _entries.end())
+        return nullptr;
+
+    // still queued or loading - the map loads the grid itself and the worker result is discarded
+    std::unique_ptr<PreloadedGrid> grid = std::move(itr->second.Grid);
+    _entries.erase(itr);
+    return grid;
+}
+
+void GridPreloader::RecordHit(uint32 loadTime)
+{
+    ++_hits;
+    _stallAvoided += loadTime;
+}
+
+void GridPreloader::RecordMiss(uint32 loadTime)
+{
+    ++_misses;
+    _stallTime += loadTime;
+}
+
+void GridPreloader::Update(uint32 diff)
+{
+    if (!IsEnabled())
+        return;
+
+    std::vector<std::unique_ptr<PreloadedGrid>> expired;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _time += diff;
+
+        for (auto itr = _entries.begin(); itr != _entries.end();)
+        {
+            if (itr->second.Grid && _time - itr->second.ReadyTime > PRELOADED_GRID_EXPIRY)
+            {
+                expired.push_back(std::move(itr->second.Grid));
+                itr = _entries.erase(itr);
+            }
+            else
+                ++itr;
+        }
+    }
+
+    // released outside of the lock, dropping vmap models can be expensive
+    _dropped += uint32(expired.size());
+}
+
+void GridPreloader::LogStats()
+{
+    if (!IsEnabled() || !sLog->ShouldLog("maps", LOG_LEVEL_DEBUG))
+        return;
+
+    uint32 hits = _hits.exchange(0);
+    uint32 misses = _misses.exchange(0);
+    uint32 dropped = _dropped.exchange(0);
+    uint64 stallAvoided = _stallAvoided.exchange(0);
+    uint64 stallTime = _stallTime.exchange(0);
+
+    if (!hits && !misses && !dropped)
+        return;
+
+    TC_LOG_DEBUG("maps", "GridPreloader: %u grids preloaded (%u ms moved off map threads), %u loaded synchronously (%u ms), %u preloaded grids dropped unused",
+        hits, uint32(stallAvoided / 1000), misses, uint32(stallTime / 1000), dropped);
+}
+
+void GridPreloader::Load(PreloadedGrid& grid) const
+{
+    std::string const& dataPath = sWorld->GetDataPath();
+
+    // terrain - map the file and fault its pages in now instead of on the first height query
+    char fileName[16];
+    snprintf(fileName, sizeof(fileName), "%03u%02u%02u.map", grid.MapId, grid.GridX, grid.GridY);
+
+    grid.Terrain.reset(new GridMap());
+    if (grid.Terrain->loadData((dataPath + "maps/" + fileName).c_str()))
+        grid.Terrain->prefetchData();
+    else
+        grid.Terrain.reset();   // let the map report the error when it loads the grid itself
+
+    // vmaps - parse the models spawned in the tile, the tree itself is only updated by the map
+    if (VMAP::VMapManager2* vmmgr2 = dynamic_cast<VMAP::VMapManager2*>(VMAP::VMapFactory::createOrGetVMapManager()))
+        vmmgr2->preloadMapTile(dataPath + "vmaps/", grid.MapId, grid.GridX, grid.GridY, grid.VMapModels);
+
+    // mmaps - read the tile, the navmesh is only modified by the map
+    if (DisableMgr::IsPathfindingEnabled(grid.MapId))
+        grid.MMapTile = MMAP::MMapManager::readTile(dataPath + "mmaps", grid.MapId, grid.GridX, grid.GridY, grid.MMapTileSize);
+}
+
+void GridPreloader::WorkerThread()
+{
+    while (true)
+    {
+        uint64 key = 0;
+        _queue.WaitAndPop(key);
+
+        if (_cancelationToken)
+            return;
+
+        std::unique_ptr<PreloadedGrid> grid(new PreloadedGrid(uint32(key >> 16), uint32(key >> 8) & 0xFF, uint32(key) & 0xFF));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Load(*grid);
+        grid->LoadTime = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+        std::lock_guard<std::mutex> lock(_lock);
+        // the map may have loaded the grid in the meantime
+        auto itr = _entries.find(key);
+        if (itr != _entries.end() && !itr->second.Grid)
+        {
+            itr->second.Grid = std::move(grid);
+            itr->second.ReadyTime = _time;
+        }
+    }
+}
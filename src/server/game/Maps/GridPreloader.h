@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_GRIDPRELOADER_H
+#define TRINITY_GRIDPRELOADER_H
+
+#include "Define.h"
+#include "ProducerConsumerQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class GridMap;
+
+/// Terrain, vmap and mmap data of one grid, read ahead of time by the GridPreloader.
+/// Whatever was not taken over by the map is released on destruction.
+struct TC_GAME_API PreloadedGrid
+{
+    PreloadedGrid(uint32 mapId, uint32 gx, uint32 gy);
+    ~PreloadedGrid();
+
+    uint32 MapId;
+    uint32 GridX;                           // GridMaps coordinates, as used by Map::LoadMapAndVMap
+    uint32 GridY;
+    std::unique_ptr<GridMap> Terrain;
+    std::vector<std::string> VMapModels;    // model references held until the vmap tile is loaded
+    unsigned char* MMapTile;                // dtAlloc'ed .mmtile data
+    uint32 MMapTileSize;
+    uint32 LoadTime;                        // microseconds spent loading in the background
+
+    PreloadedGrid(PreloadedGrid const&) = delete;
+    PreloadedGrid& operator=(PreloadedGrid const&) = delete;
+};
+
+/**
+ * Loads the file backed data of grids on background threads before players reach them.
+ *
+ * Maps request the grids lying ahead of moving players; the workers read the terrain tile,
+ * parse the vmap models spawned in it and read the mmap tile. When the map creates the grid
+ * it takes the preloaded data over and only has to link it into its trees and spawn objects.
+ * Data that was not picked up in time is dropped again.
+ */
+class TC_GAME_API GridPreloader
+{
+    private:
+        GridPreloader();
+        ~GridPreloader() { }
+
+    public:
+        static GridPreloader* instance();
+
+        void Initialize(uint32 threads);
+        void Deactivate();
+        bool IsEnabled() const { return !_workerThreads.empty(); }
+
+        /// Queues background loading of a grid of a base map, ignored if already requested
+        void Request(uint32 mapId, uint32 gx, uint32 gy);
+        /// Returns the preloaded data of the grid if it is ready, drops pending requests for it
+        std::unique_ptr<PreloadedGrid> Take(uint32 mapId, uint32 gx, uint32 gy);
+
+        /// A grid was loaded from preloaded data
+        void RecordHit(uint32 loadTime);
+        /// A grid had to be loaded on the map thread
+        void RecordMiss(uint32 loadTime);
+
+        /// Drops preloaded grids nobody asked for in time
+        void Update(uint32 diff);
+        /// Writes hit and miss counters to the log and resets them
+        void LogStats();
+
+    private:
+        struct Entry
+        {
+            Entry() : ReadyTime(0) { }
+
+            std::unique_ptr<PreloadedGrid> Grid;    // null while queued or loading
+            uint32 ReadyTime;
+        };
+
+        static uint64 MakeKey(uint32 mapId, uint32 gx, uint32 gy) { return (uint64(mapId) << 16) | (gx << 8) | gy; }
+
+        void Load(PreloadedGrid& grid) const;
+        void WorkerThread();
+
+        std::vector<std::thread> _workerThreads;
+        ProducerConsumerQueue<uint64> _queue;
+        std::atomic<bool> _cancelationToken;
+
+        std::mutex _lock;
+        std::unordered_map<uint64, Entry> _entries;
+        uint32 _time;
+
+        std::atomic<uint32> _hits;
+        std::atomic<uint32> _misses;
+        std::atomic<uint32> _dropped;
+        std::atomic<uint64> _stallAvoided;          // microseconds of background loading consumed by the maps
+        std::atomic<uint64> _stallTime;             // microseconds spent loading grids on the map threads
+};
+
+#define sGridPreloader GridPreloader::instance()
+
+#endif
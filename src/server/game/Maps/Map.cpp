@@ -25,6 +25,7 @@
 #include "GridNotifiers.h"
 #include "GridNotifiersImpl.h"
 #include "GridStates.h"
+#include "GridPreloader.h"
 #include "Group.h"
 #include "InstanceScript.h"
 #include "MapInstanced.h"
@@ -35,6 +36,10 @@
 #include "Transport.h"
 #include "Vehicle.h"
 #include "VMapFactory.h"
+#include "WaypointMovementGenerator.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 u_map_magic MapMagic        = { {'M','A','P','S'} };
 u_map_magic MapVersionMagic = { {'v','1','.','8'} };
@@ -44,6 +49,8 @@ u_map_magic MapLiquidMagic  = { {'M','L','I','Q'} };
 
 #define DEFAULT_GRID_EXPIRY     300
 #define MAX_GRID_LOAD_TIME      50
+#define GRID_PRELOAD_INTERVAL   1000
+#define TAXI_PRELOAD_SPEED      32.0f
 #define MAX_CREATURE_ATTACK_RADIUS  (45.0f * sWorld->getRate(RATE_CREATURE_AGGRO))
 
 GridState* si_GridStates[MAX_GRID_STATE];
@@ -65,8 +72,6 @@ Map::~Map()
 
     if (!m_scriptSchedule.empty())
         sMapMgr->DecreaseScheduledScriptCount(m_scriptSchedule.size());
-
-    MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(GetId(), i_InstanceId);
 }
 
 bool Map::ExistMap(uint32 mapid, int gx, int gy)
@@ -121,12 +126,20 @@ bool Map::ExistVMap(uint32 mapid, int gx, int gy)
     return true;
 }
 
-void Map::LoadMMap(int gx, int gy)
+void Map::LoadMMap(int gx, int gy, PreloadedGrid* preloaded)
 {
     if (!DisableMgr::IsPathfindingEnabled(GetId()))
         return;
 
-    bool mmapLoadResult = MMAP::MMapFactory::createOrGetMMapManager()->loadMap((sWorld->GetDataPath() + "mmaps").c_str(), GetId(), gx, gy);
+    bool mmapLoadResult;
+    if (preloaded && preloaded->MMapTile)
+    {
+        // the navmesh takes ownership of the tile data
+        mmapLoadResult = MMAP::MMapFactory::createOrGetMMapManager()->loadMap(GetId(), gx, gy, preloaded->MMapTile, preloaded->MMapTileSize);
+        preloaded->MMapTile = nullptr;
+    }
+    else
+        mmapLoadResult = MMAP::MMapFactory::createOrGetMMapManager()->loadMap((sWorld->GetDataPath() + "mmaps").c_str(), GetId(), gx, gy);
 
     if (mmapLoadResult)
         TC_LOG_DEBUG("mmaps", "MMAP loaded name:%s, id:%d, x:%d, y:%d (mmap rep.: x:%d, y:%d)", GetMapName(), GetId(), gx, gy, gx, gy);
@@ -200,13 +213,94 @@ void Map::LoadMap(int gx, int gy, bool reload)
 
 void Map::LoadMapAndVMap(int gx, int gy)
 {
-    LoadMap(gx, gy);
-   // Only load the data for the base map
-    if (i_InstanceId == 0)
+    // Only load the data for the base map
+    if (i_InstanceId != 0)
+    {
+        LoadMap(gx, gy);
+        return;
+    }
+
+    if (std::unique_ptr<PreloadedGrid> preloaded = sGridPreloader->Take(GetId(), gx, gy))
     {
+        if (preloaded->Terrain && !GridMaps[gx][gy])
+        {
+            GridMaps[gx][gy] = preloaded->Terrain.release();
+            sScriptMgr->OnLoadGridMap(this, GridMaps[gx][gy], gx, gy);
+        }
+        else
+            LoadMap(gx, gy);
+
+        // models were already read by the preloader, the tile only references them
         LoadVMap(gx, gy);
-        LoadMMap(gx, gy);
+        LoadMMap(gx, gy, preloaded.get());
+        sGridPreloader->RecordHit(preloaded->LoadTime);
+        return;
     }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    LoadMap(gx, gy);
+    LoadVMap(gx, gy);
+    LoadMMap(gx, gy);
+
+    if (sGridPreloader->IsEnabled())
+        sGridPreloader->RecordMiss(uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+}
+
+void Map::PreloadGridsAhead(Player* player)
+{
+    float lookAhead = float(sWorld->getIntConfig(CONFIG_GRID_PRELOAD_LOOKAHEAD));
+
+    // taxi paths are known in advance, follow the nodes still ahead of the player
+    if (player->GetMotionMaster()->GetCurrentMovementGeneratorType() == FLIGHT_MOTION_TYPE)
+    {
+        FlightPathMovementGenerator* flight = static_cast<FlightPathMovementGenerator*>(player->GetMotionMaster()->top());
+        TaxiPathNodeList const& path = flight->GetPath();
+
+        float maxDistance = TAXI_PRELOAD_SPEED * lookAhead + GetVisibilityRange();
+        float distance = 0.0f;
+        float x = player->GetPositionX();
+        float y = player->GetPositionY();
+        for (uint32 i = flight->GetCurrentNode(); i < path.size() && path[i]->MapID == GetId() && distance < maxDistance; ++i)
+        {
+            distance += std::sqrt((path[i]->LocX - x) * (path[i]->LocX - x) + (path[i]->LocY - y) * (path[i]->LocY - y));
+            x = path[i]->LocX;
+            y = path[i]->LocY;
+            RequestGridPreload(x, y);
+        }
+        return;
+    }
+
+    if (!player->isMoving())
+        return;
+
+    UnitMoveType moveType = MOVE_RUN;
+    if (player->IsFlying())
+        moveType = MOVE_FLIGHT;
+    else if (player->IsInWater())
+        moveType = MOVE_SWIM;
+
+    float angle = player->GetOrientation();
+    if (player->HasUnitMovementFlag(MOVEMENTFLAG_BACKWARD))
+        angle += float(M_PI);
+
+    float maxDistance = player->GetSpeed(moveType) * lookAhead + GetVisibilityRange();
+    for (float distance = SIZE_OF_GRIDS / 2; distance <= maxDistance; distance += SIZE_OF_GRIDS / 2)
+        RequestGridPreload(player->GetPositionX() + distance * std::cos(angle), player->GetPositionY() + distance * std::sin(angle));
+}
+
+void Map::RequestGridPreload(float x, float y)
+{
+    if (!Trinity::IsValidMapCoord(x, y))
+        return;
+
+    GridCoord p = Trinity::ComputeGridCoord(x, y);
+    int gx = (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord;
+    int gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
+
+    // terrain is loaded by the base map, instances share it
+    if (!m_parentMap->GridMaps[gx][gy])
+        sGridPreloader->Request(GetId(), gx, gy);
 }
 
 void Map::LoadAllCells()
@@ -238,10 +332,11 @@ i_mapEntry(sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode), i_InstanceId(Inst
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
 m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
 m_activeNonPlayersIter(m_activeNonPlayers.end()), _transportsUpdateIter(_transports.end()),
-i_gridExpiry(expiry),
-i_scriptLock(false), _defaultLight(GetDefaultMapLight(id))
+i_gridExpiry(expiry), _markedCellsBegin(TOTAL_NUMBER_OF_CELLS_PER_MAP * TOTAL_NUMBER_OF_CELLS_PER_MAP / 64), _markedCellsEnd(0),
+i_scriptLock(false), _defaultLight(GetDefaultMapLight(id)), _updateCostEstimate(0), _gridPreloadTimer(0), _terrainGeneration(0), _objectUpdateStats()
 {
     m_parentMap = (_parent ? _parent : this);
+    _markedCells.fill(0);
     for (unsigned int idx=0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
     {
         for (unsigned int j=0; j < MAX_NUMBER_OF_GRIDS; ++j)
@@ -465,7 +560,10 @@ void Map::EnsureGridCreated_i(const GridCoord &p)
         int gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
 
         if (!GridMaps[gx][gy])
+        {
             LoadMapAndVMap(gx, gy);
+            ++_terrainGeneration;
+        }
     }
 }
 
@@ -646,38 +744,10 @@ bool Map::IsGridLoaded(const GridCoord &p) const
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
-void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
-{
-    // Check for valid position
-    if (!obj->IsPositionValid())
-        return;
-
-    // Update mobs/objects in ALL visible cells around object!
-    CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), obj->GetGridActivationRange());
-
-    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
-    {
-        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
-        {
-            // marked cells are those that have been visited
-            // don't visit the same cell twice
-            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (isCellMarked(cell_id))
-                continue;
-
-            markCell(cell_id);
-            CellCoord pair(x, y);
-            Cell cell(pair);
-            cell.SetNoCreate();
-            Visit(cell, gridVisitor);
-            Visit(cell, worldVisitor);
-        }
-    }
-}
-
 void Map::Update(const uint32 t_diff)
 {
     _dynamicTree.update(t_diff);
+    _pathRequestQueue.ApplyResults(this);
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -691,13 +761,57 @@ void Map::Update(const uint32 t_diff)
         }
     }
     /// update active cells around players and active objects
-    resetMarkedCells();
+    UpdateActiveCells(t_diff);
 
-    Trinity::ObjectUpdater updater(t_diff);
-    // for creature
-    TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
-    // for pets
-    TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+    for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
+    {
+        WorldObject* obj = *_transportsUpdateIter;
+        ++_transportsUpdateIter;
+
+        if (!obj->IsInWorld())
+            continue;
+
+        obj->Update(t_diff);
+    }
+
+    SendObjectUpdates();
+
+    ///- Process necessary scripts
+    if (!m_scriptSchedule.empty())
+    {
+        i_scriptLock = true;
+        ScriptsProcess();
+        i_scriptLock = false;
+    }
+
+    MoveAllCreaturesInMoveList();
+    MoveAllGameObjectsInMoveList();
+
+    if (!m_mapRefManager.isEmpty() || !m_activeNonPlayers.empty())
+        ProcessRelocationNotifies(t_diff);
+
+    if (sGridPreloader->IsEnabled() && !m_mapRefManager.isEmpty())
+    {
+        if (_gridPreloadTimer <= t_diff)
+        {
+            _gridPreloadTimer = GRID_PRELOAD_INTERVAL;
+            for (MapRefManager::iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+                if (Player* player = itr->GetSource())
+                    if (player->IsInWorld())
+                        PreloadGridsAhead(player);
+        }
+        else
+            _gridPreloadTimer -= t_diff;
+    }
+
+    _pathRequestQueue.Process(this);
+
+    sScriptMgr->OnMapUpdate(this, t_diff);
+}
+
+void Map::UpdateActiveCells(uint32 t_diff)
+{
+    resetMarkedCells();
 
     // the player iterator is stored in the map object
     // to make sure calls to Map::Remove don't invalidate it
@@ -711,69 +825,80 @@ void Map::Update(const uint32 t_diff)
         // update players at tick
         player->Update(t_diff);
 
-        VisitNearbyCellsOf(player, grid_object_update, world_object_update);
+        MarkCellsAround(player);
 
         // Handle updates for creatures in combat with player and are more than 60 yards away
         if (player->IsInCombat())
         {
-            std::vector<Creature*> updateList;
-            HostileReference* ref = player->getHostileRefManager().getFirst();
-
-            while (ref)
-            {
+            for (HostileReference* ref = player->getHostileRefManager().getFirst(); ref; ref = ref->next())
                 if (Unit* unit = ref->GetSource()->GetOwner())
                     if (unit->ToCreature() && unit->GetMapId() == player->GetMapId() && !unit->IsWithinDistInMap(player, GetVisibilityRange(), false))
-                        updateList.push_back(unit->ToCreature());
-
-                ref = ref->next();
-            }
-
-            // Process deferred update list for player
-            for (Creature* c : updateList)
-                VisitNearbyCellsOf(c, grid_object_update, world_object_update);
+                        MarkCellsAround(unit);
         }
     }
 
-    // non-player active objects, increasing iterator in the loop in case of object removal
-    for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
-    {
-        WorldObject* obj = *m_activeNonPlayersIter;
-        ++m_activeNonPlayersIter;
-
-        if (!obj || !obj->IsInWorld())
-            continue;
+    // non-player active objects, only their cells are collected here so the set can't change while iterating
+    for (WorldObject* obj : m_activeNonPlayers)
+        if (obj && obj->IsInWorld())
+            MarkCellsAround(obj);
 
-        VisitNearbyCellsOf(obj, grid_object_update, world_object_update);
-    }
+    Trinity::ObjectUpdater updater(t_diff);
+    // for creature
+    TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    // for pets
+    TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
 
-    for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
-    {
-        WorldObject* obj = *_transportsUpdateIter;
-        ++_transportsUpdateIter;
+    // every active cell is updated exactly once, no matter how many players or active objects share it
+    VisitMarkedCells(grid_object_update, world_object_update);
+}
 
-        if (!obj->IsInWorld())
-            continue;
+void Map::MarkCellsAround(WorldObject const* obj)
+{
+    // Check for valid position
+    if (!obj->IsPositionValid())
+        return;
 
-        obj->Update(t_diff);
-    }
+    // Update mobs/objects in ALL visible cells around object!
+    CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), obj->GetGridActivationRange());
 
-    SendObjectUpdates();
+    for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+            markCell((y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x);
+}
 
-    ///- Process necessary scripts
-    if (!m_scriptSchedule.empty())
+static uint32 LowestSetBit(uint64 bits)
+{
+    uint32 index = 0;
+    while (!(bits & 0xFF))
     {
-        i_scriptLock = true;
-        ScriptsProcess();
-        i_scriptLock = false;
+        bits >>= 8;
+        index += 8;
     }
 
-    MoveAllCreaturesInMoveList();
-    MoveAllGameObjectsInMoveList();
+    while (!(bits & 1))
+    {
+        bits >>= 1;
+        ++index;
+    }
 
-    if (!m_mapRefManager.isEmpty() || !m_activeNonPlayers.empty())
-        ProcessRelocationNotifies(t_diff);
+    return index;
+}
 
-    sScriptMgr->OnMapUpdate(this, t_diff);
+void Map::VisitMarkedCells(TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer>& gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer>& worldVisitor)
+{
+    // sweep the marked words in memory order, skipping empty ones
+    for (uint32 word = _markedCellsBegin; word < _markedCellsEnd; ++word)
+    {
+        for (uint64 bits = _markedCells[word]; bits; bits &= bits - 1)
+        {
+            uint32 cellId = word * 64 + LowestSetBit(bits);
+            CellCoord pair(cellId % TOTAL_NUMBER_OF_CELLS_PER_MAP, cellId / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+            Cell cell(pair);
+            cell.SetNoCreate();
+            Visit(cell, gridVisitor);
+            Visit(cell, worldVisitor);
+        }
+    }
 }
 
 struct ResetNotifier
@@ -1585,6 +1710,7 @@ bool Map::UnloadGrid(NGridType& ngrid, bool unloadAll)
             ((MapInstanced*)m_parentMap)->RemoveGridMapReference(GridCoord(gx, gy));
 
         GridMaps[gx][gy] = NULL;
+        ++_terrainGeneration;
     }
     TC_LOG_DEBUG("maps", "Unloading grid[%u, %u] for map %u finished", x, y, GetId());
     return true;
@@ -1682,61 +1808,65 @@ bool GridMap::loadData(const char* filename)
     // Unload old data if exist
     unloadData();
 
-    map_fileheader header;
-    // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
-        return true;
+    try
+    {
+        boost::interprocess::file_mapping file(filename, boost::interprocess::read_only);
+        _mappedFile = Trinity::make_unique<boost::interprocess::mapped_region>(file, boost::interprocess::read_only);
+    }
+    catch (boost::interprocess::interprocess_exception const& e)
+    {
+        // Not return error if file not found
+        if (e.get_error_code() == boost::interprocess::not_found_error)
+            return true;
+
+        TC_LOG_ERROR("maps", "Map file '%s' could not be mapped: %s", filename, e.what());
+        return false;
+    }
 
-    if (fread(&header, sizeof(header), 1, in) != 1)
+    map_fileheader header;
+    uint32 offset = 0;
+    if (!readData(&header, offset, sizeof(header)))
     {
-        fclose(in);
+        unloadData();
         return false;
     }
 
     if (header.mapMagic.asUInt == MapMagic.asUInt && header.versionMagic.asUInt == MapVersionMagic.asUInt)
     {
         // load up area data
-        if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
+        if (header.areaMapOffset && !loadAreaData(header.areaMapOffset, header.areaMapSize))
         {
             TC_LOG_ERROR("maps", "Error loading map area data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
         // load up height data
-        if (header.heightMapOffset && !loadHeightData(in, header.heightMapOffset, header.heightMapSize))
+        if (header.heightMapOffset && !loadHeightData(header.heightMapOffset, header.heightMapSize))
         {
             TC_LOG_ERROR("maps", "Error loading map height data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
         // load up liquid data
-        if (header.liquidMapOffset && !loadLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
+        if (header.liquidMapOffset && !loadLiquidData(header.liquidMapOffset, header.liquidMapSize))
         {
             TC_LOG_ERROR("maps", "Error loading map liquids data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
-        fclose(in);
         return true;
     }
 
     TC_LOG_ERROR("maps", "Map file '%s' is from an incompatible map version (%.*s %.*s), %.*s %.*s is expected. Please recreate using the mapextractor.",
         filename, 4, header.mapMagic.asChar, 4, header.versionMagic.asChar, 4, MapMagic.asChar, 4, MapVersionMagic.asChar);
-    fclose(in);
+    unloadData();
     return false;
 }
 
 void GridMap::unloadData()
 {
-    delete[] _areaMap;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] _maxHeight;
-    delete[] _minHeight;
-    delete[] _liquidEntry;
-    delete[] _liquidFlags;
-    delete[] _liquidMap;
+    _mappedFile.reset();
+    _unalignedData.clear();
     _areaMap = nullptr;
     m_V9 = nullptr;
     m_V8 = nullptr;
@@ -1748,30 +1878,70 @@ void GridMap::unloadData()
     _gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+void GridMap::prefetchData() const
 {
-    map_areaHeader header;
-    fseek(in, offset, SEEK_SET);
+    if (!_mappedFile)
+        return;
+
+    uint8 const* data = static_cast<uint8 const*>(_mappedFile->get_address());
+    std::size_t size = _mappedFile->get_size();
+    std::size_t pageSize = boost::interprocess::mapped_region::get_page_size();
+    uint8 volatile sink = 0;
+    for (std::size_t offset = 0; offset < size; offset += pageSize)
+        sink = data[offset];
+    (void)sink;
+}
 
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapAreaMagic.asUInt)
+bool GridMap::readData(void* data, uint32& offset, uint32 size) const
+{
+    if (uint64(offset) + size > _mappedFile->get_size())
+        return false;
+
+    memcpy(data, static_cast<uint8 const*>(_mappedFile->get_address()) + offset, size);
+    offset += size;
+    return true;
+}
+
+template<class T>
+bool GridMap::mapArray(T const*& data, uint32& offset, uint32 count)
+{
+    uint32 size = uint32(sizeof(T)) * count;
+    if (uint64(offset) + size > _mappedFile->get_size())
+        return false;
+
+    uint8 const* source = static_cast<uint8 const*>(_mappedFile->get_address()) + offset;
+    offset += size;
+
+    // sections following uint8 height data start at odd offsets
+    if (reinterpret_cast<uintptr_t>(source) % alignof(T))
+    {
+        _unalignedData.emplace_back(new uint8[size]);
+        memcpy(_unalignedData.back().get(), source, size);
+        source = _unalignedData.back().get();
+    }
+
+    data = reinterpret_cast<T const*>(source);
+    return true;
+}
+
+bool GridMap::loadAreaData(uint32 offset, uint32 /*size*/)
+{
+    map_areaHeader header;
+    if (!readData(&header, offset, sizeof(header)) || header.fourcc != MapAreaMagic.asUInt)
         return false;
 
     _gridArea = header.gridArea;
     if (!(header.flags & MAP_AREA_NO_AREA))
-    {
-        _areaMap = new uint16[16 * 16];
-        if (fread(_areaMap, sizeof(uint16), 16*16, in) != 16*16)
+        if (!mapArray(_areaMap, offset, 16 * 16))
             return false;
-    }
+
     return true;
 }
 
-bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeightData(uint32 offset, uint32 /*size*/)
 {
     map_heightHeader header;
-    fseek(in, offset, SEEK_SET);
-
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapHeightMagic.asUInt)
+    if (!readData(&header, offset, sizeof(header)) || header.fourcc != MapHeightMagic.asUInt)
         return false;
 
     _gridHeight = header.gridHeight;
@@ -1779,30 +1949,24 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129*129];
-            m_uint16_V8 = new uint16 [128*128];
-            if (fread(m_uint16_V9, sizeof(uint16), 129*129, in) != 129*129 ||
-                fread(m_uint16_V8, sizeof(uint16), 128*128, in) != 128*128)
+            if (!mapArray(m_uint16_V9, offset, 129*129) ||
+                !mapArray(m_uint16_V8, offset, 128*128))
                 return false;
             _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
             _gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129*129];
-            m_uint8_V8 = new uint8 [128*128];
-            if (fread(m_uint8_V9, sizeof(uint8), 129*129, in) != 129*129 ||
-                fread(m_uint8_V8, sizeof(uint8), 128*128, in) != 128*128)
+            if (!mapArray(m_uint8_V9, offset, 129*129) ||
+                !mapArray(m_uint8_V8, offset, 128*128))
                 return false;
             _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
             _gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129*129];
-            m_V8 = new float [128*128];
-            if (fread(m_V9, sizeof(float), 129*129, in) != 129*129 ||
-                fread(m_V8, sizeof(float), 128*128, in) != 128*128)
+            if (!mapArray(m_V9, offset, 129*129) ||
+                !mapArray(m_V8, offset, 128*128))
                 return false;
             _gridGetHeight = &GridMap::getHeightFromFloat;
         }
@@ -1812,22 +1976,18 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
 
     if (header.flags & MAP_HEIGHT_HAS_FLIGHT_BOUNDS)
     {
-        _maxHeight = new int16[3 * 3];
-        _minHeight = new int16[3 * 3];
-        if (fread(_maxHeight, sizeof(int16), 3 * 3, in) != 3 * 3 ||
-            fread(_minHeight, sizeof(int16), 3 * 3, in) != 3 * 3)
+        if (!mapArray(_maxHeight, offset, 3 * 3) ||
+            !mapArray(_minHeight, offset, 3 * 3))
             return false;
     }
 
     return true;
 }
 
-bool GridMap::loadLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadLiquidData(uint32 offset, uint32 /*size*/)
 {
     map_liquidHeader header;
-    fseek(in, offset, SEEK_SET);
-
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapLiquidMagic.asUInt)
+    if (!readData(&header, offset, sizeof(header)) || header.fourcc != MapLiquidMagic.asUInt)
         return false;
 
     _liquidType   = header.liquidType;
@@ -1839,18 +1999,15 @@ bool GridMap::loadLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
 
     if (!(header.flags & MAP_LIQUID_NO_TYPE))
     {
-        _liquidEntry = new uint16[16*16];
-        if (fread(_liquidEntry, sizeof(uint16), 16*16, in) != 16*16)
+        if (!mapArray(_liquidEntry, offset, 16*16))
             return false;
 
-        _liquidFlags = new uint8[16*16];
-        if (fread(_liquidFlags, sizeof(uint8), 16*16, in) != 16*16)
+        if (!mapArray(_liquidFlags, offset, 16*16))
             return false;
     }
     if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
     {
-        _liquidMap = new float[uint32(_liquidWidth) * uint32(_liquidHeight)];
-        if (fread(_liquidMap, sizeof(float), _liquidWidth*_liquidHeight, in) != (uint32(_liquidWidth) * uint32(_liquidHeight)))
+        if (!mapArray(_liquidMap, offset, uint32(_liquidWidth) * uint32(_liquidHeight)))
             return false;
     }
     return true;
@@ -1971,7 +2128,7 @@ float GridMap::getHeightFromUint8(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint8 *V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
+    uint8 const* V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
     if (x+y < 1)
     {
         if (x > y)
@@ -2038,7 +2195,7 @@ float GridMap::getHeightFromUint16(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint16 *V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
+    uint16 const* V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
     if (x+y < 1)
     {
         if (x > y)
@@ -2307,7 +2464,39 @@ float Map::GetWaterOrGroundLevel(float x, float y, float z, float* ground /*= NU
     return VMAP_INVALID_HEIGHT_VALUE;
 }
 
+MapQueryCache* Map::GetQueryCache() const
+{
+    uint32 maxEntries = sWorld->getIntConfig(CONFIG_MAP_QUERY_CACHE_ENTRIES);
+    uint32 slot = MapQueryCache::GetThreadSlot();
+    if (!maxEntries || slot >= MAX_MAP_QUERY_CACHE_THREADS)
+        return nullptr;
+
+    std::unique_ptr<MapQueryCache>& cache = _queryCaches[slot];
+    if (!cache)
+        cache.reset(new MapQueryCache(maxEntries));
+
+    // instances take vmaps from the parent map and terrain from their own grids
+    cache->Validate(uint64(m_parentMap->_terrainGeneration) << 32 | _terrainGeneration);
+    return cache.get();
+}
+
 float Map::GetHeight(float x, float y, float z, bool checkVMap /*= true*/, float maxSearchDist /*= DEFAULT_HEIGHT_SEARCH*/) const
+{
+    MapQueryCache* cache = GetQueryCache();
+    if (!cache)
+        return GetStaticHeight(x, y, z, checkVMap, maxSearchDist);
+
+    MapQueryCache::Key key = MapQueryCache::MakeKey(MapQueryCache::QUERY_HEIGHT, x, y, z, 0.0f, 0.0f, 0.0f, uint32(maxSearchDist * 4.0f) << 1 | uint32(checkVMap));
+    if (MapQueryCache::Result const* cached = cache->Find(key))
+        return cached->Height;
+
+    MapQueryCache::Result result = { };
+    result.Height = GetStaticHeight(x, y, z, checkVMap, maxSearchDist);
+    cache->Store(key, result);
+    return result.Height;
+}
+
+float Map::GetStaticHeight(float x, float y, float z, bool checkVMap, float maxSearchDist) const
 {
     // find raw .map surface under Z coordinates
     float mapHeight = VMAP_INVALID_HEIGHT_VALUE;
@@ -2401,6 +2590,32 @@ bool Map::IsOutdoors(float x, float y, float z) const
 }
 
 bool Map::GetAreaInfo(float x, float y, float z, uint32 &flags, int32 &adtId, int32 &rootId, int32 &groupId) const
+{
+    MapQueryCache* cache = GetQueryCache();
+    if (!cache)
+        return GetStaticAreaInfo(x, y, z, flags, adtId, rootId, groupId);
+
+    MapQueryCache::Key key = MapQueryCache::MakeKey(MapQueryCache::QUERY_AREA_INFO, x, y, z);
+    MapQueryCache::Result result = { };
+    if (MapQueryCache::Result const* cached = cache->Find(key))
+        result = *cached;
+    else
+    {
+        result.Value = GetStaticAreaInfo(x, y, z, result.Flags, result.AdtId, result.RootId, result.GroupId);
+        cache->Store(key, result);
+    }
+
+    if (!result.Value)
+        return false;
+
+    flags = result.Flags;
+    adtId = result.AdtId;
+    rootId = result.RootId;
+    groupId = result.GroupId;
+    return true;
+}
+
+bool Map::GetStaticAreaInfo(float x, float y, float z, uint32 &flags, int32 &adtId, int32 &rootId, int32 &groupId) const
 {
     float vmap_z = z;
     VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
@@ -2585,8 +2800,33 @@ float Map::GetWaterLevel(float x, float y) const
 
 bool Map::isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2)
-        && _dynamicTree.isInLineOfSight(x1, y1, z1, x2, y2, z2, phasemask);
+    bool staticLOS;
+    if (MapQueryCache* cache = GetQueryCache())
+    {
+        MapQueryCache::Key key = MapQueryCache::MakeKey(MapQueryCache::QUERY_LINE_OF_SIGHT, x1, y1, z1, x2, y2, z2);
+        if (MapQueryCache::Result const* cached = cache->Find(key))
+            staticLOS = cached->Value;
+        else
+        {
+            MapQueryCache::Result result = { };
+            result.Value = staticLOS = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2);
+            cache->Store(key, result);
+        }
+    }
+    else
+        staticLOS = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2);
+
+    // gameobjects (doors, destructibles) change state and phase, their models are always checked
+    return staticLOS && _dynamicTree.isInLineOfSight(x1, y1, z1, x2, y2, z2, phasemask);
+}
+
+uint64 Map::isInLineOfSight(float x, float y, float z, G3D::Vector3 const* targets, uint32 count, uint32 phasemask) const
+{
+    uint64 visible = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x, y, z, targets, count);
+    if (!visible)
+        return 0;
+
+    return _dynamicTree.isInLineOfSight(G3D::Vector3(x, y, z), targets, count, phasemask, visible);
 }
 
 bool Map::getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float& ry, float& rz, float modifyDist)
@@ -2739,13 +2979,64 @@ void Map::SendObjectUpdates()
         obj->BuildUpdate(update_players);
     }
 
-    WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
+    _objectUpdateStats = ObjectUpdateStats();
+    _objectUpdateStats.Receivers = update_players.size();
+
+    std::vector<std::pair<Player*, UpdateData*>> receivers;
+    receivers.reserve(update_players.size());
+
+    std::unordered_set<ByteBuffer const*> sharedBlocks;
     for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
     {
-        iter->second.BuildPacket(&packet);
-        iter->first->GetSession()->SendPacket(&packet);
-        packet.clear();                                     // clean the string
+        _objectUpdateStats.BytesSerialized += iter->second.GetOwnBlockSize();
+        for (auto const& shared : iter->second.GetSharedBlocks())
+            if (sharedBlocks.insert(shared.second.get()).second)
+                _objectUpdateStats.BytesSerialized += shared.second->wpos();
+
+        _objectUpdateStats.BytesAssembled += iter->second.GetBlockSize();
+        receivers.emplace_back(iter->first, &iter->second);
     }
+
+    // every receiver gets exactly one packet here, so packets may be built and queued
+    // from the map update threads without reordering anything sent to a session
+    MapUpdater* mapUpdater = sMapMgr->GetMapUpdater();
+    size_t jobCount = 1;
+    if (sWorld->getBoolConfig(CONFIG_COMPRESSION_PARALLEL) && receivers.size() > 1 && mapUpdater->activated())
+        jobCount = std::min(receivers.size(), mapUpdater->GetThreadCount() + 1);
+
+    std::vector<uint64> bytesSent(jobCount, 0);
+    auto sendPackets = [&receivers, &bytesSent, jobCount](size_t job)
+    {
+        for (size_t i = job; i < receivers.size(); i += jobCount)
+        {
+            WorldPacket packet;
+            receivers[i].second->BuildPacket(&packet);
+            bytesSent[job] += packet.size();
+            // the socket takes over the packet storage, it is not copied again
+            receivers[i].first->GetSession()->SendPacket(std::move(packet));
+        }
+    };
+
+    uint32 startTime = getMSTime();
+    if (jobCount > 1)
+    {
+        std::vector<std::function<void()>> jobs;
+        jobs.reserve(jobCount);
+        for (size_t job = 0; job < jobCount; ++job)
+            jobs.push_back([&sendPackets, job]() { sendPackets(job); });
+
+        mapUpdater->run_jobs(jobs);
+    }
+    else
+        sendPackets(0);
+
+    _objectUpdateStats.PacketTime = GetMSTimeDiffToNow(startTime);
+    for (uint64 bytes : bytesSent)
+        _objectUpdateStats.BytesSent += bytes;
+
+    if (_objectUpdateStats.Receivers)
+        TC_LOG_TRACE("maps", "Map %u sent object updates to %u players in %u ms, " UI64FMTD " bytes serialized, " UI64FMTD " bytes assembled, " UI64FMTD " bytes sent",
+            GetId(), _objectUpdateStats.Receivers, _objectUpdateStats.PacketTime, _objectUpdateStats.BytesSerialized, _objectUpdateStats.BytesAssembled, _objectUpdateStats.BytesSent);
 }
 
 void Map::DelayedUpdate(const uint32 t_diff)
@@ -30,11 +30,18 @@
 #include "MapRefManager.h"
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
+#include "MapQueryCache.h"
 #include "ObjectGuid.h"
+#include "PathRequestQueue.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <bitset>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 class Unit;
 class WorldPacket;
@@ -54,7 +61,9 @@ class MapInstanced;
 class BattlegroundMap;
 class InstanceMap;
 class Transport;
+struct PreloadedGrid;
 namespace Trinity { struct ObjectUpdater; }
+namespace boost { namespace interprocess { class mapped_region; } }
 
 struct ScriptAction
 {
@@ -158,29 +167,29 @@ class TC_GAME_API GridMap
 {
     uint32  _flags;
     union{
-        float* m_V9;
-        uint16* m_uint16_V9;
-        uint8* m_uint8_V9;
+        float const* m_V9;
+        uint16 const* m_uint16_V9;
+        uint8 const* m_uint8_V9;
     };
     union{
-        float* m_V8;
-        uint16* m_uint16_V8;
-        uint8* m_uint8_V8;
+        float const* m_V8;
+        uint16 const* m_uint16_V8;
+        uint8 const* m_uint8_V8;
     };
-    int16* _maxHeight;
-    int16* _minHeight;
+    int16 const* _maxHeight;
+    int16 const* _minHeight;
     // Height level data
     float _gridHeight;
     float _gridIntHeightMultiplier;
 
     // Area data
-    uint16* _areaMap;
+    uint16 const* _areaMap;
 
     // Liquid data
     float _liquidLevel;
-    uint16* _liquidEntry;
-    uint8* _liquidFlags;
-    float* _liquidMap;
+    uint16 const* _liquidEntry;
+    uint8 const* _liquidFlags;
+    float const* _liquidMap;
     uint16 _gridArea;
     uint16 _liquidType;
     uint8 _liquidOffX;
@@ -188,10 +197,19 @@ class TC_GAME_API GridMap
     uint8 _liquidWidth;
     uint8 _liquidHeight;
 
+    // All data arrays point into the read only mapping of the .map file, its pages are
+    // loaded on first access and shared with every other process mapping the same file
+    std::unique_ptr<boost::interprocess::mapped_region> _mappedFile;
+    // copies of sections not aligned for direct access in the mapping
+    std::vector<std::unique_ptr<uint8[]>> _unalignedData;
 
-    bool loadAreaData(FILE* in, uint32 offset, uint32 size);
-    bool loadHeightData(FILE* in, uint32 offset, uint32 size);
-    bool loadLiquidData(FILE* in, uint32 offset, uint32 size);
+    bool readData(void* data, uint32& offset, uint32 size) const;
+    template<class T>
+    bool mapArray(T const*& data, uint32& offset, uint32 count);
+
+    bool loadAreaData(uint32 offset, uint32 size);
+    bool loadHeightData(uint32 offset, uint32 size);
+    bool loadLiquidData(uint32 offset, uint32 size);
 
     // Get height functions and pointers
     typedef float (GridMap::*GetHeightPtr) (float x, float y) const;
@@ -206,6 +224,8 @@ public:
     ~GridMap();
     bool loadData(const char* filename);
     void unloadData();
+    // faults in all pages of the mapped file, for use on a background thread before the grid is needed
+    void prefetchData() const;
 
     uint16 getArea(float x, float y) const;
     inline float getHeight(float x, float y) const {return (this->*_gridGetHeight)(x, y);}
@@ -281,7 +301,6 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         template<class T> bool AddToMap(T *);
         template<class T> void RemoveFromMap(T *, bool);
 
-        void VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor);
         virtual void Update(const uint32);
 
         float GetVisibilityRange() const { return m_VisibleDistance; }
@@ -413,9 +432,24 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, CellCoord cellpair);
         void UpdateObjectsVisibilityFor(Player* player, Cell cell, CellCoord cellpair);
 
-        void resetMarkedCells() { marked_cells.reset(); }
-        bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        void resetMarkedCells()
+        {
+            if (_markedCellsBegin < _markedCellsEnd)
+                std::fill(_markedCells.begin() + _markedCellsBegin, _markedCells.begin() + _markedCellsEnd, 0);
+
+            _markedCellsBegin = uint32(_markedCells.size());
+            _markedCellsEnd = 0;
+        }
+
+        bool isCellMarked(uint32 pCellId) const { return (_markedCells[pCellId / 64] & (UI64LIT(1) << (pCellId % 64))) != 0; }
+
+        void markCell(uint32 pCellId)
+        {
+            uint32 word = pCellId / 64;
+            _markedCells[word] |= UI64LIT(1) << (pCellId % 64);
+            _markedCellsBegin = std::min(_markedCellsBegin, word);
+            _markedCellsEnd = std::max(_markedCellsEnd, word + 1);
+        }
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         uint32 GetPlayersCountExceptGMs() const;
@@ -497,12 +531,17 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         float GetWaterOrGroundLevel(float x, float y, float z, float* ground = NULL, bool swim = false) const;
         float GetHeight(uint32 phasemask, float x, float y, float z, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
         bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const;
+        // checks up to MAX_RAY_PACKET_SIZE rays from one position at once, bit i of the result is set if targets[i] is visible
+        uint64 isInLineOfSight(float x, float y, float z, G3D::Vector3 const* targets, uint32 count, uint32 phasemask) const;
         void Balance() { _dynamicTree.balance(); }
         void RemoveGameObjectModel(const GameObjectModel& model) { _dynamicTree.remove(model); }
         void InsertGameObjectModel(const GameObjectModel& model) { _dynamicTree.insert(model); }
         bool ContainsGameObjectModel(const GameObjectModel& model) const { return _dynamicTree.contains(model);}
         bool getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float modifyDist);
 
+        // paths calculated at the end of the update, in parallel with the other requests of this map
+        PathRequestQueue& GetPathRequestQueue() { return _pathRequestQueue; }
+
         /*
             RESPAWN TIMES
         */
@@ -575,14 +614,39 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
             _updateObjects.erase(obj);
         }
 
+        struct ObjectUpdateStats
+        {
+            uint32 Receivers;
+            uint64 BytesSerialized;     // update blocks built, shared blocks counted once
+            uint64 BytesAssembled;      // update blocks referenced by all receivers' packets
+            uint64 BytesSent;           // packet payload after compression
+            uint32 PacketTime;          // milliseconds spent building, compressing and queueing packets
+        };
+
+        // object updates sent during the last SendObjectUpdates
+        ObjectUpdateStats const& GetObjectUpdateStats() const { return _objectUpdateStats; }
+
+        // smoothed wall time (microseconds) of recent Update calls, used by MapUpdater to start the most expensive maps first
+        uint32 GetUpdateCostEstimate() const { return _updateCostEstimate; }
+        void RecordUpdateCost(uint32 cost) { _updateCostEstimate = uint32((uint64(_updateCostEstimate) * 3 + cost) / 4); }
+
     private:
 
         void LoadMapAndVMap(int gx, int gy);
         void LoadVMap(int gx, int gy);
         void LoadMap(int gx, int gy, bool reload = false);
-        void LoadMMap(int gx, int gy);
+        void LoadMMap(int gx, int gy, PreloadedGrid* preloaded = nullptr);
         GridMap* GetGrid(float x, float y);
 
+        // results of static geometry queries for the calling thread, null if caching is disabled
+        MapQueryCache* GetQueryCache() const;
+        float GetStaticHeight(float x, float y, float z, bool checkVMap, float maxSearchDist) const;
+        bool GetStaticAreaInfo(float x, float y, float z, uint32& mogpflags, int32& adtId, int32& rootId, int32& groupId) const;
+
+        // requests background loading of the grids the player is about to enter
+        void PreloadGridsAhead(Player* player);
+        void RequestGridPreload(float x, float y);
+
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
         void SendInitSelf(Player* player);
@@ -628,7 +692,9 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         void setNGrid(NGridType* grid, uint32 x, uint32 y);
         void ScriptsProcess();
 
-        void UpdateActiveCells(const float &x, const float &y, const uint32 t_diff);
+        void UpdateActiveCells(uint32 t_diff);
+        void MarkCellsAround(WorldObject const* obj);
+        void VisitMarkedCells(TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer>& gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer>& worldVisitor);
 
         void SendObjectUpdates();
 
@@ -677,7 +743,10 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
 
         NGridType* i_grids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         GridMap* GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
-        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        // one bit per cell, only words in [_markedCellsBegin, _markedCellsEnd) can have bits set
+        std::array<uint64, TOTAL_NUMBER_OF_CELLS_PER_MAP * TOTAL_NUMBER_OF_CELLS_PER_MAP / 64> _markedCells;
+        uint32 _markedCellsBegin;
+        uint32 _markedCellsEnd;
 
         //these functions used to process player/mob aggro reactions and
         //visibility calculations. Highly optimized for massive calculations
@@ -744,6 +813,17 @@ class TC_GAME_API Map : public GridRefManager<NGridType>
         std::unordered_set<Corpse*> _corpseBones;
 
         std::unordered_set<Object*> _updateObjects;
+
+        uint32 _updateCostEstimate;
+        uint32 _gridPreloadTimer;
+
+        // changed whenever grids are loaded or unloaded, invalidates the query caches
+        std::atomic<uint32> _terrainGeneration;
+        mutable std::array<std::unique_ptr<MapQueryCache>, MAX_MAP_QUERY_CACHE_THREADS> _queryCaches;
+
+        PathRequestQueue _pathRequestQueue;
+
+        ObjectUpdateStats _objectUpdateStats;
 };
 
 enum InstanceResetMethod
@@ -23,6 +23,7 @@
 #include "ObjectAccessor.h"
 #include "Transport.h"
 #include "GridDefines.h"
+#include "GridPreloader.h"
 #include "MapInstanced.h"
 #include "InstanceScript.h"
 #include "Config.h"
@@ -38,7 +39,7 @@
 #include "AchievementMgr.h"
 
 MapManager::MapManager()
-    : _nextInstanceId(0), _scheduledScripts(0)
+    : _nextInstanceId(0), _updaterStatsTicks(0), _updaterStatsTimer(0), _scheduledScripts(0)
 {
     i_gridCleanUpDelay = sWorld->getIntConfig(CONFIG_INTERVAL_GRIDCLEAN);
     i_timer.SetInterval(sWorld->getIntConfig(CONFIG_INTERVAL_MAPUPDATE));
@@ -54,6 +55,8 @@ void MapManager::Initialize()
     // Start mtmaps if needed.
     if (num_threads > 0)
         m_updater.activate(num_threads);
+
+    sGridPreloader->Initialize(sWorld->getIntConfig(CONFIG_GRID_PRELOAD_THREADS));
 }
 
 void MapManager::InitializeVisibilityDistanceInfo()
@@ -224,14 +227,47 @@ void MapManager::Update(uint32 diff)
             iter->second->Update(uint32(i_timer.GetCurrent()));
     }
     if (m_updater.activated())
+    {
         m_updater.wait();
+        RecordUpdaterStats(uint32(i_timer.GetCurrent()));
+    }
 
     for (iter = i_maps.begin(); iter != i_maps.end(); ++iter)
         iter->second->DelayedUpdate(uint32(i_timer.GetCurrent()));
 
+    sGridPreloader->Update(uint32(i_timer.GetCurrent()));
+
     i_timer.SetCurrent(0);
 }
 
+void MapManager::RecordUpdaterStats(uint32 diff)
+{
+    MapUpdater::TickStats const& tick = m_updater.GetLastTickStats();
+    _updaterStats.Requests += tick.Requests;
+    _updaterStats.Steals += tick.Steals;
+    _updaterStats.Makespan += tick.Makespan;
+    _updaterStats.TotalCost += tick.TotalCost;
+    ++_updaterStatsTicks;
+
+    uint32 interval = sWorld->getIntConfig(CONFIG_INTERVAL_LOG_UPDATE);
+    if (!interval)
+        return;
+
+    _updaterStatsTimer += diff;
+    if (_updaterStatsTimer < interval)
+        return;
+
+    // speedup close to the thread count means the pool is saturated, close to 1 means a single map dominates the tick
+    TC_LOG_DEBUG("maps", "MapUpdater: %u threads, %u ticks, avg %u maps per tick, avg makespan " UI64FMTD " us, avg summed map cost " UI64FMTD " us, speedup %.2f, %u steals",
+        uint32(m_updater.GetThreadCount()), _updaterStatsTicks, _updaterStats.Requests / _updaterStatsTicks,
+        _updaterStats.Makespan / _updaterStatsTicks, _updaterStats.TotalCost / _updaterStatsTicks,
+        _updaterStats.Makespan ? double(_updaterStats.TotalCost) / double(_updaterStats.Makespan) : 0.0, _updaterStats.Steals);
+
+    _updaterStats = MapUpdater::TickStats();
+    _updaterStatsTicks = 0;
+    _updaterStatsTimer = 0;
+}
+
 void MapManager::DoDelayedMovesAndRemoves() { }
 
 bool MapManager::ExistMapAndVMap(uint32 mapid, float x, float y)
@@ -258,6 +294,8 @@ bool MapManager::IsValidMAP(uint32 mapid, bool startUp)
 
 void MapManager::UnloadAll()
 {
+    sGridPreloader->Deactivate();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end();)
     {
         iter->second->UnloadAll();
@@ -156,6 +156,12 @@ class TC_GAME_API MapManager
         uint32 _nextInstanceId;
         MapUpdater m_updater;
 
+        void RecordUpdaterStats(uint32 diff);
+
+        MapUpdater::TickStats _updaterStats;
+        uint32 _updaterStatsTicks;
+        uint32 _updaterStatsTimer;
+
         // atomic op counter for active scripts amount
         std::atomic<uint32> _scheduledScripts;
 };
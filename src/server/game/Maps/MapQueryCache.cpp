@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapQueryCache.h"
+#include "Log.h"
+
+#include <boost/thread/tss.hpp>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// positions closer than 1/8 yard share their results
+#define MAP_QUERY_CACHE_RESOLUTION 8.0f
+
+std::atomic<uint32> MapQueryCache::_hits(0);
+std::atomic<uint32> MapQueryCache::_misses(0);
+std::atomic<uint32> MapQueryCache::_flushes(0);
+std::atomic<uint32> MapQueryCache::_entries(0);
+
+namespace
+{
+    // slots of finished threads are handed out again, so threads coming and going never run out of caches
+    std::mutex freeSlotsLock;
+    std::vector<uint32> freeSlots;
+    uint32 nextSlot = 0;
+
+    void ReleaseThreadSlot(uint32* slot)
+    {
+        {
+            std::lock_guard<std::mutex> lock(freeSlotsLock);
+            freeSlots.push_back(*slot);
+        }
+
+        delete slot;
+    }
+
+    boost::thread_specific_ptr<uint32> threadSlot(&ReleaseThreadSlot);
+}
+
+bool MapQueryCache::Key::operator==(Key const& right) const
+{
+    return Type == right.Type && Param == right.Param && memcmp(Pos, right.Pos, sizeof(Pos)) == 0;
+}
+
+size_t MapQueryCache::KeyHash::operator()(Key const& key) const
+{
+    size_t hash = key.Type;
+    for (int32 pos : key.Pos)
+        hash = hash * 31 + uint32(pos);
+
+    return hash * 31 + key.Param;
+}
+
+MapQueryCache::~MapQueryCache()
+{
+    _entries -= uint32(_results.size());
+}
+
+MapQueryCache::Key MapQueryCache::MakeKey(QueryType type, float x1, float y1, float z1, float x2, float y2, float z2, uint32 param)
+{
+    Key key;
+    key.Pos[0] = int32(std::floor(x1 * MAP_QUERY_CACHE_RESOLUTION));
+    key.Pos[1] = int32(std::floor(y1 * MAP_QUERY_CACHE_RESOLUTION));
+    key.Pos[2] = int32(std::floor(z1 * MAP_QUERY_CACHE_RESOLUTION));
+    key.Pos[3] = int32(std::floor(x2 * MAP_QUERY_CACHE_RESOLUTION));
+    key.Pos[4] = int32(std::floor(y2 * MAP_QUERY_CACHE_RESOLUTION));
+    key.Pos[5] = int32(std::floor(z2 * MAP_QUERY_CACHE_RESOLUTION));
+    key.Param = param;
+    key.Type = type;
+    return key;
+}
+
+void MapQueryCache::Validate(uint64 generation)
+{
+    if (_generation == generation)
+        return;
+
+    _generation = generation;
+    Clear();
+}
+
+MapQueryCache::Result const* MapQueryCache::Find(Key const& key) const
+{
+    ResultMap::const_iterator itr = _results.find(key);
+    if (itr == _results.end())
+    {
+        ++_misses;
+        return nullptr;
+    }
+
+    ++_hits;
+    return &itr->second;
+}
+
+void MapQueryCache::Store(Key const& key, Result const& result)
+{
+    // full - start over, entries of objects still standing there come back quickly
+    if (_results.size() >= _maxEntries)
+        Clear();
+
+    if (_results.emplace(key, result).second)
+        ++_entries;
+}
+
+void MapQueryCache::Clear()
+{
+    if (_results.empty())
+        return;
+
+    _entries -= uint32(_results.size());
+    _results.clear();
+    ++_flushes;
+}
+
+uint32 MapQueryCache::GetThreadSlot()
+{
+    uint32* slot = threadSlot.get();
+
+    if (!slot)
+    {
+        std::lock_guard<std::mutex> lock(freeSlotsLock);
+        if (!freeSlots.empty())
+        {
+            slot = new uint32(freeSlots.back());
+            freeSlots.pop_back();
+        }
+        else
+            slot = new uint32(nextSlot++);
+
+        threadSlot.reset(slot);
+    }
+
+    return *slot;
+}
+
+void MapQueryCache::LogStats()
+{
+    if (!sLog->ShouldLog("maps", LOG_LEVEL_DEBUG))
+        return;
+
+    uint32 hits = _hits.exchange(0);
+    uint32 misses = _misses.exchange(0);
+    uint32 flushes = _flushes.exchange(0);
+    if (!hits && !misses)
+        return;
+
+    // key and result plus the bucket and node overhead of the hash map
+    uint32 entries = _entries;
+    uint64 memory = uint64(entries) * (sizeof(Key) + sizeof(Result) + 3 * sizeof(void*));
+
+    TC_LOG_DEBUG("maps", "MapQueryCache: %u hits, %u misses (%.1f%% hit rate), %u entries using about %u KB, %u caches flushed",
+        hits, misses, float(hits) * 100.0f / float(hits + misses), entries, uint32(memory / 1024), flushes);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_MAPQUERYCACHE_H
+#define TRINITY_MAPQUERYCACHE_H
+
+#include "Define.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#define MAX_MAP_QUERY_CACHE_THREADS 16
+
+/**
+ * Results of the static geometry queries of one map (terrain and vmaps), as seen by one thread.
+ *
+ * Positions are quantized so that objects standing still keep hitting the same entries.
+ * Dynamic geometry (gameobject models) is not part of the cached results and is always queried
+ * live by the map, so only loading and unloading of grids can invalidate entries.
+ */
+class TC_GAME_API MapQueryCache
+{
+    public:
+        enum QueryType : uint8
+        {
+            QUERY_LINE_OF_SIGHT,
+            QUERY_HEIGHT,
+            QUERY_AREA_INFO
+        };
+
+        struct Key
+        {
+            int32 Pos[6];
+            uint32 Param;       // query specific, e.g. search distance of height queries
+            QueryType Type;
+
+            bool operator==(Key const& right) const;
+        };
+
+        struct Result
+        {
+            float Height;
+            uint32 Flags;
+            int32 AdtId;
+            int32 RootId;
+            int32 GroupId;
+            bool Value;
+        };
+
+        explicit MapQueryCache(uint32 maxEntries) : _maxEntries(maxEntries), _generation(0) { }
+        ~MapQueryCache();
+
+        static Key MakeKey(QueryType type, float x1, float y1, float z1, float x2 = 0.0f, float y2 = 0.0f, float z2 = 0.0f, uint32 param = 0);
+
+        /// Drops all entries if the terrain of the map changed since they were stored
+        void Validate(uint64 generation);
+
+        Result const* Find(Key const& key) const;
+        void Store(Key const& key, Result const& result);
+
+        /// Index of the calling thread among the threads using query caches, handed out again once the thread exits
+        static uint32 GetThreadSlot();
+
+        /// Writes hit rate and memory use of all caches to the log and resets the counters
+        static void LogStats();
+
+    private:
+        struct KeyHash
+        {
+            size_t operator()(Key const& key) const;
+        };
+
+        void Clear();
+
+        typedef std::unordered_map<Key, Result, KeyHash> ResultMap;
+
+        ResultMap _results;
+        uint32 _maxEntries;
+        uint64 _generation;
+
+        static std::atomic<uint32> _hits;
+        static std::atomic<uint32> _misses;
+        static std::atomic<uint32> _flushes;
+        static std::atomic<uint32> _entries;
+};
+
+#endif
@@ -19,10 +19,28 @@
 #include "MapUpdater.h"
 #include "Map.h"
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include <mutex>
 
-
 class MapUpdateRequest
+{
+    public:
+
+        explicit MapUpdateRequest(uint32 cost) : m_cost(cost) { }
+        virtual ~MapUpdateRequest() { }
+
+        uint32 GetCostEstimate() const { return m_cost; }
+
+        virtual void call() = 0;
+
+    private:
+
+        uint32 m_cost;
+};
+
+class MapRequest : public MapUpdateRequest
 {
     private:
 
@@ -32,33 +50,103 @@ class MapUpdateRequest
 
     public:
 
-        MapUpdateRequest(Map& m, MapUpdater& u, uint32 d)
-            : m_map(m), m_updater(u), m_diff(d)
+        MapRequest(Map& m, MapUpdater& u, uint32 d)
+            : MapUpdateRequest(m.GetUpdateCostEstimate()), m_map(m), m_updater(u), m_diff(d)
         {
         }
 
-        void call()
+        void call() override
         {
+            using namespace std::chrono;
+
+            steady_clock::time_point start = steady_clock::now();
             m_map.Update (m_diff);
-            m_updater.update_finished();
+            uint32 cost = uint32(duration_cast<microseconds>(steady_clock::now() - start).count());
+
+            m_map.RecordUpdateCost(cost);
+            m_updater.update_finished(cost);
+        }
+};
+
+struct MapUpdater::JobBatch
+{
+    JobBatch(std::vector<std::function<void()>> const& jobs) : Jobs(jobs), Count(jobs.size()), NextJob(0), FinishedJobs(0) { }
+
+    // runs jobs until none is left to claim, returns false once the batch was already drained
+    bool Help()
+    {
+        bool helped = false;
+        for (size_t job = NextJob++; job < Count; job = NextJob++)
+        {
+            Jobs[job]();
+            helped = true;
+
+            if (++FinishedJobs == Count)
+            {
+                std::lock_guard<std::mutex> lock(Lock);
+                Done.notify_all();
+            }
+        }
+
+        return helped;
+    }
+
+    std::vector<std::function<void()>> const& Jobs;     // only valid while jobs can still be claimed
+    size_t const Count;
+    std::atomic<size_t> NextJob;
+    std::atomic<size_t> FinishedJobs;
+    std::mutex Lock;
+    std::condition_variable Done;
+};
+
+class JobBatchRequest : public MapUpdateRequest
+{
+    private:
+
+        std::shared_ptr<MapUpdater::JobBatch> m_batch;
+        MapUpdater& m_updater;
+
+    public:
+
+        // helpers belong to a map that is already being updated, so they go before any map still waiting
+        JobBatchRequest(std::shared_ptr<MapUpdater::JobBatch> const& batch, MapUpdater& u)
+            : MapUpdateRequest(std::numeric_limits<uint32>::max()), m_batch(batch), m_updater(u)
+        {
+        }
+
+        void call() override
+        {
+            m_batch->Help();
+            m_updater.helper_finished();
         }
 };
 
+static bool IsMoreExpensive(MapUpdateRequest const* left, MapUpdateRequest const* right)
+{
+    return left->GetCostEstimate() > right->GetCostEstimate();
+}
+
 void MapUpdater::activate(size_t num_threads)
 {
+    for (size_t i = 0; i < num_threads; ++i)
+        _workerQueues.emplace_back(new WorkerQueue());
+
     for (size_t i = 0; i < num_threads; ++i)
     {
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this, i));
     }
 }
 
 void MapUpdater::deactivate()
 {
-    _cancelationToken = true;
-
     wait();
 
-    _queue.Cancel();
+    {
+        std::lock_guard<std::mutex> lock(_workLock);
+        _cancelationToken = true;
+    }
+
+    _workCondition.notify_all();
 
     for (auto& thread : _workerThreads)
     {
@@ -68,21 +156,41 @@ void MapUpdater::deactivate()
 
 void MapUpdater::wait()
 {
+    using namespace std::chrono;
+
+    steady_clock::time_point start = steady_clock::now();
+    bool scheduled = !_scheduled.empty();
+
+    dispatch();
+
     std::unique_lock<std::mutex> lock(_lock);
 
-    while (pending_requests > 0)
+    while (_pendingRequests > 0)
         _condition.wait(lock);
 
     lock.unlock();
+
+    if (!scheduled)
+        return;
+
+    _lastTick.Requests = _tickRequests.exchange(0);
+    _lastTick.Steals = _tickSteals.exchange(0);
+    _lastTick.Makespan = uint64(duration_cast<microseconds>(steady_clock::now() - start).count());
+    _lastTick.TotalCost = _tickCost.exchange(0);
 }
 
 void MapUpdater::schedule_update(Map& map, uint32 diff)
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    MapUpdateRequest* request = new MapRequest(map, *this, diff);
 
-    ++pending_requests;
+    ++_pendingRequests;
 
-    _queue.Push(new MapUpdateRequest(map, *this, diff));
+    // instances scheduled by a MapInstanced being updated go straight to that worker, idle workers will steal them
+    int32 worker = current_worker();
+    if (worker >= 0)
+        enqueue(size_t(worker), request);
+    else
+        _scheduled.push_back(request);
 }
 
 bool MapUpdater::activated()
@@ -90,25 +198,174 @@ bool MapUpdater::activated()
     return _workerThreads.size() > 0;
 }
 
-void MapUpdater::update_finished()
+void MapUpdater::run_jobs(std::vector<std::function<void()>> const& jobs)
+{
+    if (jobs.empty())
+        return;
+
+    if (!activated() || jobs.size() == 1)
+    {
+        for (std::function<void()> const& job : jobs)
+            job();
+
+        return;
+    }
+
+    std::shared_ptr<JobBatch> batch = std::make_shared<JobBatch>(jobs);
+
+    // the calling thread works on the batch as well, so helpers that are never picked up can't stall it
+    int32 self = current_worker();
+    size_t helpers = std::min(jobs.size() - 1, _workerThreads.size() - (self >= 0 ? 1 : 0));
+    for (size_t i = 0, worker = 0; i < helpers; ++worker)
+    {
+        if (int32(worker) == self)
+            continue;
+
+        ++_pendingRequests;
+        enqueue(worker, new JobBatchRequest(batch, *this));
+        ++i;
+    }
+
+    batch->Help();
+
+    std::unique_lock<std::mutex> lock(batch->Lock);
+    batch->Done.wait(lock, [&batch] { return batch->FinishedJobs == batch->Count; });
+}
+
+void MapUpdater::dispatch()
+{
+    if (_scheduled.empty())
+        return;
+
+    // longest processing time first: hand out the most expensive maps first, each to the least loaded worker
+    std::stable_sort(_scheduled.begin(), _scheduled.end(), IsMoreExpensive);
+
+    _queuedRequests += _scheduled.size();
+
+    std::vector<uint64> load(_workerQueues.size(), 0);
+    for (MapUpdateRequest* request : _scheduled)
+    {
+        size_t worker = std::min_element(load.begin(), load.end()) - load.begin();
+        load[worker] += std::max<uint32>(request->GetCostEstimate(), 1);
+
+        WorkerQueue& queue = *_workerQueues[worker];
+        std::lock_guard<std::mutex> lock(queue.Lock);
+        queue.Requests.push_back(request);
+    }
+
+    {
+        // pairs with the predicate check in WorkerThread so no wakeup is lost
+        std::lock_guard<std::mutex> lock(_workLock);
+    }
+
+    _workCondition.notify_all();
+
+    _scheduled.clear();
+}
+
+void MapUpdater::enqueue(size_t worker, MapUpdateRequest* request)
+{
+    ++_queuedRequests;
+
+    {
+        WorkerQueue& queue = *_workerQueues[worker];
+        std::lock_guard<std::mutex> lock(queue.Lock);
+        queue.Requests.insert(std::upper_bound(queue.Requests.begin(), queue.Requests.end(), request, IsMoreExpensive), request);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_workLock);
+    }
+
+    _workCondition.notify_one();
+}
+
+MapUpdateRequest* MapUpdater::next_request(size_t worker)
+{
+    {
+        WorkerQueue& queue = *_workerQueues[worker];
+        std::lock_guard<std::mutex> lock(queue.Lock);
+        if (!queue.Requests.empty())
+        {
+            MapUpdateRequest* request = queue.Requests.front();
+            queue.Requests.pop_front();
+            --_queuedRequests;
+            return request;
+        }
+    }
+
+    // own queue is drained, steal the most expensive request still waiting anywhere else
+    size_t victim = worker;
+    uint32 victimCost = 0;
+    for (size_t i = 1; i < _workerQueues.size(); ++i)
+    {
+        size_t candidate = (worker + i) % _workerQueues.size();
+        WorkerQueue& queue = *_workerQueues[candidate];
+        std::lock_guard<std::mutex> lock(queue.Lock);
+        if (!queue.Requests.empty() && (victim == worker || queue.Requests.front()->GetCostEstimate() > victimCost))
+        {
+            victim = candidate;
+            victimCost = queue.Requests.front()->GetCostEstimate();
+        }
+    }
+
+    if (victim == worker)
+        return nullptr;
+
+    WorkerQueue& queue = *_workerQueues[victim];
+    std::lock_guard<std::mutex> lock(queue.Lock);
+    if (queue.Requests.empty())
+        return nullptr;
+
+    MapUpdateRequest* request = queue.Requests.front();
+    queue.Requests.pop_front();
+    --_queuedRequests;
+    ++_tickSteals;
+    return request;
+}
+
+int32 MapUpdater::current_worker() const
+{
+    std::thread::id self = std::this_thread::get_id();
+    for (size_t i = 0; i < _workerThreads.size(); ++i)
+        if (_workerThreads[i].get_id() == self)
+            return int32(i);
+
+    return -1;
+}
+
+void MapUpdater::update_finished(uint32 cost)
+{
+    _tickCost += cost;
+    ++_tickRequests;
+
+    helper_finished();
+}
+
+void MapUpdater::helper_finished()
 {
     std::lock_guard<std::mutex> lock(_lock);
 
-    --pending_requests;
+    --_pendingRequests;
 
     _condition.notify_all();
 }
 
-void MapUpdater::WorkerThread()
+void MapUpdater::WorkerThread(size_t worker)
 {
     while (1)
     {
-        MapUpdateRequest* request = nullptr;
+        MapUpdateRequest* request = next_request(worker);
+        if (!request)
+        {
+            std::unique_lock<std::mutex> lock(_workLock);
+            _workCondition.wait(lock, [this] { return _queuedRequests > 0 || _cancelationToken; });
 
-        _queue.WaitAndPop(request);
+            if (_cancelationToken)
+                return;
 
-        if (_cancelationToken)
-            return;
+            continue;
+        }
 
         request->call();
 
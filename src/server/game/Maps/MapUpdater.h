@@ -20,22 +20,51 @@
 #define _MAP_UPDATER_H_INCLUDED
 
 #include "Define.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <condition_variable>
-#include "ProducerConsumerQueue.h"
 
 class MapUpdateRequest;
 class Map;
 
+/**
+ * Updates maps on a pool of worker threads.
+ *
+ * Maps scheduled from the world thread are collected until wait() and then
+ * distributed longest-processing-time-first: each map's recent update cost is
+ * used to start the most expensive maps first and to balance the estimated load
+ * of every worker. Each worker owns its own queue; idle workers steal the most
+ * expensive pending request from the others, which also absorbs instances
+ * scheduled by MapInstanced while the tick is already running.
+ *
+ * A map being updated can also split its own work into jobs with run_jobs(),
+ * which idle workers help to finish.
+ */
 class TC_GAME_API MapUpdater
 {
     public:
 
-        MapUpdater() : _cancelationToken(false), pending_requests(0) {}
+        struct TickStats
+        {
+            TickStats() : Requests(0), Steals(0), Makespan(0), TotalCost(0) { }
+
+            uint32 Requests;
+            uint32 Steals;
+            uint64 Makespan;    // microseconds from dispatch until the last map finished
+            uint64 TotalCost;   // microseconds spent in Map::Update summed over all requests
+        };
+
+        MapUpdater() : _cancelationToken(false), _pendingRequests(0), _queuedRequests(0), _tickCost(0), _tickRequests(0), _tickSteals(0) { }
         ~MapUpdater() { };
 
-        friend class MapUpdateRequest;
+        friend class MapRequest;
+        friend class JobBatchRequest;
+        struct JobBatch;
 
         void schedule_update(Map& map, uint32 diff);
 
@@ -47,20 +76,50 @@ class TC_GAME_API MapUpdater
 
         bool activated();
 
+        // runs all jobs, in parallel when the pool is active; returns after every job finished
+        void run_jobs(std::vector<std::function<void()>> const& jobs);
+
+        size_t GetThreadCount() const { return _workerThreads.size(); }
+
+        TickStats const& GetLastTickStats() const { return _lastTick; }
+
     private:
 
-        ProducerConsumerQueue<MapUpdateRequest*> _queue;
+        struct WorkerQueue
+        {
+            std::mutex Lock;
+            std::deque<MapUpdateRequest*> Requests;     // ordered by descending cost estimate
+        };
 
         std::vector<std::thread> _workerThreads;
+        std::vector<std::unique_ptr<WorkerQueue>> _workerQueues;
         std::atomic<bool> _cancelationToken;
 
+        // requests scheduled from outside of the worker threads, dispatched by wait()
+        std::vector<MapUpdateRequest*> _scheduled;
+
         std::mutex _lock;
         std::condition_variable _condition;
-        size_t pending_requests;
+        std::atomic<size_t> _pendingRequests;
+
+        std::mutex _workLock;
+        std::condition_variable _workCondition;
+        std::atomic<size_t> _queuedRequests;
+
+        std::atomic<uint64> _tickCost;
+        std::atomic<uint32> _tickRequests;
+        std::atomic<uint32> _tickSteals;
+        TickStats _lastTick;
+
+        void dispatch();
+        void enqueue(size_t worker, MapUpdateRequest* request);
+        MapUpdateRequest* next_request(size_t worker);
+        int32 current_worker() const;
 
-        void update_finished();
+        void update_finished(uint32 cost);
+        void helper_finished();
 
-        void WorkerThread();
+        void WorkerThread(size_t worker);
 };
 
 #endif //_MAP_UPDATER_H_INCLUDED
@@ -21,6 +21,8 @@
 #include "Errors.h"
 #include "Creature.h"
 #include "CreatureAI.h"
+#include "DisableMgr.h"
+#include "Map.h"
 #include "World.h"
 #include "MoveSplineInit.h"
 #include "MoveSpline.h"
@@ -89,15 +91,50 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T* owner, bool up
         z = end.z;
     }
 
-    if (!i_path)
-        i_path = new PathGenerator(owner);
-
     // allow pets to use shortcut if no path found when following their master
     bool forceDest = (owner->GetTypeId() == TYPEID_UNIT && owner->ToCreature()->IsPet()
         && owner->HasUnitState(UNIT_STATE_FOLLOW));
 
-    bool result = i_path->CalculatePath(x, y, z, forceDest);
-    if (!result || (i_path->GetPathType() & PATHFIND_NOPATH))
+    // the first path is needed right away, there is nothing to move along until it is calculated
+    if (!i_path || !sWorld->getBoolConfig(CONFIG_MMAP_ASYNC_PATHS) || !DisableMgr::IsPathfindingEnabled(owner->GetMapId()))
+    {
+        if (!i_path)
+            i_path = std::make_shared<PathGenerator>(owner);
+
+        _moveAlongPath(owner, i_path->CalculatePath(x, y, z, forceDest));
+        return;
+    }
+
+    // keep moving along the previous path until the new one is calculated at the end of the map update,
+    // further requests until then only replace the destination
+    // the request keeps the path generator alive, its address can't be reused before the callback ran
+    PathGenerator const* path = i_path.get();
+    owner->GetMap()->GetPathRequestQueue().Queue(owner, i_path, G3D::Vector3(x, y, z), forceDest, false, [path](Unit* unit, bool calculated)
+    {
+        // the movement generator may have been replaced or suspended meanwhile
+        TargetedMovementGeneratorMedium* generator = unit->GetMotionMaster()->empty() ? nullptr : dynamic_cast<D*>(unit->GetMotionMaster()->top());
+        if (!generator || generator->i_path.get() != path)
+            return;
+
+        T* owner = static_cast<T*>(unit);
+        if (!generator->i_target.isValid() || !generator->i_target->IsInWorld() || !owner->IsAlive())
+            return;
+
+        // DoUpdate would stop the movement right away, try again once the owner can move
+        if (owner->HasUnitState(UNIT_STATE_NOT_MOVE) || owner->HasUnitState(UNIT_STATE_CASTING))
+        {
+            generator->i_recalculateTravel = true;
+            return;
+        }
+
+        generator->_moveAlongPath(owner, calculated);
+    });
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::_moveAlongPath(T* owner, bool calculated)
+{
+    if (!calculated || (i_path->GetPathType() & PATHFIND_NOPATH))
     {
         // Cant reach target
         i_recalculateTravel = true;
@@ -315,6 +352,10 @@ template void TargetedMovementGeneratorMedium<Player, ChaseMovementGenerator<Pla
 template void TargetedMovementGeneratorMedium<Player, FollowMovementGenerator<Player> >::_setTargetLocation(Player*, bool);
 template void TargetedMovementGeneratorMedium<Creature, ChaseMovementGenerator<Creature> >::_setTargetLocation(Creature*, bool);
 template void TargetedMovementGeneratorMedium<Creature, FollowMovementGenerator<Creature> >::_setTargetLocation(Creature*, bool);
+template void TargetedMovementGeneratorMedium<Player, ChaseMovementGenerator<Player> >::_moveAlongPath(Player*, bool);
+template void TargetedMovementGeneratorMedium<Player, FollowMovementGenerator<Player> >::_moveAlongPath(Player*, bool);
+template void TargetedMovementGeneratorMedium<Creature, ChaseMovementGenerator<Creature> >::_moveAlongPath(Creature*, bool);
+template void TargetedMovementGeneratorMedium<Creature, FollowMovementGenerator<Creature> >::_moveAlongPath(Creature*, bool);
 template bool TargetedMovementGeneratorMedium<Player, ChaseMovementGenerator<Player> >::DoUpdate(Player*, uint32);
 template bool TargetedMovementGeneratorMedium<Player, FollowMovementGenerator<Player> >::DoUpdate(Player*, uint32);
 template bool TargetedMovementGeneratorMedium<Creature, ChaseMovementGenerator<Creature> >::DoUpdate(Creature*, uint32);
@@ -39,12 +39,12 @@ class TargetedMovementGeneratorMedium : public MovementGeneratorMedium< T, D >,
 {
     protected:
         TargetedMovementGeneratorMedium(Unit* target, float offset, float angle) :
-            TargetedMovementGeneratorBase(target), i_path(NULL),
+            TargetedMovementGeneratorBase(target),
             i_recheckDistance(0), i_offset(offset), i_angle(angle),
             i_recalculateTravel(false), i_targetReached(false)
         {
         }
-        ~TargetedMovementGeneratorMedium() { delete i_path; }
+        ~TargetedMovementGeneratorMedium() { }
 
     public:
         bool DoUpdate(T*, uint32);
@@ -54,8 +54,10 @@ class TargetedMovementGeneratorMedium : public MovementGeneratorMedium< T, D >,
         bool IsReachable() const { return (i_path) ? (i_path->GetPathType() & PATHFIND_NORMAL) : true; }
     protected:
         void _setTargetLocation(T* owner, bool updateDestination);
+        void _moveAlongPath(T* owner, bool calculated);
 
-        PathGenerator* i_path;
+        // shared with the path request queue of the map while a new path is calculated
+        std::shared_ptr<PathGenerator> i_path;
         TimeTrackerSmall i_recheckDistance;
         float i_offset;
         float i_angle;
@@ -25,10 +25,19 @@
 #include "DisableMgr.h"
 #include "DetourCommon.h"
 #include "DetourNavMeshQuery.h"
+#include "DetourNode.h"
+
+#include <chrono>
 
 ////////////////// PathGenerator //////////////////
+std::atomic<uint32> PathGenerator::_calculatedPaths(0);
+std::atomic<uint32> PathGenerator::_fullReplans(0);
+std::atomic<uint32> PathGenerator::_corridorMoves(0);
+std::atomic<uint64> PathGenerator::_visitedPolys(0);
+std::atomic<uint64> PathGenerator::_calculationTime(0);
+
 PathGenerator::PathGenerator(const Unit* owner) :
-    _polyLength(0), _type(PATHFIND_BLANK), _useStraightPath(false),
+    _polyLength(0), _plannedPolyLength(0), _type(PATHFIND_BLANK), _useStraightPath(false),
     _forceDestination(false), _pointPathLimit(MAX_POINT_PATH_LENGTH), _straightLine(false),
     _endPosition(G3D::Vector3::zero()), _sourceUnit(owner), _navMesh(NULL),
     _navMeshQuery(NULL)
@@ -39,18 +48,15 @@ PathGenerator::PathGenerator(const Unit* owner) :
 
     uint32 mapId = _sourceUnit->GetMapId();
     if (DisableMgr::IsPathfindingEnabled(mapId))
-    {
-        MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-        _navMesh = mmap->GetNavMesh(mapId);
-        _navMeshQuery = mmap->GetNavMeshQuery(mapId, _sourceUnit->GetInstanceId());
-    }
+        _navMesh = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMesh(mapId);
 
     CreateFilter();
 }
 
 PathGenerator::~PathGenerator()
 {
-    TC_LOG_DEBUG("maps", "++ PathGenerator::~PathGenerator() for %u \n", _sourceUnit->GetGUID().GetCounter());
+    // the owner may already be gone when a path request held the last reference
+    TC_LOG_DEBUG("maps", "++ PathGenerator::~PathGenerator()\n");
 }
 
 bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool forceDest, bool straightLine)
@@ -72,6 +78,11 @@ bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool fo
 
     TC_LOG_DEBUG("maps", "++ PathGenerator::CalculatePath() for %u \n", _sourceUnit->GetGUID().GetCounter());
 
+    // paths may be calculated by any thread, the navmesh is shared but the query is not
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+    MMAP::NavMeshReadGuard navMeshGuard(mmap, _sourceUnit->GetMapId());
+    _navMeshQuery = _navMesh ? mmap->GetNavMeshQuery(_sourceUnit->GetMapId()) : NULL;
+
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
     if (!_navMesh || !_navMeshQuery || _sourceUnit->HasUnitState(UNIT_STATE_IGNORE_PATHFINDING) ||
@@ -82,9 +93,14 @@ bool PathGenerator::CalculatePath(float destX, float destY, float destZ, bool fo
         return true;
     }
 
+    std::chrono::steady_clock::time_point calculationStart = std::chrono::steady_clock::now();
+
     UpdateFilter();
 
     BuildPolyPath(start, dest);
+
+    ++_calculatedPaths;
+    _calculationTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - calculationStart).count();
     return true;
 }
 
@@ -296,6 +312,14 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
             }
     }
 
+    // tiles may have been reloaded or the filter changed since the corridor was built
+    if (startPolyFound && !IsCorridorValid(pathStartIndex))
+    {
+        TC_LOG_DEBUG("maps", "++ BuildPolyPath :: corridor invalidated\n");
+        startPolyFound = false;
+        endPolyFound = false;
+    }
+
     if (startPolyFound && endPolyFound)
     {
         TC_LOG_DEBUG("maps", "++ BuildPolyPath :: (startPolyFound && endPolyFound)\n");
@@ -307,98 +331,10 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
         _polyLength = pathEndIndex - pathStartIndex + 1;
         memmove(_pathPolyRefs, _pathPolyRefs + pathStartIndex, _polyLength * sizeof(dtPolyRef));
     }
-    else if (startPolyFound && !endPolyFound)
+    else if (startPolyFound && !endPolyFound && !_straightLine && MoveCorridorEnd(pathStartIndex, startPoint, endPoly, endPoint))
     {
-        TC_LOG_DEBUG("maps", "++ BuildPolyPath :: (startPolyFound && !endPolyFound)\n");
-
-        // we are moving on the old path but target moved out
-        // so we have atleast part of poly-path ready
-
-        _polyLength -= pathStartIndex;
-
-        // try to adjust the suffix of the path instead of recalculating entire length
-        // at given interval the target cannot get too far from its last location
-        // thus we have less poly to cover
-        // sub-path of optimal path is optimal
-
-        // take ~80% of the original length
-        /// @todo play with the values here
-        uint32 prefixPolyLength = uint32(_polyLength * 0.8f + 0.5f);
-        memmove(_pathPolyRefs, _pathPolyRefs+pathStartIndex, prefixPolyLength * sizeof(dtPolyRef));
-
-        dtPolyRef suffixStartPoly = _pathPolyRefs[prefixPolyLength-1];
-
-        // we need any point on our suffix start poly to generate poly-path, so we need last poly in prefix data
-        float suffixEndPoint[VERTEX_SIZE];
-        if (dtStatusFailed(_navMeshQuery->closestPointOnPoly(suffixStartPoly, endPoint, suffixEndPoint, NULL)))
-        {
-            // we can hit offmesh connection as last poly - closestPointOnPoly() don't like that
-            // try to recover by using prev polyref
-            --prefixPolyLength;
-            suffixStartPoly = _pathPolyRefs[prefixPolyLength-1];
-            if (dtStatusFailed(_navMeshQuery->closestPointOnPoly(suffixStartPoly, endPoint, suffixEndPoint, NULL)))
-            {
-                // suffixStartPoly is still invalid, error state
-                BuildShortcut();
-                _type = PATHFIND_NOPATH;
-                return;
-            }
-        }
-
-        // generate suffix
-        uint32 suffixPolyLength = 0;
-
-        dtStatus dtResult;
-        if (_straightLine)
-        {
-            float hit = 0;
-            float hitNormal[3];
-            memset(hitNormal, 0, sizeof(hitNormal));
-
-            dtResult = _navMeshQuery->raycast(
-                            suffixStartPoly,
-                            suffixEndPoint,
-                            endPoint,
-                            &_filter,
-                            &hit,
-                            hitNormal,
-                            _pathPolyRefs + prefixPolyLength - 1,
-                            (int*)&suffixPolyLength,
-                            MAX_PATH_LENGTH - prefixPolyLength);
-
-            // raycast() sets hit to FLT_MAX if there is a ray between start and end
-            if (hit != FLT_MAX)
-            {
-                // the ray hit something, return no path instead of the incomplete one
-                _type = PATHFIND_NOPATH;
-                return;
-            }
-        }
-        else
-        {
-            dtResult = _navMeshQuery->findPath(
-                            suffixStartPoly,    // start polygon
-                            endPoly,            // end polygon
-                            suffixEndPoint,     // start position
-                            endPoint,           // end position
-                            &_filter,            // polygon search filter
-                            _pathPolyRefs + prefixPolyLength - 1,    // [out] path
-                            (int*)&suffixPolyLength,
-                            MAX_PATH_LENGTH - prefixPolyLength);   // max number of polygons in output path
-        }
-
-        if (!suffixPolyLength || dtStatusFailed(dtResult))
-        {
-            // this is probably an error state, but we'll leave it
-            // and hopefully recover on the next Update
-            // we still need to copy our preffix
-            TC_LOG_ERROR("maps", "%u's Path Build failed: 0 length path", _sourceUnit->GetGUID().GetCounter());
-        }
-
-        TC_LOG_DEBUG("maps", "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n", _polyLength, prefixPolyLength, suffixPolyLength);
-
-        // new path = prefix + suffix - overlap
-        _polyLength = prefixPolyLength + suffixPolyLength - 1;
+        // we are moving on the old path but target moved out, and it could be followed on the navmesh surface
+        TC_LOG_DEBUG("maps", "++ BuildPolyPath :: (startPolyFound && !endPolyFound) corridor moved, m_polyLength=%u\n", _polyLength);
     }
     else
     {
@@ -406,6 +342,7 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
 
         // either we have no path at all -> first run
         // or something went really wrong -> we aren't moving along the path to the target
+        // or the target moved too far to follow it along the old path
         // just generate new path
 
         // free and invalidate old path data
@@ -448,8 +385,13 @@ void PathGenerator::BuildPolyPath(G3D::Vector3 const& startPos, G3D::Vector3 con
                             _pathPolyRefs,     // [out] path
                             (int*)&_polyLength,
                             MAX_PATH_LENGTH);   // max number of polygons in output path
+
+            _visitedPolys += _navMeshQuery->getNodePool()->getNodeCount();
         }
 
+        ++_fullReplans;
+        _plannedPolyLength = _polyLength;
+
         if (!_polyLength || dtStatusFailed(dtResult))
         {
             // only happens if we passed bad data to findPath(), or navmesh is messed up
@@ -678,6 +620,86 @@ bool PathGenerator::HaveTile(const G3D::Vector3& p) const
     return (_navMesh->getTileAt(tx, ty, 0) != NULL);
 }
 
+bool PathGenerator::IsCorridorValid(uint32 startIndex) const
+{
+    for (uint32 i = startIndex; i < _polyLength; ++i)
+        if (!_navMeshQuery->isValidPolyRef(_pathPolyRefs[i], &_filter))
+            return false;
+
+    return true;
+}
+
+bool PathGenerator::MoveCorridorEnd(uint32 startIndex, float const* startPoint, dtPolyRef endPoly, float const* endPoint)
+{
+    // drop the part of the corridor we already passed
+    _polyLength -= startIndex;
+    memmove(_pathPolyRefs, _pathPolyRefs + startIndex, _polyLength * sizeof(dtPolyRef));
+
+    // move the end of the corridor towards the new target position along the navmesh surface
+    // we can hit offmesh connection as last poly - closestPointOnPoly() don't like that
+    dtPolyRef lastPoly = _pathPolyRefs[_polyLength - 1];
+    float corridorEnd[VERTEX_SIZE];
+    if (dtStatusFailed(_navMeshQuery->closestPointOnPoly(lastPoly, endPoint, corridorEnd, NULL)))
+        return false;
+
+    float movedEnd[VERTEX_SIZE];
+    dtPolyRef visited[MAX_CORRIDOR_MOVE_POLYS];
+    uint32 nvisited = 0;
+    if (dtStatusFailed(_navMeshQuery->moveAlongSurface(lastPoly, corridorEnd, endPoint, &_filter, movedEnd, visited, (int*)&nvisited, MAX_CORRIDOR_MOVE_POLYS)))
+        return false;
+
+    _visitedPolys += nvisited;
+
+    // blocked on the way (walls, other floors) - the target can only be reached by a different route
+    if (!nvisited || visited[nvisited - 1] != endPoly)
+        return false;
+
+    _polyLength = MergeCorridorEndMoved(_pathPolyRefs, _polyLength, MAX_PATH_LENGTH, visited, nvisited);
+    if (_pathPolyRefs[_polyLength - 1] != endPoly)
+        return false;
+
+    // optimize the corridor locally: if there is a straight way to the target, take it
+    float hit = 0.0f;
+    float hitNormal[VERTEX_SIZE];
+    dtPolyRef straightPath[MAX_PATH_LENGTH];
+    uint32 straightPathLength = 0;
+    if (dtStatusSucceed(_navMeshQuery->raycast(_pathPolyRefs[0], startPoint, endPoint, &_filter, &hit, hitNormal, straightPath, (int*)&straightPathLength, MAX_PATH_LENGTH))
+        && hit == FLT_MAX && straightPathLength && straightPath[straightPathLength - 1] == endPoly)
+    {
+        memcpy(_pathPolyRefs, straightPath, straightPathLength * sizeof(dtPolyRef));
+        _polyLength = straightPathLength;
+        _plannedPolyLength = _polyLength;
+    }
+    // a corridor that kept growing while following the target is likely a detour by now
+    else if (_polyLength > 2 * _plannedPolyLength + MAX_CORRIDOR_MOVE_POLYS)
+        return false;
+
+    _visitedPolys += straightPathLength;
+    ++_corridorMoves;
+    return true;
+}
+
+uint32 PathGenerator::MergeCorridorEndMoved(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
+{
+    // find the first corridor polygon the move passed, the move replaces everything behind it
+    // (the target may have moved back along the corridor)
+    for (uint32 i = 0; i < npath; ++i)
+    {
+        for (int32 j = nvisited - 1; j >= 0; --j)
+        {
+            if (path[i] != visited[j])
+                continue;
+
+            uint32 size = std::min(nvisited - j - 1, maxPath - i - 1);
+            memcpy(path + i + 1, visited + j + 1, size * sizeof(dtPolyRef));
+            return i + 1 + size;
+        }
+    }
+
+    // If no intersection found just return current path.
+    return npath;
+}
+
 uint32 PathGenerator::FixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
 {
     int32 furthestPath = -1;
@@ -901,6 +923,22 @@ float PathGenerator::Dist3DSqr(G3D::Vector3 const& p1, G3D::Vector3 const& p2) c
     return (p1 - p2).squaredLength();
 }
 
+void PathGenerator::LogStats()
+{
+    uint32 paths = _calculatedPaths.exchange(0);
+    uint32 fullReplans = _fullReplans.exchange(0);
+    uint32 corridorMoves = _corridorMoves.exchange(0);
+    uint64 visitedPolys = _visitedPolys.exchange(0);
+    uint64 calculationTime = _calculationTime.exchange(0);
+
+    if (!paths || !sLog->ShouldLog("maps", LOG_LEVEL_DEBUG))
+        return;
+
+    uint32 repaths = fullReplans + corridorMoves;
+    TC_LOG_DEBUG("maps", "PathGenerator: %u navmesh paths, %u us per path, %u planned from scratch, %u by moving the old path (%.1f polygons visited per repath)",
+        paths, uint32(calculationTime / paths), fullReplans, corridorMoves, repaths ? float(visitedPolys) / float(repaths) : 0.0f);
+}
+
 void PathGenerator::ReducePathLenghtByDist(float dist)
 {
     if (GetPathType() == PATHFIND_BLANK)
@@ -24,6 +24,8 @@
 #include "DetourNavMeshQuery.h"
 #include "MoveSplineInitArgs.h"
 
+#include <atomic>
+
 class Unit;
 
 // 74*4.0f=296y  number_of_points*interval = max_path_len
@@ -35,6 +37,9 @@ class Unit;
 #define SMOOTH_PATH_STEP_SIZE   4.0f
 #define SMOOTH_PATH_SLOP        0.3f
 
+// polygons the end of an existing path may be moved across when the target moves, further moves replan
+#define MAX_CORRIDOR_MOVE_POLYS 16
+
 #define VERTEX_SIZE       3
 #define INVALID_POLYREF   0
 
@@ -74,10 +79,14 @@ class TC_GAME_API PathGenerator
 
         void ReducePathLenghtByDist(float dist); // path must be already built
 
+        /// Writes path counts, polygons visited and time spent per path of all threads to the log and resets the counters
+        static void LogStats();
+
     private:
 
         dtPolyRef _pathPolyRefs[MAX_PATH_LENGTH];   // array of detour polygon references
         uint32 _polyLength;                         // number of polygons in the path
+        uint32 _plannedPolyLength;                  // number of polygons when the path was last planned from scratch
 
         Movement::PointsArray _pathPoints;  // our actual (x,y,z) path to the target
         PathType _type;                     // tells what kind of path this is
@@ -124,6 +133,11 @@ class TC_GAME_API PathGenerator
         void CreateFilter();
         void UpdateFilter();
 
+        // incremental repathing, keeps the poly path as a corridor and only moves its end while possible
+        bool IsCorridorValid(uint32 startIndex) const;
+        bool MoveCorridorEnd(uint32 startIndex, float const* startPoint, dtPolyRef endPoly, float const* endPoint);
+        static uint32 MergeCorridorEndMoved(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited);
+
         // smooth path aux functions
         uint32 FixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited);
         bool GetSteerTarget(float const* startPos, float const* endPos, float minTargetDist, dtPolyRef const* path, uint32 pathSize, float* steerPos,
@@ -131,6 +145,12 @@ class TC_GAME_API PathGenerator
         dtStatus FindSmoothPath(float const* startPos, float const* endPos,
                               dtPolyRef const* polyPath, uint32 polyPathSize,
                               float* smoothPath, int* smoothPathSize, uint32 smoothPathMaxSize);
+
+        static std::atomic<uint32> _calculatedPaths;
+        static std::atomic<uint32> _fullReplans;
+        static std::atomic<uint32> _corridorMoves;
+        static std::atomic<uint64> _visitedPolys;
+        static std::atomic<uint64> _calculationTime;    // microseconds spent in CalculatePath
 };
 
 #endif
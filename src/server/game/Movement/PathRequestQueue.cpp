@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PathRequestQueue.h"
+#include "Log.h"
+#include "Map.h"
+#include "MapManager.h"
+#include "MapUpdater.h"
+#include "ObjectAccessor.h"
+#include "PathGenerator.h"
+#include "Pet.h"
+#include "Player.h"
+#include "Timer.h"
+#include "World.h"
+
+#include <chrono>
+
+std::atomic<uint32> PathRequestQueue::_requests(0);
+std::atomic<uint32> PathRequestQueue::_coalesced(0);
+std::atomic<uint32> PathRequestQueue::_postponed(0);
+std::atomic<uint32> PathRequestQueue::_dropped(0);
+std::atomic<uint64> PathRequestQueue::_latency(0);
+std::atomic<uint32> PathRequestQueue::_maxLatency(0);
+std::atomic<uint64> PathRequestQueue::_calculationTime(0);
+std::atomic<uint32> PathRequestQueue::_statsTime(0);
+
+void PathRequestQueue::Queue(Unit* owner, std::shared_ptr<PathGenerator> const& path, G3D::Vector3 const& dest, bool forceDest, bool straightLine, Callback const& callback)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto itr = _queuedIndex.find(path.get());
+    if (itr != _queuedIndex.end())
+    {
+        // the owner still moves along its previous path, only the latest destination matters
+        Request& request = _queued[itr->second];
+        ++_coalesced;
+        request.Destination = dest;
+        request.ForceDestination = forceDest;
+        request.StraightLine = straightLine;
+        request.Done = callback;
+        return;
+    }
+
+    _queuedIndex[path.get()] = _queued.size();
+    _queued.push_back({ owner->GetGUID(), path, dest, forceDest, straightLine, callback, getMSTime(), false, false });
+}
+
+void PathRequestQueue::Process(Map* map)
+{
+    std::vector<Request> requests;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_queued.empty())
+            return;
+
+        std::swap(requests, _queued);
+        _queuedIndex.clear();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // requests not started within the budget are left for the next update, oldest ones are started first
+    uint32 budget = sWorld->getIntConfig(CONFIG_MMAP_PATH_BUDGET);
+    std::chrono::steady_clock::time_point deadline = start + std::chrono::milliseconds(budget);
+
+    // the owners are only read by the jobs, nothing else runs on the map until all of them finished
+    std::vector<std::function<void()>> jobs;
+    jobs.reserve(requests.size());
+    for (Request& request : requests)
+    {
+        if (!GetOwner(map, request.Owner))
+        {
+            request.Path.reset();
+            ++_dropped;
+            continue;
+        }
+
+        jobs.push_back([&request, budget, deadline]()
+        {
+            if (budget && std::chrono::steady_clock::now() >= deadline)
+                return;
+
+            request.Result = request.Path->CalculatePath(request.Destination.x, request.Destination.y, request.Destination.z, request.ForceDestination, request.StraightLine);
+            request.Calculated = true;
+        });
+    }
+
+    sMapMgr->GetMapUpdater()->run_jobs(jobs);
+
+    _calculationTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<Request> postponed;
+    for (Request& request : requests)
+    {
+        if (request.Calculated)
+            _finished.push_back(std::move(request));
+        else if (request.Path)
+            postponed.push_back(std::move(request));
+    }
+
+    if (postponed.empty())
+        return;
+
+    _postponed += uint32(postponed.size());
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (Request& request : postponed)
+    {
+        _queuedIndex[request.Path.get()] = _queued.size();
+        _queued.push_back(std::move(request));
+    }
+}
+
+void PathRequestQueue::ApplyResults(Map* map)
+{
+    if (_finished.empty())
+        return;
+
+    std::vector<Request> finished;
+    std::swap(finished, _finished);
+
+    uint32 now = getMSTime();
+    for (Request& request : finished)
+    {
+        Unit* owner = GetOwner(map, request.Owner);
+        if (!owner)
+        {
+            ++_dropped;
+            continue;
+        }
+
+        uint32 latency = getMSTimeDiff(request.QueueTime, now);
+        ++_requests;
+        _latency += latency;
+
+        uint32 maxLatency = _maxLatency;
+        while (latency > maxLatency && !_maxLatency.compare_exchange_weak(maxLatency, latency))
+            ;
+
+        if (request.Done)
+            request.Done(owner, request.Result);
+    }
+}
+
+void PathRequestQueue::LogStats()
+{
+    uint32 now = getMSTime();
+    uint32 elapsed = getMSTimeDiff(_statsTime.exchange(now), now);
+
+    uint32 requests = _requests.exchange(0);
+    uint32 coalesced = _coalesced.exchange(0);
+    uint32 postponed = _postponed.exchange(0);
+    uint32 dropped = _dropped.exchange(0);
+    uint64 latency = _latency.exchange(0);
+    uint32 maxLatency = _maxLatency.exchange(0);
+    uint64 calculationTime = _calculationTime.exchange(0);
+
+    if (!requests || !elapsed || !sLog->ShouldLog("maps", LOG_LEVEL_DEBUG))
+        return;
+
+    TC_LOG_DEBUG("maps", "PathRequestQueue: %.1f paths/s, average latency %u ms (max %u ms), %u ms spent calculating paths, "
+        "%u requests coalesced, %u postponed over budget, %u dropped",
+        float(requests) * IN_MILLISECONDS / float(elapsed), uint32(latency / requests), maxLatency, uint32(calculationTime / 1000),
+        coalesced, postponed, dropped);
+}
+
+Unit* PathRequestQueue::GetOwner(Map* map, ObjectGuid const& guid)
+{
+    if (guid.IsPlayer())
+        return ObjectAccessor::GetPlayer(map, guid);
+
+    if (guid.IsPet())
+        return map->GetPet(guid);
+
+    return map->GetCreature(guid);
+}
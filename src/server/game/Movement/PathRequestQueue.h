@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_PATHREQUESTQUEUE_H
+#define TRINITY_PATHREQUESTQUEUE_H
+
+#include "Define.h"
+#include "ObjectGuid.h"
+
+#include <G3D/Vector3.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Map;
+class PathGenerator;
+class Unit;
+
+/**
+ * Path calculations of one map that are not needed immediately.
+ *
+ * Requests queued during a map update are calculated at its end, in parallel on the map update
+ * threads while the map itself waits for them. The results are handed to the owners at the start
+ * of the next update, so the owners keep their current movement for one tick. Requests not started
+ * within the configured time budget (mmap.pathFindingBudget) wait for the next update.
+ */
+class TC_GAME_API PathRequestQueue
+{
+    public:
+        /// Called on the map thread with the result of PathGenerator::CalculatePath.
+        /// The requester may be gone by then, only the owner is guaranteed to still be on the map.
+        typedef std::function<void(Unit* owner, bool calculated)> Callback;
+
+        /// Queues path->CalculatePath(dest, forceDest, straightLine) for the owner of the generator.
+        /// A request still queued for the same generator is replaced.
+        void Queue(Unit* owner, std::shared_ptr<PathGenerator> const& path, G3D::Vector3 const& dest, bool forceDest, bool straightLine, Callback const& callback);
+
+        /// Calculates the queued paths, called by the map at the end of its update
+        void Process(Map* map);
+
+        /// Hands the paths calculated during the last update to their owners
+        void ApplyResults(Map* map);
+
+        /// Writes the request rate and latency of all maps to the log and resets the counters
+        static void LogStats();
+
+    private:
+        struct Request
+        {
+            ObjectGuid Owner;
+            std::shared_ptr<PathGenerator> Path;
+            G3D::Vector3 Destination;
+            bool ForceDestination;
+            bool StraightLine;
+            Callback Done;
+            uint32 QueueTime;
+            bool Result;
+            bool Calculated;
+        };
+
+        static Unit* GetOwner(Map* map, ObjectGuid const& guid);
+
+        std::mutex _lock;   // parallel region updates queue requests concurrently
+        std::vector<Request> _queued;
+        std::unordered_map<PathGenerator const*, size_t> _queuedIndex;
+
+        std::vector<Request> _finished;
+
+        static std::atomic<uint32> _requests;
+        static std::atomic<uint32> _coalesced;
+        static std::atomic<uint32> _postponed;
+        static std::atomic<uint32> _dropped;
+        static std::atomic<uint64> _latency;            // milliseconds from queueing until the owner got the result, summed
+        static std::atomic<uint32> _maxLatency;
+        static std::atomic<uint64> _calculationTime;    // microseconds spent in Process
+        static std::atomic<uint32> _statsTime;
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OpcodeProfiler.h"
+#include "Log.h"
+
+#include <algorithm>
+
+OpcodeProfiler::OpcodeProfiler() : _enabled(false)
+{
+    Reset();
+}
+
+OpcodeProfiler* OpcodeProfiler::instance()
+{
+    static OpcodeProfiler instance;
+    return &instance;
+}
+
+uint32 OpcodeProfiler::GetBucket(uint64 time)
+{
+    if (time < 4)
+        return uint32(time);
+
+    uint32 log = 0;
+    for (uint64 value = time; value > 1; value >>= 1)
+        ++log;
+
+    // the two bits below the highest one select one of 4 buckets in [2^log, 2^(log + 1))
+    uint32 bucket = log * 4 + uint32((time >> (log - 2)) & 3) - 4;
+    return std::min<uint32>(bucket, OPCODE_PROFILER_BUCKETS - 1);
+}
+
+uint64 OpcodeProfiler::GetBucketLimit(uint32 bucket)
+{
+    if (bucket < 4)
+        return bucket + 1;
+
+    uint32 log = (bucket + 4) / 4;
+    return uint64(5 + (bucket % 4)) << (log - 2);
+}
+
+void OpcodeProfiler::Record(uint16 opcode, uint64 time, size_t bytes)
+{
+    if (opcode >= NUM_MSG_TYPES)
+        return;
+
+    Counters& counters = _counters[opcode];
+    counters.Count.fetch_add(1, std::memory_order_relaxed);
+    counters.TotalTime.fetch_add(time, std::memory_order_relaxed);
+    counters.Bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.Histogram[GetBucket(time)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64 maxTime = counters.MaxTime.load(std::memory_order_relaxed);
+    while (maxTime < time && !counters.MaxTime.compare_exchange_weak(maxTime, time, std::memory_order_relaxed))
+        ;
+}
+
+void OpcodeProfiler::Reset()
+{
+    for (Counters& counters : _counters)
+    {
+        counters.Count.store(0, std::memory_order_relaxed);
+        counters.TotalTime.store(0, std::memory_order_relaxed);
+        counters.MaxTime.store(0, std::memory_order_relaxed);
+        counters.Bytes.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint32>& bucket : counters.Histogram)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::vector<OpcodeProfiler::OpcodeStats> OpcodeProfiler::GetStats() const
+{
+    std::vector<OpcodeStats> stats;
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        Counters const& counters = _counters[opcode];
+        uint64 count = counters.Count.load(std::memory_order_relaxed);
+        if (!count)
+            continue;
+
+        OpcodeStats opcodeStats;
+        opcodeStats.Opcode = opcode;
+        opcodeStats.Count = count;
+        opcodeStats.TotalTime = counters.TotalTime.load(std::memory_order_relaxed);
+        opcodeStats.MaxTime = counters.MaxTime.load(std::memory_order_relaxed);
+        opcodeStats.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+        opcodeStats.P99Time = 0;
+
+        // buckets may be updated while we read them, recount instead of trusting Count
+        uint64 histogramCount = 0;
+        for (std::atomic<uint32> const& bucket : counters.Histogram)
+            histogramCount += bucket.load(std::memory_order_relaxed);
+
+        uint64 p99Count = histogramCount - histogramCount / 100;
+        uint64 seen = 0;
+        for (uint32 bucket = 0; bucket < OPCODE_PROFILER_BUCKETS; ++bucket)
+        {
+            seen += counters.Histogram[bucket].load(std::memory_order_relaxed);
+            if (seen >= p99Count)
+            {
+                opcodeStats.P99Time = std::min(GetBucketLimit(bucket), opcodeStats.MaxTime);
+                break;
+            }
+        }
+
+        stats.push_back(opcodeStats);
+    }
+
+    std::sort(stats.begin(), stats.end(), [](OpcodeStats const& left, OpcodeStats const& right)
+    {
+        return left.TotalTime > right.TotalTime;
+    });
+
+    return stats;
+}
+
+void OpcodeProfiler::LogStats(uint32 count)
+{
+    if (!IsEnabled())
+        return;
+
+    std::vector<OpcodeStats> stats = GetStats();
+    if (stats.size() > count)
+        stats.resize(count);
+
+    for (OpcodeStats const& opcodeStats : stats)
+        TC_LOG_DEBUG("network.opcode", "OpcodeProfiler: %s count " UI64FMTD " total " UI64FMTD " us avg " UI64FMTD " ns p99 " UI64FMTD " ns max " UI64FMTD " ns bytes " UI64FMTD,
+            GetOpcodeNameForLogging(opcodeStats.Opcode).c_str(), opcodeStats.Count, opcodeStats.TotalTime / 1000, opcodeStats.TotalTime / opcodeStats.Count,
+            opcodeStats.P99Time, opcodeStats.MaxTime, opcodeStats.Bytes);
+}
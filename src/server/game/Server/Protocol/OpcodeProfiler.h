@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_OPCODEPROFILER_H
+#define TRINITY_OPCODEPROFILER_H
+
+#include "Common.h"
+#include "Opcodes.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#define OPCODE_PROFILER_BUCKETS 148     // 4 buckets per power of two, up to ~4 minutes
+
+/// Collects how much time the handlers of each client opcode take, shared by all threads updating sessions
+class TC_GAME_API OpcodeProfiler
+{
+    private:
+        OpcodeProfiler();
+        ~OpcodeProfiler() { }
+
+    public:
+        struct OpcodeStats
+        {
+            uint16 Opcode;
+            uint64 Count;
+            uint64 TotalTime;   // nanoseconds
+            uint64 MaxTime;     // nanoseconds
+            uint64 P99Time;     // nanoseconds, upper bound of the histogram bucket
+            uint64 Bytes;
+        };
+
+        static OpcodeProfiler* instance();
+
+        bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+        void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+        void Record(uint16 opcode, uint64 time, size_t bytes);
+        void Reset();
+
+        /// Returns the opcodes received since the last reset, most total time first
+        std::vector<OpcodeStats> GetStats() const;
+        /// Writes the opcodes taking most time since the last reset to the log
+        void LogStats(uint32 count);
+
+    private:
+        struct Counters
+        {
+            std::atomic<uint64> Count;
+            std::atomic<uint64> TotalTime;
+            std::atomic<uint64> MaxTime;
+            std::atomic<uint64> Bytes;
+            std::array<std::atomic<uint32>, OPCODE_PROFILER_BUCKETS> Histogram;
+        };
+
+        static uint32 GetBucket(uint64 time);
+        static uint64 GetBucketLimit(uint32 bucket);
+
+        std::atomic<bool> _enabled;
+        std::array<Counters, NUM_MSG_TYPES> _counters;
+};
+
+#define sOpcodeProfiler OpcodeProfiler::instance()
+#endif
@@ -43,6 +43,7 @@
 #include "WardenWin.h"
 #include "MoveSpline.h"
 #include "WardenMac.h"
+#include "OpcodeProfiler.h"
 
 #include <zlib.h>
 
@@ -123,7 +124,8 @@ WorldSession::WorldSession(uint32 id, std::string&& name, std::shared_ptr<WorldS
     _RBACData(NULL),
     expireTime(60000), // 1 min after socket loss, session is deleted
     forceExit(false),
-    m_currentBankerGUID()
+    m_currentBankerGUID(),
+    _pooledPackets(0)
 {
     memset(m_Tutorials, 0, sizeof(m_Tutorials));
 
@@ -154,9 +156,8 @@ WorldSession::~WorldSession()
     delete _warden;
     delete _RBACData;
 
-    ///- empty incoming packet queue
-    WorldPacket* packet = NULL;
-    while (_recvQueue.next(packet))
+    ///- empty incoming packet queue, _recvQueue and _packetPool delete what is left in them
+    for (ReceivedPacket* packet : _pendingPackets)
         delete packet;
 
     LoginDatabase.PExecute("UPDATE account SET online = 0 WHERE id = %u;", GetAccountId());     // One-time query
@@ -192,6 +193,22 @@ void WorldSession::SendPacket(WorldPacket const* packet)
     if (!m_Socket)
         return;
 
+    LogSentPacket(*packet);
+    m_Socket->SendPacket(*packet);
+}
+
+/// Send a packet to the client, handing its storage over to the socket
+void WorldSession::SendPacket(WorldPacket&& packet)
+{
+    if (!m_Socket)
+        return;
+
+    LogSentPacket(packet);
+    m_Socket->SendPacket(std::move(packet));
+}
+
+void WorldSession::LogSentPacket(WorldPacket const& packet)
+{
 #ifdef TRINITY_DEBUG
     // Code for network use statistic
     static uint64 sendPacketCount = 0;
@@ -208,10 +225,10 @@ void WorldSession::SendPacket(WorldPacket const* packet)
     if ((cur_time - lastTime) < 60)
     {
         sendPacketCount+=1;
-        sendPacketBytes+=packet->size();
+        sendPacketBytes+=packet.size();
 
         sendLastPacketCount+=1;
-        sendLastPacketBytes+=packet->size();
+        sendLastPacketBytes+=packet.size();
     }
     else
     {
@@ -222,20 +239,66 @@ void WorldSession::SendPacket(WorldPacket const* packet)
 
         lastTime = cur_time;
         sendLastPacketCount = 1;
-        sendLastPacketBytes = packet->wpos();               // wpos is real written size
+        sendLastPacketBytes = packet.wpos();                // wpos is real written size
     }
 #endif                                                      // !TRINITY_DEBUG
 
-    sScriptMgr->OnPacketSend(this, *packet);
+    sScriptMgr->OnPacketSend(this, packet);
 
-    TC_LOG_TRACE("network.opcode", "S->C: %s %s", GetPlayerInfo().c_str(), GetOpcodeNameForLogging(packet->GetOpcode()).c_str());
-    m_Socket->SendPacket(*packet);
+    TC_LOG_TRACE("network.opcode", "S->C: %s %s", GetPlayerInfo().c_str(), GetOpcodeNameForLogging(packet.GetOpcode()).c_str());
+}
+
+#define MAX_POOLED_PACKETS 16
+#define MAX_POOLED_PACKET_SIZE 4096
+
+ReceivedPacket* WorldSession::AcquirePacket()
+{
+    ReceivedPacket* packet;
+    if (_packetPool.Dequeue(packet))
+    {
+        --_pooledPackets;
+        return packet;
+    }
+
+    return new ReceivedPacket();
+}
+
+void WorldSession::ReleasePacket(ReceivedPacket* packet)
+{
+    // don't keep memory of large packets or of a past packet flood around
+    if (packet->size() > MAX_POOLED_PACKET_SIZE || _pooledPackets >= MAX_POOLED_PACKETS)
+    {
+        delete packet;
+        return;
+    }
+
+    ++_pooledPackets;
+    _packetPool.Enqueue(packet);
 }
 
 /// Add an incoming packet to the queue
-void WorldSession::QueuePacket(WorldPacket* new_packet)
+void WorldSession::QueuePacket(ReceivedPacket* new_packet)
 {
-    _recvQueue.add(new_packet);
+    _recvQueue.Enqueue(new_packet);
+}
+
+bool WorldSession::NextPacket(ReceivedPacket*& packet, PacketFilter& updater)
+{
+    if (_pendingPackets.empty())
+    {
+        if (!_recvQueue.Dequeue(packet))
+            return false;
+
+        _pendingPackets.push_back(packet);
+    }
+
+    // leave the packet queued if it has to be processed by another updater
+    packet = _pendingPackets.front();
+    if (!updater.Process(packet))
+        return false;
+
+    _pendingPackets.pop_front();
+    return true;
 }
 
 /// Logging helper for unexpected opcodes
@@ -269,16 +332,23 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not process packets if socket already closed
-    WorldPacket* packet = NULL;
+    ReceivedPacket* packet = NULL;
     //! Delete packet after processing by default
     bool deletePacket = true;
-    std::vector<WorldPacket*> requeuePackets;
+    std::vector<ReceivedPacket*> requeuePackets;
     uint32 processedPackets = 0;
     time_t currentTime = time(NULL);
 
-    while (m_Socket && _recvQueue.next(packet, updater))
+    // with a time budget packets are processed until it is used up instead of a fixed amount of packets
+    std::chrono::microseconds const timeBudget(sWorld->getIntConfig(CONFIG_SESSION_UPDATE_TIME_BUDGET));
+    bool const profile = sOpcodeProfiler->IsEnabled();
+    bool const measure = profile || timeBudget.count();
+    std::chrono::steady_clock::time_point const updateStart = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+    while (m_Socket && NextPacket(packet, updater))
     {
         OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
+        std::chrono::steady_clock::time_point const packetStart = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
         try
         {
             switch (opHandle.status)
@@ -366,21 +436,30 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
             packet->hexlike();
         }
 
+        std::chrono::steady_clock::time_point const packetEnd = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        if (profile && deletePacket)
+            sOpcodeProfiler->Record(packet->GetOpcode(), std::chrono::duration_cast<std::chrono::nanoseconds>(packetEnd - packetStart).count(), packet->size());
+
         if (deletePacket)
-            delete packet;
+            ReleasePacket(packet);
 
         deletePacket = true;
 
 #define MAX_PROCESSED_PACKETS_IN_SAME_WORLDSESSION_UPDATE 100
         processedPackets++;
 
-        //process only a max amout of packets in 1 Update() call.
+        //process only a max amout of packets (or time) in 1 Update() call.
         //Any leftover will be processed in next update
-        if (processedPackets > MAX_PROCESSED_PACKETS_IN_SAME_WORLDSESSION_UPDATE)
+        if (timeBudget.count())
+        {
+            if (packetEnd - updateStart >= timeBudget)
+                break;
+        }
+        else if (processedPackets > MAX_PROCESSED_PACKETS_IN_SAME_WORLDSESSION_UPDATE)
             break;
     }
 
-    _recvQueue.readd(requeuePackets.begin(), requeuePackets.end());
+    _pendingPackets.insert(_pendingPackets.begin(), requeuePackets.begin(), requeuePackets.end());
 
     if (m_Socket && m_Socket->IsOpen() && _warden)
         _warden->Update();
@@ -32,6 +32,8 @@
 #include "WorldPacket.h"
 #include "Cryptography/BigNumber.h"
 #include "AccountMgr.h"
+#include "MPSCQueue.h"
+#include <deque>
 #include <unordered_set>
 
 class Creature;
@@ -142,6 +144,17 @@ enum DeclinedNameResult
     DECLINED_NAMES_RESULT_ERROR   = 1
 };
 
+/// Packet received from the client, recycled by the session it was queued to
+class ReceivedPacket : public WorldPacket
+{
+    public:
+        ReceivedPacket() { }
+
+        using WorldPacket::operator=;
+
+        std::atomic<ReceivedPacket*> QueueLink;
+};
+
 //class to deal with packet processing
 //allows to determine if next packet is safe to be processed
 class PacketFilter
@@ -265,6 +278,7 @@ class TC_GAME_API WorldSession
         void WriteMovementInfo(WorldPacket* data, MovementInfo* mi);
 
         void SendPacket(WorldPacket const* packet);
+        void SendPacket(WorldPacket&& packet);
         void SendNotification(const char *format, ...) ATTR_PRINTF(2, 3);
         void SendNotification(uint32 string_id, ...);
         void SendPetNameInvalid(uint32 error, std::string const& name, DeclinedName *declinedName);
@@ -320,7 +334,9 @@ class TC_GAME_API WorldSession
         void LogoutPlayer(bool save);
         void KickPlayer();
 
-        void QueuePacket(WorldPacket* new_packet);
+        /// Returns a packet to move received data into, reusing one processed by Update when possible (network thread)
+        ReceivedPacket* AcquirePacket();
+        void QueuePacket(ReceivedPacket* new_packet);
         bool Update(uint32 diff, PacketFilter& updater);
 
         /// Handle the authentication waiting queue (to be completed)
@@ -1019,6 +1035,10 @@ class TC_GAME_API WorldSession
         // logging helper
         void LogUnexpectedOpcode(WorldPacket* packet, const char* status, const char *reason);
         void LogUnprocessedTail(WorldPacket* packet);
+        void LogSentPacket(WorldPacket const& packet);
+
+        bool NextPacket(ReceivedPacket*& packet, PacketFilter& updater);
+        void ReleasePacket(ReceivedPacket* packet);
 
         // EnumData helpers
         bool IsLegitCharacterForAccount(ObjectGuid lowGUID)
@@ -1062,7 +1082,13 @@ class TC_GAME_API WorldSession
         AddonsList m_addonsList;
         uint32 recruiterId;
         bool isRecruiter;
-        LockedQueue<WorldPacket*> _recvQueue;
+        // filled by the network thread, consumed by Update which is never called from two threads at once
+        MPSCQueueIntrusive<ReceivedPacket, &ReceivedPacket::QueueLink> _recvQueue;
+        // packets taken out of _recvQueue but not processed yet, only accessed by Update
+        std::deque<ReceivedPacket*> _pendingPackets;
+        // processed packets returned to the network thread by AcquirePacket
+        MPSCQueueIntrusive<ReceivedPacket, &ReceivedPacket::QueueLink> _packetPool;
+        std::atomic<uint32> _pooledPackets;
         rbac::RBACData* _RBACData;
         uint32 expireTime;
         bool forceExit;
@@ -22,26 +22,36 @@
 #include "ScriptMgr.h"
 #include "SHA1.h"
 #include "PacketLog.h"
+#include "WorldSocketMgr.h"
 
 #include <memory>
 
+// packets at least this large are handed to the socket without copying them into a send buffer
+#define ZERO_COPY_PACKET_SIZE 256
+
 class EncryptablePacket : public WorldPacket
 {
 public:
-    EncryptablePacket(WorldPacket const& packet, bool encrypt) : WorldPacket(packet), _encrypt(encrypt) { }
+    EncryptablePacket(WorldPacket const& packet, bool encrypt) : WorldPacket(packet), _encrypt(encrypt), _copied(true), _queueTime(std::chrono::steady_clock::now()) { }
+    EncryptablePacket(WorldPacket&& packet, bool encrypt) : WorldPacket(std::move(packet)), _encrypt(encrypt), _copied(false), _queueTime(std::chrono::steady_clock::now()) { }
 
     bool NeedsEncryption() const { return _encrypt; }
+    bool IsCopy() const { return _copied; }
+    std::chrono::steady_clock::time_point GetQueueTime() const { return _queueTime; }
 
 private:
     bool _encrypt;
+    bool _copied;
+    std::chrono::steady_clock::time_point _queueTime;
 };
 
 using boost::asio::ip::tcp;
 
 WorldSocket::WorldSocket(tcp::socket&& socket)
-    : Socket(std::move(socket)), _authSeed(rand32()), _OverSpeedPings(0), _worldSession(nullptr), _authed(false)
+    : Socket(std::move(socket)), _authSeed(rand32()), _OverSpeedPings(0), _worldSession(nullptr), _authed(false), _flushScheduled(false)
 {
     _headerBuffer.Resize(sizeof(ClientPktHeader));
+    SetWriteSizeLimit(sWorldSocketMgr.GetMaxWriteSize());
 }
 
 void WorldSocket::Start()
@@ -84,37 +94,53 @@ void WorldSocket::CheckIpCallback(PreparedQueryResult result)
     HandleSendAuthSession();
 }
 
-bool WorldSocket::Update()
+void WorldSocket::ProcessBufferQueue()
 {
     EncryptablePacket* queued;
     MessageBuffer buffer;
+    uint32 packets = 0;
+    uint64 bytes = 0;
+    uint64 bytesCopied = 0;
+    uint64 latency = 0;
+    uint64 maxLatency = 0;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
     while (_bufferQueue.Dequeue(queued))
     {
-        ServerPktHeader header(queued->size() + 2, queued->GetOpcode());
+        std::size_t packetSize = queued->size();
+        ServerPktHeader header(packetSize + 2, queued->GetOpcode());
         if (queued->NeedsEncryption())
             _authCrypt.EncryptSend(header.header, header.getHeaderLength());
 
-        if (buffer.GetRemainingSpace() < queued->size() + header.getHeaderLength())
+        bool zeroCopy = packetSize >= ZERO_COPY_PACKET_SIZE;
+        std::size_t copySize = header.getHeaderLength() + (zeroCopy ? 0 : packetSize);
+        if (buffer.GetRemainingSpace() < copySize)
         {
-            QueuePacket(std::move(buffer));
-            buffer.Resize(4096);
+            if (buffer.GetActiveSize() > 0)
+                QueuePacket(std::move(buffer));
+
+            buffer.Reset();
+            buffer.Resize(std::max<std::size_t>(copySize, 4096));
         }
 
-        if (buffer.GetRemainingSpace() >= queued->size() + header.getHeaderLength())
+        buffer.Write(header.header, header.getHeaderLength());
+        if (zeroCopy)
         {
-            buffer.Write(header.header, header.getHeaderLength());
-            if (!queued->empty())
-                buffer.Write(queued->contents(), queued->size());
+            // header goes out with the buffered data before it, the payload is sent from the packet storage
+            QueuePacket(std::move(buffer));
+            QueuePacket(MessageBuffer(queued->Move()));
         }
-        else    // single packet larger than 4096 bytes
-        {
-            MessageBuffer packetBuffer(queued->size() + header.getHeaderLength());
-            packetBuffer.Write(header.header, header.getHeaderLength());
-            if (!queued->empty())
-                packetBuffer.Write(queued->contents(), queued->size());
+        else if (packetSize)
+            buffer.Write(queued->contents(), packetSize);
 
-            QueuePacket(std::move(packetBuffer));
-        }
+        ++packets;
+        bytes += header.getHeaderLength() + packetSize;
+        bytesCopied += copySize;
+        if (queued->IsCopy())
+            bytesCopied += packetSize;
+
+        uint64 packetLatency = std::chrono::duration_cast<std::chrono::microseconds>(now - queued->GetQueueTime()).count();
+        latency += packetLatency;
+        maxLatency = std::max(maxLatency, packetLatency);
 
         delete queued;
     }
@@ -122,6 +148,22 @@ bool WorldSocket::Update()
     if (buffer.GetActiveSize() > 0)
         QueuePacket(std::move(buffer));
 
+    if (packets)
+        sWorldSocketMgr.RecordSendStats(packets, bytes, bytesCopied, latency, maxLatency);
+}
+
+void WorldSocket::HandleFlush()
+{
+    _flushScheduled = false;
+
+    ProcessBufferQueue();
+    BaseSocket::Update();
+}
+
+bool WorldSocket::Update()
+{
+    ProcessBufferQueue();
+
     if (!BaseSocket::Update())
         return false;
 
@@ -149,7 +191,7 @@ void WorldSocket::HandleSendAuthSession()
     seed2.SetRand(16 * 8);
     packet.append(seed2.AsByteArray(16).get(), 16);               // new encryption seeds
 
-    SendPacketAndLogOpcode(packet);
+    SendPacketAndLogOpcode(std::move(packet));
 }
 
 void WorldSocket::OnClose()
@@ -356,8 +398,18 @@ WorldSocket::ReadDataHandlerResult WorldSocket::ReadDataHandler()
             // Catches people idling on the login screen and any lingering ingame connections.
             _worldSession->ResetTimeOutTime();
 
-            // Copy the packet to the heap before enqueuing
-            _worldSession->QueuePacket(new WorldPacket(std::move(packet)));
+            // Move the packet into one recycled by the session before enqueuing and
+            // reuse the storage that packet had for reading the next one
+            ReceivedPacket* received = _worldSession->AcquirePacket();
+            std::vector<uint8> storage(received->Move());
+            *received = std::move(packet);
+            _worldSession->QueuePacket(received);
+
+            if (storage.capacity() <= READ_BLOCK_SIZE)
+            {
+                _packetBuffer = MessageBuffer(std::move(storage));
+                _packetBuffer.Reset();
+            }
             break;
         }
     }
@@ -378,10 +430,10 @@ void WorldSocket::LogOpcodeText(uint16 opcode, std::unique_lock<std::mutex> cons
     }
 }
 
-void WorldSocket::SendPacketAndLogOpcode(WorldPacket const& packet)
+void WorldSocket::SendPacketAndLogOpcode(WorldPacket&& packet)
 {
     TC_LOG_TRACE("network.opcode", "S->C: %s %s", GetRemoteIpAddress().to_string().c_str(), GetOpcodeNameForLogging(packet.GetOpcode()).c_str());
-    SendPacket(packet);
+    SendPacket(std::move(packet));
 }
 
 void WorldSocket::SendPacket(WorldPacket const& packet)
@@ -392,7 +444,27 @@ void WorldSocket::SendPacket(WorldPacket const& packet)
     if (sPacketLog->CanLogPacket())
         sPacketLog->LogPacket(packet, SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort());
 
-    _bufferQueue.Enqueue(new EncryptablePacket(packet, _authCrypt.IsInitialized()));
+    QueueBufferPacket(new EncryptablePacket(packet, _authCrypt.IsInitialized()));
+}
+
+void WorldSocket::SendPacket(WorldPacket&& packet)
+{
+    if (!IsOpen())
+        return;
+
+    if (sPacketLog->CanLogPacket())
+        sPacketLog->LogPacket(packet, SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort());
+
+    QueueBufferPacket(new EncryptablePacket(std::move(packet), _authCrypt.IsInitialized()));
+}
+
+void WorldSocket::QueueBufferPacket(EncryptablePacket* packet)
+{
+    _bufferQueue.Enqueue(packet);
+
+    // wake up the network thread instead of waiting up to 10ms for its next update
+    if (!_flushScheduled.exchange(true))
+        GetIoService().post(std::bind(&WorldSocket::HandleFlush, shared_from_this()));
 }
 
 void WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
@@ -594,7 +666,7 @@ void WorldSocket::SendAuthResponseError(uint8 code)
     WorldPacket packet(SMSG_AUTH_RESPONSE, 1);
     packet << uint8(code);
 
-    SendPacketAndLogOpcode(packet);
+    SendPacketAndLogOpcode(std::move(packet));
 }
 
 bool WorldSocket::HandlePing(WorldPacket& recvPacket)
@@ -660,6 +732,6 @@ bool WorldSocket::HandlePing(WorldPacket& recvPacket)
 
     WorldPacket packet(SMSG_PONG, 4);
     packet << ping;
-    SendPacketAndLogOpcode(packet);
+    SendPacketAndLogOpcode(std::move(packet));
     return true;
 }
@@ -62,6 +62,8 @@ public:
     bool Update() override;
 
     void SendPacket(WorldPacket const& packet);
+    /// takes over the packet storage instead of copying it
+    void SendPacket(WorldPacket&& packet);
 
 protected:
     void OnClose() override;
@@ -80,11 +82,18 @@ protected:
 private:
     void CheckIpCallback(PreparedQueryResult result);
 
+    /// moves packets queued by SendPacket to the socket write queue, only called from the network thread
+    void ProcessBufferQueue();
+    /// writes queued packets right away instead of waiting for the next network thread update
+    void HandleFlush();
+    /// queues a packet for ProcessBufferQueue and schedules a flush
+    void QueueBufferPacket(EncryptablePacket* packet);
+
     /// writes network.opcode log
     /// accessing WorldSession is not threadsafe, only do it when holding _worldSessionLock
     void LogOpcodeText(uint16 opcode, std::unique_lock<std::mutex> const& guard) const;
     /// sends and logs network.opcode without accessing WorldSession
-    void SendPacketAndLogOpcode(WorldPacket const& packet);
+    void SendPacketAndLogOpcode(WorldPacket&& packet);
     void HandleSendAuthSession();
     void HandleAuthSession(WorldPacket& recvPacket);
     void HandleAuthSessionCallback(std::shared_ptr<AuthSession> authSession, PreparedQueryResult result);
@@ -106,6 +115,7 @@ private:
     MessageBuffer _headerBuffer;
     MessageBuffer _packetBuffer;
     MPSCQueue<EncryptablePacket> _bufferQueue;
+    std::atomic<bool> _flushScheduled;
 
     PreparedQueryResultFuture _queryFuture;
     std::function<void(PreparedQueryResult&&)> _queryCallback;
@@ -43,7 +43,8 @@ public:
     }
 };
 
-WorldSocketMgr::WorldSocketMgr() : BaseSocketMgr(), _socketSendBufferSize(-1), m_SockOutUBuff(65536), _tcpNoDelay(true)
+WorldSocketMgr::WorldSocketMgr() : BaseSocketMgr(), _socketSendBufferSize(-1), m_SockOutUBuff(65536), _tcpNoDelay(true), _maxWriteSize(0),
+    _sentPackets(0), _sentBytes(0), _copiedBytes(0), _sendLatency(0), _maxSendLatency(0)
 {
 }
 
@@ -71,6 +72,9 @@ bool WorldSocketMgr::StartNetwork(boost::asio::io_service& service, std::string
         return false;
     }
 
+    int32 maxWriteSize = sConfigMgr->GetIntDefault("Network.MaxWriteSize", 65536);
+    _maxWriteSize = maxWriteSize > 0 ? std::size_t(maxWriteSize) : 0;
+
     BaseSocketMgr::StartNetwork(service, bindIp, port, threadCount);
 
     _acceptor->SetSocketFactory(std::bind(&BaseSocketMgr::GetSocketForAccept, this));
@@ -119,6 +123,33 @@ void WorldSocketMgr::OnSocketOpen(tcp::socket&& sock, uint32 threadIndex)
     BaseSocketMgr::OnSocketOpen(std::forward<tcp::socket>(sock), threadIndex);
 }
 
+void WorldSocketMgr::RecordSendStats(uint32 packets, uint64 bytes, uint64 bytesCopied, uint64 latency, uint64 maxLatency)
+{
+    _sentPackets.fetch_add(packets, std::memory_order_relaxed);
+    _sentBytes.fetch_add(bytes, std::memory_order_relaxed);
+    _copiedBytes.fetch_add(bytesCopied, std::memory_order_relaxed);
+    _sendLatency.fetch_add(latency, std::memory_order_relaxed);
+
+    uint64 currentMax = _maxSendLatency.load(std::memory_order_relaxed);
+    while (currentMax < maxLatency && !_maxSendLatency.compare_exchange_weak(currentMax, maxLatency, std::memory_order_relaxed))
+        ;
+}
+
+void WorldSocketMgr::LogSendStats()
+{
+    uint64 packets = _sentPackets.exchange(0, std::memory_order_relaxed);
+    uint64 bytes = _sentBytes.exchange(0, std::memory_order_relaxed);
+    uint64 copied = _copiedBytes.exchange(0, std::memory_order_relaxed);
+    uint64 latency = _sendLatency.exchange(0, std::memory_order_relaxed);
+    uint64 maxLatency = _maxSendLatency.exchange(0, std::memory_order_relaxed);
+
+    if (!packets)
+        return;
+
+    TC_LOG_DEBUG("network", "WorldSocketMgr: sent " UI64FMTD " packets (" UI64FMTD " bytes, " UI64FMTD " bytes copied), avg send latency " UI64FMTD " us, max " UI64FMTD " us",
+        packets, bytes, copied, latency / packets, maxLatency);
+}
+
 NetworkThread<WorldSocket>* WorldSocketMgr::CreateThreads() const
 {
     return new WorldSocketThread[GetNetworkThreadCount()];
@@ -26,6 +26,7 @@
 #define __WORLDSOCKETMGR_H
 
 #include "SocketMgr.h"
+#include <atomic>
 
 class WorldSocket;
 
@@ -45,6 +46,14 @@ public:
 
     void OnSocketOpen(tcp::socket&& sock, uint32 threadIndex) override;
 
+    /// Maximum amount of bytes passed to a single socket write, 0 for no limit
+    std::size_t GetMaxWriteSize() const { return _maxWriteSize; }
+
+    /// Called by sockets after moving queued packets to their write queue
+    void RecordSendStats(uint32 packets, uint64 bytes, uint64 bytesCopied, uint64 latency, uint64 maxLatency);
+    /// Writes the send statistics collected since the last call to the network log and resets them
+    void LogSendStats();
+
 protected:
     WorldSocketMgr();
 
@@ -54,6 +63,13 @@ private:
     int32 _socketSendBufferSize;
     int32 m_SockOutUBuff;
     bool _tcpNoDelay;
+    std::size_t _maxWriteSize;
+
+    std::atomic<uint64> _sentPackets;
+    std::atomic<uint64> _sentBytes;
+    std::atomic<uint64> _copiedBytes;
+    std::atomic<uint64> _sendLatency;       // microseconds from WorldSocket::SendPacket until queued for writing
+    std::atomic<uint64> _maxSendLatency;
 };
 
 #define sWorldSocketMgr WorldSocketMgr::Instance()
@@ -620,7 +620,7 @@ void AuraEffect::ChangeAmount(int32 newAmount, bool mark, bool onStackOrReapply)
     if (handleMask & AURA_EFFECT_HANDLE_CHANGE_AMOUNT)
     {
         if (!mark)
-            m_amount = newAmount;
+            UpdateAmount(newAmount);
         else
             SetAmount(newAmount);
         CalculateSpellMod();
@@ -631,6 +631,19 @@ void AuraEffect::ChangeAmount(int32 newAmount, bool mark, bool onStackOrReapply)
             HandleEffect(*apptItr, handleMask, true);
 }
 
+void AuraEffect::UpdateAmount(int32 amount)
+{
+    if (amount == m_amount)
+        return;
+
+    m_amount = amount;
+
+    // the targets cache the amounts of their effects for the aura modifier getters
+    Aura::ApplicationMap const& applications = GetBase()->GetApplicationMap();
+    for (Aura::ApplicationMap::const_iterator itr = applications.begin(); itr != applications.end(); ++itr)
+        itr->second->GetTarget()->_InvalidateAuraModifiers(GetAuraType());
+}
+
 void AuraEffect::HandleEffect(AuraApplication * aurApp, uint8 mode, bool apply)
 {
     // check if call is correct, we really don't want using bitmasks here (with 1 exception)
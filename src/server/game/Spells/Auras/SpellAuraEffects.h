@@ -36,6 +36,9 @@ class TC_GAME_API AuraEffect
         ~AuraEffect();
         explicit AuraEffect(Aura* base, uint8 effIndex, int32 *baseAmount, Unit* caster);
     public:
+        static void* operator new(std::size_t size) { return FreeListPool::Allocate(size); }
+        static void operator delete(void* ptr, std::size_t size) { FreeListPool::Free(ptr, size); }
+
         Unit* GetCaster() const { return GetBase()->GetCaster(); }
         ObjectGuid GetCasterGUID() const { return GetBase()->GetCasterGUID(); }
         Aura* GetBase() const { return m_base; }
@@ -53,7 +56,7 @@ class TC_GAME_API AuraEffect
         int32 GetMiscValue() const { return m_spellInfo->Effects[m_effIndex].MiscValue; }
         AuraType GetAuraType() const { return (AuraType)m_spellInfo->Effects[m_effIndex].ApplyAuraName; }
         int32 GetAmount() const { return m_amount; }
-        void SetAmount(int32 amount) { m_amount = amount; m_canBeRecalculated = false;}
+        void SetAmount(int32 amount) { UpdateAmount(amount); m_canBeRecalculated = false;}
 
         int32 GetPeriodicTimer() const { return m_periodicTimer; }
         void SetPeriodicTimer(int32 periodicTimer) { m_periodicTimer = periodicTimer; }
@@ -99,6 +102,8 @@ class TC_GAME_API AuraEffect
         // add/remove SPELL_AURA_MOD_SHAPESHIFT (36) linked auras
         void HandleShapeshiftBoosts(Unit* target, bool apply) const;
     private:
+        void UpdateAmount(int32 amount);
+
         Aura* const m_base;
 
         SpellInfo const* const m_spellInfo;
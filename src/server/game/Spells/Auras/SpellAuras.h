@@ -19,6 +19,7 @@
 #ifndef TRINITY_SPELLAURAS_H
 #define TRINITY_SPELLAURAS_H
 
+#include "FreeListPool.h"
 #include "SpellAuraDefines.h"
 #include "SpellInfo.h"
 #include "Unit.h"
@@ -46,6 +47,10 @@ class TC_GAME_API AuraApplication
     friend void Unit::_ApplyAuraEffect(Aura* aura, uint8 effIndex);
     friend void Unit::RemoveAura(AuraApplication * aurApp, AuraRemoveMode mode);
     friend AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint8 effMask);
+    public:
+        static void* operator new(std::size_t size) { return FreeListPool::Allocate(size); }
+        static void operator delete(void* ptr, std::size_t size) { FreeListPool::Free(ptr, size); }
+
     private:
         Unit* const _target;
         Aura* const _base;
@@ -88,6 +93,10 @@ class TC_GAME_API Aura
     public:
         typedef std::map<ObjectGuid, AuraApplication*> ApplicationMap;
 
+        // the size passed to operator delete is the one of the derived class thanks to the virtual destructor
+        static void* operator new(std::size_t size) { return FreeListPool::Allocate(size); }
+        static void operator delete(void* ptr, std::size_t size) { FreeListPool::Free(ptr, size); }
+
         static uint8 BuildEffectMaskForOwner(SpellInfo const* spellProto, uint8 avalibleEffectMask, WorldObject* owner);
         static Aura* TryRefreshStackOrCreate(SpellInfo const* spellproto, uint8 tryEffMask, WorldObject* owner, Unit* caster, int32* baseAmount = NULL, Item* castItem = NULL, ObjectGuid casterGUID = ObjectGuid::Empty, bool* refresh = NULL);
         static Aura* TryCreate(SpellInfo const* spellproto, uint8 effMask, WorldObject* owner, Unit* caster, int32 *baseAmount = NULL, Item* castItem = NULL, ObjectGuid casterGUID = ObjectGuid::Empty);
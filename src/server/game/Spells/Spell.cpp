@@ -39,6 +39,7 @@
 #include "SharedDefines.h"
 #include "LootMgr.h"
 #include "VMapFactory.h"
+#include "RayPacket.h"
 #include "Battleground.h"
 #include "Util.h"
 #include "TemporarySummon.h"
@@ -54,6 +55,7 @@
 #include "Battlefield.h"
 #include "BattlefieldMgr.h"
 #include "TradeData.h"
+#include <boost/thread/tss.hpp>
 
 extern pEffect SpellEffects[TOTAL_SPELL_EFFECTS];
 
@@ -789,7 +791,7 @@ void Spell::SelectSpellTargets()
         if (m_spellInfo->IsChanneled())
         {
             uint8 mask = (1 << i);
-            for (std::list<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+            for (std::vector<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
             {
                 if (ihit->effectMask & mask)
                 {
@@ -801,7 +803,7 @@ void Spell::SelectSpellTargets()
         else if (m_auraScaleMask)
         {
             bool checkLvl = !m_UniqueTargetInfo.empty();
-            for (std::list<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end();)
+            for (std::vector<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end();)
             {
                 // remove targets which did not pass min level check
                 if (m_auraScaleMask && ihit->effectMask == m_auraScaleMask)
@@ -809,7 +811,7 @@ void Spell::SelectSpellTargets()
                     // Do not check for selfcast
                     if (!ihit->scaleAura && ihit->targetGUID != m_caster->GetGUID())
                     {
-                         m_UniqueTargetInfo.erase(ihit++);
+                         ihit = m_UniqueTargetInfo.erase(ihit);
                          continue;
                     }
                 }
@@ -1115,8 +1117,7 @@ void Spell::SelectImplicitConeTargets(SpellEffIndex effIndex, SpellImplicitTarge
     if (uint32 containerTypeMask = GetSearcherTypeMask(objectType, condList))
     {
         Trinity::WorldObjectSpellConeTargetCheck check(coneAngle, radius, m_caster, m_spellInfo, selectionType, condList);
-        Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellConeTargetCheck> searcher(m_caster, targets, check, containerTypeMask);
-        SearchTargets<Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellConeTargetCheck> >(searcher, containerTypeMask, m_caster, m_caster, radius);
+        SearchAreaTargets(targets, check, containerTypeMask, m_caster, radius);
 
         CallScriptObjectAreaTargetSelectHandlers(targets, effIndex, targetType);
 
@@ -1160,7 +1161,7 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
         case TARGET_REFERENCE_TYPE_LAST:
         {
             // find last added target for this effect
-            for (std::list<TargetInfo>::reverse_iterator ihit = m_UniqueTargetInfo.rbegin(); ihit != m_UniqueTargetInfo.rend(); ++ihit)
+            for (std::vector<TargetInfo>::reverse_iterator ihit = m_UniqueTargetInfo.rbegin(); ihit != m_UniqueTargetInfo.rend(); ++ihit)
             {
                 if (ihit->effectMask & (1<<effIndex))
                 {
@@ -1214,16 +1215,66 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
             Trinity::Containers::RandomResizeList(targets, maxTargets);
         }
 
+        // test the line of sight of all targets at once instead of one ray per target and effect,
+        // resurrection effects have their own rules and keep the single ray checks
+        bool losChecked = false;
+        if (targets.size() > 1 && !IgnoresLineOfSight())
+        {
+            losChecked = true;
+            for (uint32 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+                if (effMask & (1 << i) && m_spellInfo->Effects[i].Effect == SPELL_EFFECT_RESURRECT_NEW)
+                    losChecked = false;
+
+            if (losChecked)
+                RemoveAreaTargetsOutOfLOS(targets, *center);
+        }
+
         for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end(); ++itr)
         {
             if (Unit* unit = (*itr)->ToUnit())
-                AddUnitTarget(unit, effMask, false, true, center);
+                AddUnitTarget(unit, effMask, false, true, center, !losChecked || unit->GetPhaseMask() != m_caster->GetPhaseMask());
             else if (GameObject* gObjTarget = (*itr)->ToGameObject())
                 AddGOTarget(gObjTarget, effMask);
         }
     }
 }
 
+void Spell::RemoveAreaTargetsOutOfLOS(std::list<WorldObject*>& targets, Position const& center) const
+{
+    // only units sharing the phase of the caster are checked here, others are left to CheckEffectTarget
+    uint32 phaseMask = m_caster->GetPhaseMask();
+    G3D::Vector3 positions[MAX_RAY_PACKET_SIZE];
+    std::vector<std::list<WorldObject*>::iterator> packet;
+    packet.reserve(MAX_RAY_PACKET_SIZE);
+
+    auto checkPacket = [&]()
+    {
+        uint64 visible = m_caster->GetMap()->isInLineOfSight(center.GetPositionX(), center.GetPositionY(), center.GetPositionZ() + 2.0f,
+            positions, uint32(packet.size()), phaseMask);
+        for (uint32 i = 0; i < packet.size(); ++i)
+            if (!(visible & (UI64LIT(1) << i)))
+                targets.erase(packet[i]);
+        packet.clear();
+    };
+
+    // advance before a full packet is checked, which may erase the current target
+    for (std::list<WorldObject*>::iterator itr = targets.begin(); itr != targets.end();)
+    {
+        std::list<WorldObject*>::iterator current = itr++;
+        Unit* unit = (*current)->ToUnit();
+        if (!unit || !unit->IsInWorld() || unit->GetPhaseMask() != phaseMask)
+            continue;
+
+        positions[packet.size()] = G3D::Vector3(unit->GetPositionX(), unit->GetPositionY(), unit->GetPositionZ() + 2.0f);
+        packet.push_back(current);
+        if (packet.size() == MAX_RAY_PACKET_SIZE)
+            checkPacket();
+    }
+
+    if (!packet.empty())
+        checkPacket();
+}
+
 void Spell::SelectImplicitCasterDestTargets(SpellEffIndex effIndex, SpellImplicitTargetInfo const& targetType)
 {
     SpellDestination dest(*m_caster);
@@ -1507,8 +1558,7 @@ void Spell::SelectImplicitTrajTargets(SpellEffIndex effIndex)
 
     std::list<WorldObject*> targets;
     Trinity::WorldObjectSpellTrajTargetCheck check(dist2d, m_targets.GetSrcPos(), m_caster, m_spellInfo);
-    Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellTrajTargetCheck> searcher(m_caster, targets, check, GRID_MAP_TYPE_MASK_ALL);
-    SearchTargets<Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellTrajTargetCheck> > (searcher, GRID_MAP_TYPE_MASK_ALL, m_caster, m_targets.GetSrcPos(), dist2d);
+    SearchAreaTargets(targets, check, GRID_MAP_TYPE_MASK_ALL, m_targets.GetSrcPos(), dist2d);
     if (targets.empty())
         return;
 
@@ -1762,6 +1812,104 @@ uint32 Spell::GetSearcherTypeMask(SpellTargetObjectTypes objType, ConditionConta
     return retMask;
 }
 
+namespace Trinity
+{
+    // Objects of the cells covered by an area search with their positions, stored per coordinate so the
+    // distance test against all of them is a plain loop the compiler turns into vector instructions
+    struct SpellAreaTargetBuffer
+    {
+        std::vector<WorldObject*> Objects;
+        std::vector<float> X, Y, Z, Size;
+        std::vector<uint8> InRange;
+
+        void Clear()
+        {
+            Objects.clear();
+            X.clear(); Y.clear(); Z.clear(); Size.clear();
+        }
+
+        void Add(WorldObject* object, float size)
+        {
+            Objects.push_back(object);
+            X.push_back(object->GetPositionX()); Y.push_back(object->GetPositionY()); Z.push_back(object->GetPositionZ());
+            Size.push_back(size);
+        }
+
+        // conservative, the check does the exact test for the objects left
+        void FilterByDistance(Position const& pos, float range)
+        {
+            uint32 count = uint32(Objects.size());
+            InRange.resize(count);
+
+            float px = pos.GetPositionX(), py = pos.GetPositionY(), pz = pos.GetPositionZ();
+            float const* x = X.data(); float const* y = Y.data(); float const* z = Z.data();
+            float const* size = Size.data();
+            uint8* inRange = InRange.data();
+
+            for (uint32 i = 0; i < count; ++i)
+            {
+                float dx = x[i] - px, dy = y[i] - py, dz = z[i] - pz;
+                float maxDist = range + size[i] + 0.01f;
+                inRange[i] = uint8(dx * dx + dy * dy + dz * dz < maxDist * maxDist);
+            }
+        }
+
+        // the buffers of a thread are reused by all its searches, a search started
+        // while another one is running (from a check) gets an empty one
+        static SpellAreaTargetBuffer& GetThreadBuffer();
+    };
+
+    static boost::thread_specific_ptr<SpellAreaTargetBuffer> threadAreaTargetBuffer;
+
+    SpellAreaTargetBuffer& SpellAreaTargetBuffer::GetThreadBuffer()
+    {
+        SpellAreaTargetBuffer* buffer = threadAreaTargetBuffer.get();
+
+        if (!buffer)
+        {
+            buffer = new SpellAreaTargetBuffer();
+            threadAreaTargetBuffer.reset(buffer);
+        }
+
+        return *buffer;
+    }
+
+    struct SpellAreaTargetSearcher
+    {
+        uint32 i_mapTypeMask;
+        SpellAreaTargetBuffer& i_buffer;
+
+        SpellAreaTargetSearcher(SpellAreaTargetBuffer& buffer, uint32 mapTypeMask) : i_mapTypeMask(mapTypeMask), i_buffer(buffer) { }
+
+        template<class T>
+        void Add(GridRefManager<T>& m, uint32 typeMask)
+        {
+            if (!(i_mapTypeMask & typeMask))
+                return;
+
+            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+                i_buffer.Add(itr->GetSource(), itr->GetSource()->GetObjectSize());
+        }
+
+        void Visit(PlayerMapType& m) { Add(m, GRID_MAP_TYPE_MASK_PLAYER); }
+        void Visit(CreatureMapType& m) { Add(m, GRID_MAP_TYPE_MASK_CREATURE); }
+        void Visit(CorpseMapType& m) { Add(m, GRID_MAP_TYPE_MASK_CORPSE); }
+        void Visit(DynamicObjectMapType& m) { Add(m, GRID_MAP_TYPE_MASK_DYNAMICOBJECT); }
+
+        // the range of gameobjects is tested against their model bounds, leave it to the check
+        void Visit(GameObjectMapType& m)
+        {
+            if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_GAMEOBJECT))
+                return;
+
+            for (GameObjectMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+                i_buffer.Add(itr->GetSource(), std::numeric_limits<float>::infinity());
+        }
+
+        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) { }
+    };
+}
+
 template<class SEARCHER>
 void Spell::SearchTargets(SEARCHER& searcher, uint32 containerMask, Unit* referer, Position const* pos, float radius)
 {
@@ -1796,6 +1944,23 @@ void Spell::SearchTargets(SEARCHER& searcher, uint32 containerMask, Unit* refere
     }
 }
 
+template<class CHECK, class CONTAINER>
+void Spell::SearchAreaTargets(CONTAINER& targets, CHECK& check, uint32 containerMask, Position const* pos, float radius)
+{
+    Trinity::SpellAreaTargetBuffer buffer(std::move(Trinity::SpellAreaTargetBuffer::GetThreadBuffer()));
+    buffer.Clear();
+
+    Trinity::SpellAreaTargetSearcher searcher(buffer, containerMask);
+    SearchTargets<Trinity::SpellAreaTargetSearcher>(searcher, containerMask, m_caster, pos, radius);
+
+    buffer.FilterByDistance(*check._position, check._range);
+    for (size_t i = 0; i < buffer.Objects.size(); ++i)
+        if (buffer.InRange[i] && check(buffer.Objects[i]))
+            targets.push_back(buffer.Objects[i]);
+
+    Trinity::SpellAreaTargetBuffer::GetThreadBuffer() = std::move(buffer);
+}
+
 WorldObject* Spell::SearchNearbyTarget(float range, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectionType, ConditionContainer* condList)
 {
     WorldObject* target = NULL;
@@ -1814,8 +1979,7 @@ void Spell::SearchAreaTargets(std::list<WorldObject*>& targets, float range, Pos
     if (!containerTypeMask)
         return;
     Trinity::WorldObjectSpellAreaTargetCheck check(range, position, m_caster, referer, m_spellInfo, selectionType, condList);
-    Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellAreaTargetCheck> searcher(m_caster, targets, check, containerTypeMask);
-    SearchTargets<Trinity::WorldObjectListSearcher<Trinity::WorldObjectSpellAreaTargetCheck> > (searcher, containerTypeMask, m_caster, position, range);
+    SearchAreaTargets(targets, check, containerTypeMask, position, range);
 }
 
 void Spell::SearchChainTargets(std::list<WorldObject*>& targets, uint32 chainTargets, WorldObject* target, SpellTargetObjectTypes objectType, SpellTargetCheckTypes selectType, ConditionContainer* condList, bool isChainHeal)
@@ -1853,31 +2017,33 @@ void Spell::SearchChainTargets(std::list<WorldObject*>& targets, uint32 chainTar
     if (isBouncingFar)
         searchRadius *= chainTargets;
 
-    std::list<WorldObject*> tempTargets;
-    SearchAreaTargets(tempTargets, searchRadius, target, m_caster, objectType, selectType, condList);
-    tempTargets.remove(target);
+    std::vector<WorldObject*> tempTargets;
+    if (uint32 containerTypeMask = GetSearcherTypeMask(objectType, condList))
+    {
+        Trinity::WorldObjectSpellAreaTargetCheck check(searchRadius, target, m_caster, m_caster, m_spellInfo, selectType, condList);
+        SearchAreaTargets(tempTargets, check, containerTypeMask, target, searchRadius);
+    }
+    tempTargets.erase(std::remove(tempTargets.begin(), tempTargets.end(), target), tempTargets.end());
 
     // remove targets which are always invalid for chain spells
     // for some spells allow only chain targets in front of caster (swipe for example)
     if (!isBouncingFar)
     {
-        for (std::list<WorldObject*>::iterator itr = tempTargets.begin(); itr != tempTargets.end();)
+        tempTargets.erase(std::remove_if(tempTargets.begin(), tempTargets.end(), [this](WorldObject* object)
         {
-            std::list<WorldObject*>::iterator checkItr = itr++;
-            if (!m_caster->HasInArc(static_cast<float>(M_PI), *checkItr))
-                tempTargets.erase(checkItr);
-        }
+            return !m_caster->HasInArc(static_cast<float>(M_PI), object);
+        }), tempTargets.end());
     }
 
     while (chainTargets)
     {
         // try to get unit for next chain jump
-        std::list<WorldObject*>::iterator foundItr = tempTargets.end();
+        std::vector<WorldObject*>::iterator foundItr = tempTargets.end();
         // get unit with highest hp deficit in dist
         if (isChainHeal)
         {
             uint32 maxHPDeficit = 0;
-            for (std::list<WorldObject*>::iterator itr = tempTargets.begin(); itr != tempTargets.end(); ++itr)
+            for (std::vector<WorldObject*>::iterator itr = tempTargets.begin(); itr != tempTargets.end(); ++itr)
             {
                 if (Unit* unit = (*itr)->ToUnit())
                 {
@@ -1893,7 +2059,7 @@ void Spell::SearchChainTargets(std::list<WorldObject*>& targets, uint32 chainTar
         // get closest object
         else
         {
-            for (std::list<WorldObject*>::iterator itr = tempTargets.begin(); itr != tempTargets.end(); ++itr)
+            for (std::vector<WorldObject*>::iterator itr = tempTargets.begin(); itr != tempTargets.end(); ++itr)
             {
                 if (foundItr == tempTargets.end())
                 {
@@ -2010,10 +2176,10 @@ void Spell::CleanupTargetList()
     m_delayMoment = 0;
 }
 
-void Spell::AddUnitTarget(Unit* target, uint32 effectMask, bool checkIfValid /*= true*/, bool implicit /*= true*/, Position const* losPosition /*= nullptr*/)
+void Spell::AddUnitTarget(Unit* target, uint32 effectMask, bool checkIfValid /*= true*/, bool implicit /*= true*/, Position const* losPosition /*= nullptr*/, bool checkLOS /*= true*/)
 {
     for (uint32 effIndex = 0; effIndex < MAX_SPELL_EFFECTS; ++effIndex)
-        if (!m_spellInfo->Effects[effIndex].IsEffect() || !CheckEffectTarget(target, effIndex, losPosition))
+        if (!m_spellInfo->Effects[effIndex].IsEffect() || !CheckEffectTarget(target, effIndex, losPosition, checkLOS))
             effectMask &= ~(1 << effIndex);
 
     // no effects left
@@ -2032,7 +2198,7 @@ void Spell::AddUnitTarget(Unit* target, uint32 effectMask, bool checkIfValid /*=
     ObjectGuid targetGUID = target->GetGUID();
 
     // Lookup target in already in list
-    for (std::list<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+    for (std::vector<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
     {
         if (targetGUID == ihit->targetGUID)             // Found in list
         {
@@ -2142,7 +2308,7 @@ void Spell::AddGOTarget(GameObject* go, uint32 effectMask)
     ObjectGuid targetGUID = go->GetGUID();
 
     // Lookup target in already in list
-    for (std::list<GOTargetInfo>::iterator ihit = m_UniqueGOTargetInfo.begin(); ihit != m_UniqueGOTargetInfo.end(); ++ihit)
+    for (std::vector<GOTargetInfo>::iterator ihit = m_UniqueGOTargetInfo.begin(); ihit != m_UniqueGOTargetInfo.end(); ++ihit)
     {
         if (targetGUID == ihit->targetGUID)                 // Found in list
         {
@@ -2187,7 +2353,7 @@ void Spell::AddItemTarget(Item* item, uint32 effectMask)
         return;
 
     // Lookup target in already in list
-    for (std::list<ItemTargetInfo>::iterator ihit = m_UniqueItemInfo.begin(); ihit != m_UniqueItemInfo.end(); ++ihit)
+    for (std::vector<ItemTargetInfo>::iterator ihit = m_UniqueItemInfo.begin(); ihit != m_UniqueItemInfo.end(); ++ihit)
     {
         if (item == ihit->item)                            // Found in list
         {
@@ -2217,6 +2383,10 @@ void Spell::DoAllEffectOnTarget(TargetInfo* target)
 
     target->processed = true;                               // Target checked in apply effects procedure
 
+    // effect handlers may add targets, which moves the target infos - only the copy stays valid
+    TargetInfo targetInfo = *target;
+    target = &targetInfo;
+
     // Get mask of effects for target
     uint8 mask = target->effectMask;
 
@@ -2786,7 +2956,7 @@ bool Spell::UpdateChanneledTargetList()
             modOwner->ApplySpellMod(m_spellInfo->Id, SPELLMOD_RANGE, range, this);
     }
 
-    for (std::list<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+    for (std::vector<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
     {
         if (ihit->missCondition == SPELL_MISS_NONE && (channelTargetEffectMask & ihit->effectMask))
         {
@@ -3031,7 +3201,7 @@ void Spell::cancel()
             break;
 
         case SPELL_STATE_CASTING:
-            for (std::list<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+            for (std::vector<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
                 if ((*ihit).missCondition == SPELL_MISS_NONE)
                     if (Unit* unit = m_caster->GetGUID() == ihit->targetGUID ? m_caster : ObjectAccessor::GetUnit(*m_caster, ihit->targetGUID))
                         unit->RemoveOwnedAura(m_spellInfo->Id, m_originalCasterGUID, 0, AURA_REMOVE_BY_CANCEL);
@@ -3316,10 +3486,11 @@ void Spell::handle_immediate()
     // process immediate effects (items, ground, etc.) also initialize some variables
     _handle_immediate_phase();
 
-    for (std::list<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
-        DoAllEffectOnTarget(&(*ihit));
+    // effect handlers may add targets, e.g. Righteous Defense
+    for (size_t i = 0; i < m_UniqueTargetInfo.size(); ++i)
+        DoAllEffectOnTarget(&m_UniqueTargetInfo[i]);
 
-    for (std::list<GOTargetInfo>::iterator ihit= m_UniqueGOTargetInfo.begin(); ihit != m_UniqueGOTargetInfo.end(); ++ihit)
+    for (std::vector<GOTargetInfo>::iterator ihit= m_UniqueGOTargetInfo.begin(); ihit != m_UniqueGOTargetInfo.end(); ++ihit)
         DoAllEffectOnTarget(&(*ihit));
 
     FinishTargetProcessing();
@@ -3363,22 +3534,24 @@ uint64 Spell::handle_delayed(uint64 t_offset)
     bool single_missile = (m_targets.HasDst());
 
     // now recheck units targeting correctness (need before any effects apply to prevent adding immunity at first effect not allow apply second spell effect and similar cases)
-    for (std::list<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+    // effect handlers may add targets, e.g. Righteous Defense
+    for (size_t i = 0; i < m_UniqueTargetInfo.size(); ++i)
     {
-        if (ihit->processed == false)
+        TargetInfo& target = m_UniqueTargetInfo[i];
+        if (target.processed == false)
         {
-            if (single_missile || ihit->timeDelay <= t_offset)
+            if (single_missile || target.timeDelay <= t_offset)
             {
-                ihit->timeDelay = t_offset;
-                DoAllEffectOnTarget(&(*ihit));
+                target.timeDelay = t_offset;
+                DoAllEffectOnTarget(&target);
             }
-            else if (next_time == 0 || ihit->timeDelay < next_time)
-                next_time = ihit->timeDelay;
+            else if (next_time == 0 || target.timeDelay < next_time)
+                next_time = target.timeDelay;
         }
     }
 
     // now recheck gameobject targeting correctness
-    for (std::list<GOTargetInfo>::iterator ighit= m_UniqueGOTargetInfo.begin(); ighit != m_UniqueGOTargetInfo.end(); ++ighit)
+    for (std::vector<GOTargetInfo>::iterator ighit= m_UniqueGOTargetInfo.begin(); ighit != m_UniqueGOTargetInfo.end(); ++ighit)
     {
         if (ighit->processed == false)
         {
@@ -3436,7 +3609,7 @@ void Spell::_handle_immediate_phase()
     }
 
     // process items
-    for (std::list<ItemTargetInfo>::iterator ihit= m_UniqueItemInfo.begin(); ihit != m_UniqueItemInfo.end(); ++ihit)
+    for (std::vector<ItemTargetInfo>::iterator ihit= m_UniqueItemInfo.begin(); ihit != m_UniqueItemInfo.end(); ++ihit)
         DoAllEffectOnTarget(&(*ihit));
 
     if (!m_originalCaster)
@@ -4033,7 +4206,7 @@ void Spell::WriteSpellGoTargets(WorldPacket* data)
 {
     // This function also fill data for channeled spells:
     // m_needAliveTargetMask req for stop channelig if one target die
-    for (std::list<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+    for (std::vector<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
     {
         if ((*ihit).effectMask == 0)                  // No effect apply - all immuned add state
             // possibly SPELL_MISS_IMMUNE2 for this??
@@ -4049,7 +4222,7 @@ void Spell::WriteSpellGoTargets(WorldPacket* data)
     uint32 hit = 0;
     size_t hitPos = data->wpos();
     *data << (uint8)0; // placeholder
-    for (std::list<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end() && hit < 255; ++ihit)
+    for (std::vector<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end() && hit < 255; ++ihit)
     {
         if ((*ihit).missCondition == SPELL_MISS_NONE)       // Add only hits
         {
@@ -4059,7 +4232,7 @@ void Spell::WriteSpellGoTargets(WorldPacket* data)
         }
     }
 
-    for (std::list<GOTargetInfo>::const_iterator ighit = m_UniqueGOTargetInfo.begin(); ighit != m_UniqueGOTargetInfo.end() && hit < 255; ++ighit)
+    for (std::vector<GOTargetInfo>::const_iterator ighit = m_UniqueGOTargetInfo.begin(); ighit != m_UniqueGOTargetInfo.end() && hit < 255; ++ighit)
     {
         *data << uint64(ighit->targetGUID);                 // Always hits
         ++hit;
@@ -4068,7 +4241,7 @@ void Spell::WriteSpellGoTargets(WorldPacket* data)
     uint32 miss = 0;
     size_t missPos = data->wpos();
     *data << (uint8)0; // placeholder
-    for (std::list<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end() && miss < 255; ++ihit)
+    for (std::vector<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end() && miss < 255; ++ihit)
     {
         if (ihit->missCondition != SPELL_MISS_NONE)        // Add only miss
         {
@@ -4344,7 +4517,7 @@ void Spell::TakePower()
     {
         if (powerType == POWER_RAGE || powerType == POWER_ENERGY || powerType == POWER_RUNE)
             if (ObjectGuid targetGUID = m_targets.GetUnitTargetGUID())
-                for (std::list<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+                for (std::vector<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
                     if (ihit->targetGUID == targetGUID)
                     {
                         if (ihit->missCondition != SPELL_MISS_NONE)
@@ -4632,7 +4805,7 @@ void Spell::HandleThreatSpells()
     // since 2.0.1 threat from positive effects also is distributed among all targets, so the overall caused threat is at most the defined bonus
     threat /= m_UniqueTargetInfo.size();
 
-    for (std::list<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+    for (std::vector<TargetInfo>::iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
     {
         float threatToAdd = threat;
         if (ihit->missCondition != SPELL_MISS_NONE)
@@ -5745,7 +5918,7 @@ bool Spell::CanAutoCast(Unit* target)
     {
         SelectSpellTargets();
         //check if among target units, our WANTED target is as well (->only self cast spells return false)
-        for (std::list<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+        for (std::vector<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
             if (ihit->targetGUID == targetguid)
                 return true;
     }
@@ -6429,7 +6602,7 @@ void Spell::DelayedChannel()
 
     TC_LOG_DEBUG("spells", "Spell %u partially interrupted for %i ms, new duration: %u ms", m_spellInfo->Id, delaytime, m_timer);
 
-    for (std::list<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+    for (std::vector<TargetInfo>::const_iterator ihit = m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
         if ((*ihit).missCondition == SPELL_MISS_NONE)
             if (Unit* unit = (m_caster->GetGUID() == ihit->targetGUID) ? m_caster : ObjectAccessor::GetUnit(*m_caster, ihit->targetGUID))
                 unit->DelayOwnedAuras(m_spellInfo->Id, m_originalCasterGUID, delaytime);
@@ -6505,7 +6678,7 @@ CurrentSpellTypes Spell::GetCurrentContainer() const
         return(CURRENT_GENERIC_SPELL);
 }
 
-bool Spell::CheckEffectTarget(Unit const* target, uint32 eff, Position const* losPosition) const
+bool Spell::CheckEffectTarget(Unit const* target, uint32 eff, Position const* losPosition, bool checkLOS /*= true*/) const
 {
     switch (m_spellInfo->Effects[eff].ApplyAuraName)
     {
@@ -6527,12 +6700,7 @@ bool Spell::CheckEffectTarget(Unit const* target, uint32 eff, Position const* lo
             break;
     }
 
-    // check for ignore LOS on the effect itself
-    if (m_spellInfo->HasAttribute(SPELL_ATTR2_CAN_TARGET_NOT_IN_LOS) || DisableMgr::IsDisabledFor(DISABLE_TYPE_SPELL, m_spellInfo->Id, NULL, SPELL_DISABLE_LOS))
-        return true;
-
-    // if spell is triggered, need to check for LOS disable on the aura triggering it and inherit that behaviour
-    if (IsTriggered() && m_triggeredByAuraSpell && (m_triggeredByAuraSpell->HasAttribute(SPELL_ATTR2_CAN_TARGET_NOT_IN_LOS) || DisableMgr::IsDisabledFor(DISABLE_TYPE_SPELL, m_triggeredByAuraSpell->Id, NULL, SPELL_DISABLE_LOS)))
+    if (IgnoresLineOfSight())
         return true;
 
     /// @todo shit below shouldn't be here, but it's temporary
@@ -6561,6 +6729,10 @@ bool Spell::CheckEffectTarget(Unit const* target, uint32 eff, Position const* lo
             break;
         default:                                            // normal case
         {
+            // already checked together with the other area targets
+            if (!checkLOS)
+                break;
+
             if (losPosition)
                 return target->IsWithinLOS(losPosition->GetPositionX(), losPosition->GetPositionY(), losPosition->GetPositionZ());
             else
@@ -6581,6 +6753,19 @@ bool Spell::CheckEffectTarget(Unit const* target, uint32 eff, Position const* lo
     return true;
 }
 
+bool Spell::IgnoresLineOfSight() const
+{
+    // check for ignore LOS on the effect itself
+    if (m_spellInfo->HasAttribute(SPELL_ATTR2_CAN_TARGET_NOT_IN_LOS) || DisableMgr::IsDisabledFor(DISABLE_TYPE_SPELL, m_spellInfo->Id, NULL, SPELL_DISABLE_LOS))
+        return true;
+
+    // if spell is triggered, need to check for LOS disable on the aura triggering it and inherit that behaviour
+    if (IsTriggered() && m_triggeredByAuraSpell && (m_triggeredByAuraSpell->HasAttribute(SPELL_ATTR2_CAN_TARGET_NOT_IN_LOS) || DisableMgr::IsDisabledFor(DISABLE_TYPE_SPELL, m_triggeredByAuraSpell->Id, NULL, SPELL_DISABLE_LOS)))
+        return true;
+
+    return false;
+}
+
 bool Spell::IsNextMeleeSwingSpell() const
 {
     return m_spellInfo->HasAttribute(SPELL_ATTR0_ON_NEXT_SWING);
@@ -6600,15 +6785,15 @@ bool Spell::IsNeedSendToClient() const
 
 bool Spell::HaveTargetsForEffect(uint8 effect) const
 {
-    for (std::list<TargetInfo>::const_iterator itr = m_UniqueTargetInfo.begin(); itr != m_UniqueTargetInfo.end(); ++itr)
+    for (std::vector<TargetInfo>::const_iterator itr = m_UniqueTargetInfo.begin(); itr != m_UniqueTargetInfo.end(); ++itr)
         if (itr->effectMask & (1 << effect))
             return true;
 
-    for (std::list<GOTargetInfo>::const_iterator itr = m_UniqueGOTargetInfo.begin(); itr != m_UniqueGOTargetInfo.end(); ++itr)
+    for (std::vector<GOTargetInfo>::const_iterator itr = m_UniqueGOTargetInfo.begin(); itr != m_UniqueGOTargetInfo.end(); ++itr)
         if (itr->effectMask & (1 << effect))
             return true;
 
-    for (std::list<ItemTargetInfo>::const_iterator itr = m_UniqueItemInfo.begin(); itr != m_UniqueItemInfo.end(); ++itr)
+    for (std::vector<ItemTargetInfo>::const_iterator itr = m_UniqueItemInfo.begin(); itr != m_UniqueItemInfo.end(); ++itr)
         if (itr->effectMask & (1 << effect))
             return true;
 
@@ -6770,7 +6955,7 @@ void Spell::HandleLaunchPhase()
             usesAmmo=false;
     }
 
-    for (std::list<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
+    for (std::vector<TargetInfo>::iterator ihit= m_UniqueTargetInfo.begin(); ihit != m_UniqueTargetInfo.end(); ++ihit)
     {
         TargetInfo& target = *ihit;
 
@@ -693,7 +693,7 @@ void SpellMgr::GetSetOfSpellsInSpellGroup(SpellGroup group_id, std::set<uint32>&
     }
 }
 
-bool SpellMgr::AddSameEffectStackRuleSpellGroups(SpellInfo const* spellInfo, int32 amount, std::map<SpellGroup, int32>& groups) const
+SpellGroup SpellMgr::GetSameEffectStackRuleSpellGroup(SpellInfo const* spellInfo) const
 {
     uint32 spellId = spellInfo->GetFirstRankSpell()->Id;
     SpellSpellGroupMapBounds spellGroup = GetSpellSpellGroupMapBounds(spellId);
@@ -702,27 +702,29 @@ bool SpellMgr::AddSameEffectStackRuleSpellGroups(SpellInfo const* spellInfo, int
     {
         SpellGroup group = itr->second;
         SpellGroupStackMap::const_iterator found = mSpellGroupStack.find(group);
-        if (found != mSpellGroupStack.end())
-        {
-            if (found->second == SPELL_GROUP_STACK_RULE_EXCLUSIVE_SAME_EFFECT)
-            {
-                // Put the highest amount in the map
-                if (groups.find(group) == groups.end())
-                    groups[group] = amount;
-                else
-                {
-                    int32 curr_amount = groups[group];
-                    // Take absolute value because this also counts for the highest negative aura
-                    if (abs(curr_amount) < abs(amount))
-                        groups[group] = amount;
-                }
-                // return because a spell should be in only one SPELL_GROUP_STACK_RULE_EXCLUSIVE_SAME_EFFECT group
-                return true;
-            }
-        }
+        // a spell should be in only one SPELL_GROUP_STACK_RULE_EXCLUSIVE_SAME_EFFECT group
+        if (found != mSpellGroupStack.end() && found->second == SPELL_GROUP_STACK_RULE_EXCLUSIVE_SAME_EFFECT)
+            return group;
     }
-    // Not in a SPELL_GROUP_STACK_RULE_EXCLUSIVE_SAME_EFFECT group, so return false
-    return false;
+
+    return SPELL_GROUP_NONE;
+}
+
+bool SpellMgr::AddSameEffectStackRuleSpellGroups(SpellGroup group, int32 amount, std::map<SpellGroup, int32>& groups)
+{
+    // Not in a SPELL_GROUP_STACK_RULE_EXCLUSIVE_SAME_EFFECT group
+    if (group == SPELL_GROUP_NONE)
+        return false;
+
+    // Put the highest amount in the map
+    std::map<SpellGroup, int32>::iterator itr = groups.find(group);
+    if (itr == groups.end())
+        groups[group] = amount;
+    // Take absolute value because this also counts for the highest negative aura
+    else if (abs(itr->second) < abs(amount))
+        itr->second = amount;
+
+    return true;
 }
 
 SpellGroupStackRule SpellMgr::CheckSpellGroupStackRules(SpellInfo const* spellInfo1, SpellInfo const* spellInfo2) const
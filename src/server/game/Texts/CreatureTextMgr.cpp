@@ -24,6 +24,7 @@
 #include "GridNotifiers.h"
 #include "GridNotifiersImpl.h"
 #include "CreatureTextMgr.h"
+#include "StartupTaskGraph.h"
 
 class CreatureTextBuilder
 {
@@ -80,6 +81,8 @@ CreatureTextMgr* CreatureTextMgr::instance()
 
 void CreatureTextMgr::LoadCreatureTexts()
 {
+    StartupTaskGraph::Require("broadcast texts");
+
     uint32 oldMSTime = getMSTime();
 
     mTextMap.clear(); // for reload case
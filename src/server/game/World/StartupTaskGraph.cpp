@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StartupTaskGraph.h"
+#include "Errors.h"
+#include "Log.h"
+#include "Timer.h"
+
+#include <boost/thread/tss.hpp>
+#include <thread>
+
+#ifdef TRINITY_DEBUG
+StartupTaskGraph* StartupTaskGraph::_running = nullptr;
+
+// id of the task running on this thread, unset outside of tasks
+static boost::thread_specific_ptr<uint32> currentTask;
+#endif
+
+void StartupTaskGraph::AddTask(std::string const& name, std::vector<std::string> const& dependencies, Task const& task)
+{
+    ASSERT(!_taskIds.count(name), "Startup task '%s' added twice", name.c_str());
+
+    uint32 id = uint32(_tasks.size());
+    _tasks.emplace_back();
+
+    Node& node = _tasks.back();
+    node.Name = name;
+    node.Work = task;
+    node.PendingDependencies = 0;
+    node.StartTime = 0;
+    node.FinishTime = 0;
+
+    for (std::string const& dependency : dependencies)
+    {
+        auto itr = _taskIds.find(dependency);
+        ASSERT(itr != _taskIds.end(), "Startup task '%s' depends on '%s', which is not added before it", name.c_str(), dependency.c_str());
+
+        node.Dependencies.push_back(itr->second);
+        _tasks[itr->second].Dependents.push_back(id);
+        ++node.PendingDependencies;
+    }
+
+    _taskIds[name] = id;
+}
+
+void StartupTaskGraph::AddStage(std::string const& name, std::vector<std::string> dependencies, Task const& task)
+{
+    if (_lastStage >= 0)
+        dependencies.push_back(_tasks[_lastStage].Name);
+
+    AddTask(name, dependencies, task);
+    _lastStage = int32(_tasks.size() - 1);
+}
+
+void StartupTaskGraph::Run(uint32 threadCount)
+{
+    _startTime = getMSTime();
+    _unfinished = uint32(_tasks.size());
+    for (uint32 i = 0; i < _tasks.size(); ++i)
+        if (!_tasks[i].PendingDependencies)
+            _ready.insert(i);
+
+#ifdef TRINITY_DEBUG
+    _running = this;
+#endif
+
+    std::vector<std::thread> threads;
+    for (uint32 i = 1; i < threadCount; ++i)
+        threads.push_back(std::thread(&StartupTaskGraph::WorkerThread, this));
+
+    WorkerThread();
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+#ifdef TRINITY_DEBUG
+    _running = nullptr;
+#endif
+
+    LogCriticalPath();
+}
+
+void StartupTaskGraph::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    for (;;)
+    {
+        while (_ready.empty() && _unfinished)
+            _taskFinished.wait(lock);
+
+        if (_ready.empty())
+            return;
+
+        // the earliest added task first, the stages keep their order
+        uint32 id = *_ready.begin();
+        _ready.erase(_ready.begin());
+        lock.unlock();
+
+        Node& node = _tasks[id];
+        node.StartTime = getMSTimeDiff(_startTime, getMSTime());
+
+#ifdef TRINITY_DEBUG
+        currentTask.reset(new uint32(id));
+#endif
+        node.Work();
+#ifdef TRINITY_DEBUG
+        currentTask.reset();
+#endif
+
+        node.FinishTime = getMSTimeDiff(_startTime, getMSTime());
+        TC_LOG_INFO("server.loading", ">> Startup task '%s' finished in %u ms", node.Name.c_str(), node.FinishTime - node.StartTime);
+
+        lock.lock();
+        --_unfinished;
+        for (uint32 dependent : node.Dependents)
+            if (!--_tasks[dependent].PendingDependencies)
+                _ready.insert(dependent);
+
+        _taskFinished.notify_all();
+    }
+}
+
+bool StartupTaskGraph::DependsOn(uint32 task, uint32 dependency) const
+{
+    if (task == dependency)
+        return true;
+
+    // dependencies are always added before their dependents
+    if (task < dependency)
+        return false;
+
+    for (uint32 id : _tasks[task].Dependencies)
+        if (DependsOn(id, dependency))
+            return true;
+
+    return false;
+}
+
+void StartupTaskGraph::LogCriticalPath() const
+{
+    if (_tasks.empty())
+        return;
+
+    uint32 last = 0;
+    uint32 busyTime = 0;
+    for (uint32 i = 0; i < _tasks.size(); ++i)
+    {
+        busyTime += _tasks[i].FinishTime - _tasks[i].StartTime;
+        if (_tasks[i].FinishTime >= _tasks[last].FinishTime)
+            last = i;
+    }
+
+    // follow the dependency that finished last back to the start
+    std::vector<uint32> path;
+    for (int32 id = int32(last); id >= 0;)
+    {
+        path.push_back(uint32(id));
+
+        int32 previous = -1;
+        for (uint32 dependency : _tasks[id].Dependencies)
+            if (previous < 0 || _tasks[dependency].FinishTime > _tasks[previous].FinishTime)
+                previous = int32(dependency);
+
+        id = previous;
+    }
+
+    std::string description;
+    for (auto itr = path.rbegin(); itr != path.rend(); ++itr)
+    {
+        Node const& node = _tasks[*itr];
+        if (!description.empty())
+            description += " -> ";
+
+        description += node.Name + " (" + std::to_string(node.FinishTime - node.StartTime) + " ms)";
+    }
+
+    TC_LOG_INFO("server.loading", ">> Loaded %u startup tasks in %u ms (%u ms of work), critical path: %s",
+        uint32(_tasks.size()), _tasks[last].FinishTime, busyTime, description.c_str());
+}
+
+#ifdef TRINITY_DEBUG
+void StartupTaskGraph::Require(char const* name)
+{
+    StartupTaskGraph* graph = _running;
+    uint32 const* task = currentTask.get();
+    if (!graph || !task)
+        return;
+
+    auto itr = graph->_taskIds.find(name);
+    ASSERT(itr != graph->_taskIds.end(), "Startup task '%s' requires unknown task '%s'", graph->_tasks[*task].Name.c_str(), name);
+    ASSERT(graph->DependsOn(*task, itr->second), "Startup task '%s' requires '%s' but does not depend on it",
+        graph->_tasks[*task].Name.c_str(), name);
+}
+#endif
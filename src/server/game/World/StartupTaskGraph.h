@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2008-2016 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_STARTUPTASKGRAPH_H
+#define TRINITY_STARTUPTASKGRAPH_H
+
+#include "Define.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Loaders run at startup, each one started as soon as the loaders it depends on finished.
+ *
+ * Stages form the backbone of the startup and run in the order they were added, tasks only wait
+ * for their declared dependencies and run next to the stages on other threads. Ready tasks are
+ * started in the order they were added, so with a single thread everything runs in that order.
+ * The time of every task and the critical path through the graph are logged to "server.loading".
+ */
+class TC_GAME_API StartupTaskGraph
+{
+    public:
+        typedef std::function<void()> Task;
+
+        StartupTaskGraph() : _lastStage(-1), _unfinished(0), _startTime(0) { }
+
+        /// Adds a task that waits for the named tasks, which must have been added before
+        void AddTask(std::string const& name, std::vector<std::string> const& dependencies, Task const& task);
+
+        /// Adds a task that waits for the named tasks and the stage added before it
+        void AddStage(std::string const& name, std::vector<std::string> dependencies, Task const& task);
+
+        /// Runs all tasks on the calling thread and threadCount - 1 additional ones
+        void Run(uint32 threadCount);
+
+#ifdef TRINITY_DEBUG
+        /// Asserts that the running task depends on the named one, so it can never run before it.
+        /// Loaders call this for the data they need, no-op outside of a task graph.
+        static void Require(char const* name);
+#else
+        static void Require(char const* /*name*/) { }
+#endif
+
+    private:
+        struct Node
+        {
+            std::string Name;
+            Task Work;
+            std::vector<uint32> Dependencies;
+            std::vector<uint32> Dependents;
+            uint32 PendingDependencies;
+            uint32 StartTime;               // milliseconds since Run was called
+            uint32 FinishTime;
+        };
+
+        void WorkerThread();
+        bool DependsOn(uint32 task, uint32 dependency) const;
+        void LogCriticalPath() const;
+
+        std::vector<Node> _tasks;
+        std::unordered_map<std::string, uint32> _taskIds;
+        int32 _lastStage;
+
+        std::mutex _lock;
+        std::condition_variable _taskFinished;
+        std::set<uint32> _ready;
+        uint32 _unfinished;
+        uint32 _startTime;
+
+#ifdef TRINITY_DEBUG
+        static StartupTaskGraph* _running;
+#endif
+};
+
+#endif
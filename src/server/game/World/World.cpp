@@ -37,19 +37,25 @@
 #include "CreatureTextMgr.h"
 #include "DatabaseEnv.h"
 #include "DisableMgr.h"
+#include "FreeListPool.h"
 #include "GameEventMgr.h"
 #include "GameObjectModel.h"
 #include "GridNotifiersImpl.h"
+#include "GridPreloader.h"
 #include "GroupMgr.h"
 #include "GuildMgr.h"
 #include "InstanceSaveMgr.h"
 #include "Language.h"
 #include "LFGMgr.h"
 #include "MapManager.h"
+#include "MapQueryCache.h"
 #include "Memory.h"
 #include "MMapFactory.h"
 #include "ObjectMgr.h"
+#include "OpcodeProfiler.h"
 #include "OutdoorPvPMgr.h"
+#include "PathGenerator.h"
+#include "PathRequestQueue.h"
 #include "Player.h"
 #include "PoolMgr.h"
 #include "GitRevision.h"
@@ -58,6 +64,7 @@
 #include "SkillDiscovery.h"
 #include "SkillExtraItems.h"
 #include "SmartAI.h"
+#include "StartupTaskGraph.h"
 #include "TicketMgr.h"
 #include "TransportMgr.h"
 #include "Unit.h"
@@ -66,6 +73,7 @@
 #include "WaypointMovementGenerator.h"
 #include "WeatherMgr.h"
 #include "WorldSession.h"
+#include "WorldSocketMgr.h"
 
 
 TC_GAME_API std::atomic<bool> World::m_stopEvent(false);
@@ -581,6 +589,8 @@ void World::LoadConfigSettings(bool reload)
         TC_LOG_ERROR("server.loading", "Compression level (%i) must be in range 1..9. Using default compression level (1).", m_int_configs[CONFIG_COMPRESSION]);
         m_int_configs[CONFIG_COMPRESSION] = 1;
     }
+    m_int_configs[CONFIG_COMPRESSION_THRESHOLD] = sConfigMgr->GetIntDefault("Compression.Threshold", 100);
+    m_bool_configs[CONFIG_COMPRESSION_PARALLEL] = sConfigMgr->GetBoolDefault("Compression.Parallel", false);
     m_bool_configs[CONFIG_ADDON_CHANNEL] = sConfigMgr->GetBoolDefault("AddonChannel", true);
     m_bool_configs[CONFIG_CLEAN_CHARACTER_DB] = sConfigMgr->GetBoolDefault("CleanCharacterDB", false);
     m_int_configs[CONFIG_PERSISTENT_CHARACTER_CLEAN_FLAGS] = sConfigMgr->GetIntDefault("PersistentCharacterCleanFlags", 0);
@@ -1196,6 +1206,8 @@ void World::LoadConfigSettings(bool reload)
     }
 
     m_bool_configs[CONFIG_ENABLE_MMAPS] = sConfigMgr->GetBoolDefault("mmap.enablePathFinding", false);
+    m_bool_configs[CONFIG_MMAP_ASYNC_PATHS] = sConfigMgr->GetBoolDefault("mmap.asyncPathFinding", true);
+    m_int_configs[CONFIG_MMAP_PATH_BUDGET] = sConfigMgr->GetIntDefault("mmap.pathFindingBudget", 0);
     TC_LOG_INFO("server.loading", "WORLD: MMap data directory is: %smmaps", m_dataPath.c_str());
 
     m_bool_configs[CONFIG_VMAP_INDOOR_CHECK] = sConfigMgr->GetBoolDefault("vmap.enableIndoorCheck", 0);
@@ -1233,7 +1245,14 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_SHOW_BAN_IN_WORLD] = sConfigMgr->GetBoolDefault("ShowBanInWorld", false);
     m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = sConfigMgr->GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_int_configs[CONFIG_MIN_LOG_UPDATE] = sConfigMgr->GetIntDefault("MinRecordUpdateTimeDiff", 100);
+    m_int_configs[CONFIG_LOADING_THREADS] = sConfigMgr->GetIntDefault("Loading.Threads", 1);
     m_int_configs[CONFIG_NUMTHREADS] = sConfigMgr->GetIntDefault("MapUpdate.Threads", 1);
+    m_int_configs[CONFIG_GRID_PRELOAD_THREADS] = sConfigMgr->GetIntDefault("GridPreload.Threads", 1);
+    m_int_configs[CONFIG_GRID_PRELOAD_LOOKAHEAD] = sConfigMgr->GetIntDefault("GridPreload.LookAhead", 10);
+    m_int_configs[CONFIG_MAP_QUERY_CACHE_ENTRIES] = sConfigMgr->GetIntDefault("MapQueryCache.MaxEntries", 0);
+    m_int_configs[CONFIG_SESSION_UPDATE_TIME_BUDGET] = sConfigMgr->GetIntDefault("SessionUpdate.TimeBudget", 0);
+    m_bool_configs[CONFIG_OPCODE_PROFILER] = sConfigMgr->GetBoolDefault("OpcodeProfiler.Enable", false);
+    sOpcodeProfiler->SetEnabled(m_bool_configs[CONFIG_OPCODE_PROFILER]);
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = sConfigMgr->GetIntDefault("Command.LookupMaxResults", 0);
 
     // Warden
@@ -1428,374 +1447,436 @@ void World::SetInitialWorldSettings()
     TC_LOG_INFO("server.loading", "Loading GameObject models...");
     LoadGameObjectModelList(m_dataPath);
 
-    TC_LOG_INFO("server.loading", "Loading Script Names...");
-    sObjectMgr->LoadScriptNames();
+    ///- Load the world database in parallel, see StartupTaskGraph for the ordering rules.
+    ///  Stages run one after another in the order below, tasks only wait for what they name.
+    ///  Loaders call StartupTaskGraph::Require for the data they read, debug builds assert on missing dependencies.
+    StartupTaskGraph loading;
 
-    TC_LOG_INFO("server.loading", "Loading Instance Template...");
-    sObjectMgr->LoadInstanceTemplate();
+    loading.AddStage("instances", { }, [this]()
+    {
+        TC_LOG_INFO("server.loading", "Loading Script Names...");
+        sObjectMgr->LoadScriptNames();
 
-    // Must be called before `creature_respawn`/`gameobject_respawn` tables
-    TC_LOG_INFO("server.loading", "Loading instances...");
-    sInstanceSaveMgr->LoadInstances();
+        TC_LOG_INFO("server.loading", "Loading Instance Template...");
+        sObjectMgr->LoadInstanceTemplate();
 
-    TC_LOG_INFO("server.loading", "Loading Broadcast texts...");
-    sObjectMgr->LoadBroadcastTexts();
-    sObjectMgr->LoadBroadcastTextLocales();
+        // Must be called before `creature_respawn`/`gameobject_respawn` tables
+        TC_LOG_INFO("server.loading", "Loading instances...");
+        sInstanceSaveMgr->LoadInstances();
 
-    TC_LOG_INFO("server.loading", "Loading Localization strings...");
-    uint32 oldMSTime = getMSTime();
-    sObjectMgr->LoadCreatureLocales();
-    sObjectMgr->LoadGameObjectLocales();
-    sObjectMgr->LoadItemLocales();
-    sObjectMgr->LoadItemSetNameLocales();
-    sObjectMgr->LoadQuestLocales();
-    sObjectMgr->LoadNpcTextLocales();
-    sObjectMgr->LoadPageTextLocales();
-    sObjectMgr->LoadGossipMenuItemsLocales();
-    sObjectMgr->LoadPointOfInterestLocales();
+        sObjectMgr->SetDBCLocaleIndex(GetDefaultDbcLocale());        // Get once for all the locale index of DBC language (console/broadcasts)
+    });
 
-    sObjectMgr->SetDBCLocaleIndex(GetDefaultDbcLocale());        // Get once for all the locale index of DBC language (console/broadcasts)
-    TC_LOG_INFO("server.loading", ">> Localization strings loaded in %u ms", GetMSTimeDiffToNow(oldMSTime));
+    loading.AddTask("broadcast texts", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Broadcast texts...");
+        sObjectMgr->LoadBroadcastTexts();
+        sObjectMgr->LoadBroadcastTextLocales();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Account Roles and Permissions...");
-    sAccountMgr->LoadRBAC();
+    ///- Localization strings, each one in its own store
+    loading.AddTask("creature locales", { }, []() { sObjectMgr->LoadCreatureLocales(); });
+    loading.AddTask("gameobject locales", { }, []() { sObjectMgr->LoadGameObjectLocales(); });
+    loading.AddTask("item locales", { }, []() { sObjectMgr->LoadItemLocales(); });
+    loading.AddTask("item set name locales", { }, []() { sObjectMgr->LoadItemSetNameLocales(); });
+    loading.AddTask("quest locales", { }, []() { sObjectMgr->LoadQuestLocales(); });
+    loading.AddTask("npc text locales", { }, []() { sObjectMgr->LoadNpcTextLocales(); });
+    loading.AddTask("page text locales", { }, []() { sObjectMgr->LoadPageTextLocales(); });
+    loading.AddTask("gossip menu option locales", { }, []() { sObjectMgr->LoadGossipMenuItemsLocales(); });
+    loading.AddTask("point of interest locales", { }, []() { sObjectMgr->LoadPointOfInterestLocales(); });
 
-    TC_LOG_INFO("server.loading", "Loading Page Texts...");
-    sObjectMgr->LoadPageTexts();
+    loading.AddTask("rbac", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Account Roles and Permissions...");
+        sAccountMgr->LoadRBAC();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Game Object Templates...");         // must be after LoadPageTexts
-    sObjectMgr->LoadGameObjectTemplate();
+    loading.AddStage("templates", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Page Texts...");
+        sObjectMgr->LoadPageTexts();
 
-    TC_LOG_INFO("server.loading", "Loading Transport templates...");
-    sTransportMgr->LoadTransportTemplates();
+        TC_LOG_INFO("server.loading", "Loading Game Object Templates...");         // must be after LoadPageTexts
+        sObjectMgr->LoadGameObjectTemplate();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Rank Data...");
-    sSpellMgr->LoadSpellRanks();
+        TC_LOG_INFO("server.loading", "Loading Transport templates...");
+        sTransportMgr->LoadTransportTemplates();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Required Data...");
-    sSpellMgr->LoadSpellRequired();
+        TC_LOG_INFO("server.loading", "Loading Spell Rank Data...");
+        sSpellMgr->LoadSpellRanks();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Group types...");
-    sSpellMgr->LoadSpellGroups();
+        TC_LOG_INFO("server.loading", "Loading Spell Required Data...");
+        sSpellMgr->LoadSpellRequired();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Learn Skills...");
-    sSpellMgr->LoadSpellLearnSkills();                           // must be after LoadSpellRanks
+        TC_LOG_INFO("server.loading", "Loading Spell Group types...");
+        sSpellMgr->LoadSpellGroups();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Learn Spells...");
-    sSpellMgr->LoadSpellLearnSpells();
+        TC_LOG_INFO("server.loading", "Loading Spell Learn Skills...");
+        sSpellMgr->LoadSpellLearnSkills();                           // must be after LoadSpellRanks
 
-    TC_LOG_INFO("server.loading", "Loading Spell Proc Event conditions...");
-    sSpellMgr->LoadSpellProcEvents();
+        TC_LOG_INFO("server.loading", "Loading Spell Learn Spells...");
+        sSpellMgr->LoadSpellLearnSpells();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Proc conditions and data...");
-    sSpellMgr->LoadSpellProcs();
+        TC_LOG_INFO("server.loading", "Loading Spell Proc Event conditions...");
+        sSpellMgr->LoadSpellProcEvents();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Bonus Data...");
-    sSpellMgr->LoadSpellBonusess();
+        TC_LOG_INFO("server.loading", "Loading Spell Proc conditions and data...");
+        sSpellMgr->LoadSpellProcs();
 
-    TC_LOG_INFO("server.loading", "Loading Aggro Spells Definitions...");
-    sSpellMgr->LoadSpellThreats();
+        TC_LOG_INFO("server.loading", "Loading Spell Bonus Data...");
+        sSpellMgr->LoadSpellBonusess();
 
-    TC_LOG_INFO("server.loading", "Loading Spell Group Stack Rules...");
-    sSpellMgr->LoadSpellGroupStackRules();
+        TC_LOG_INFO("server.loading", "Loading Aggro Spells Definitions...");
+        sSpellMgr->LoadSpellThreats();
 
-    TC_LOG_INFO("server.loading", "Loading NPC Texts...");
-    sObjectMgr->LoadGossipText();
+        TC_LOG_INFO("server.loading", "Loading Spell Group Stack Rules...");
+        sSpellMgr->LoadSpellGroupStackRules();
 
-    TC_LOG_INFO("server.loading", "Loading Enchant Spells Proc datas...");
-    sSpellMgr->LoadSpellEnchantProcData();
+        TC_LOG_INFO("server.loading", "Loading Enchant Spells Proc datas...");
+        sSpellMgr->LoadSpellEnchantProcData();
 
-    TC_LOG_INFO("server.loading", "Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
+        TC_LOG_INFO("server.loading", "Loading Item Random Enchantments Table...");
+        LoadRandomEnchantmentsTable();
 
-    TC_LOG_INFO("server.loading", "Loading Disables");                         // must be before loading quests and items
-    DisableMgr::LoadDisables();
+        TC_LOG_INFO("server.loading", "Loading Disables");                         // must be before loading quests and items
+        DisableMgr::LoadDisables();
 
-    TC_LOG_INFO("server.loading", "Loading Items...");                         // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr->LoadItemTemplates();
+        TC_LOG_INFO("server.loading", "Loading Items...");                         // must be after LoadRandomEnchantmentsTable and LoadPageTexts
+        sObjectMgr->LoadItemTemplates();
 
-    TC_LOG_INFO("server.loading", "Loading Item set names...");                // must be after LoadItemPrototypes
-    sObjectMgr->LoadItemSetNames();
+        TC_LOG_INFO("server.loading", "Loading Item set names...");                // must be after LoadItemPrototypes
+        sObjectMgr->LoadItemSetNames();
 
-    TC_LOG_INFO("server.loading", "Loading Creature Model Based Info Data...");
-    sObjectMgr->LoadCreatureModelInfo();
+        TC_LOG_INFO("server.loading", "Loading Creature Model Based Info Data...");
+        sObjectMgr->LoadCreatureModelInfo();
 
-    TC_LOG_INFO("server.loading", "Loading Creature templates...");
-    sObjectMgr->LoadCreatureTemplates();
+        TC_LOG_INFO("server.loading", "Loading Creature templates...");
+        sObjectMgr->LoadCreatureTemplates();
 
-    TC_LOG_INFO("server.loading", "Loading Equipment templates...");           // must be after LoadCreatureTemplates
-    sObjectMgr->LoadEquipmentTemplates();
+        TC_LOG_INFO("server.loading", "Loading Equipment templates...");           // must be after LoadCreatureTemplates
+        sObjectMgr->LoadEquipmentTemplates();
 
-    TC_LOG_INFO("server.loading", "Loading Creature template addons...");
-    sObjectMgr->LoadCreatureTemplateAddons();
+        TC_LOG_INFO("server.loading", "Loading Creature template addons...");
+        sObjectMgr->LoadCreatureTemplateAddons();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Reputation Reward Rates...");
-    sObjectMgr->LoadReputationRewardRate();
+    loading.AddTask("npc texts", { "broadcast texts" }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading NPC Texts...");
+        sObjectMgr->LoadGossipText();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Creature Reputation OnKill Data...");
-    sObjectMgr->LoadReputationOnKill();
+    loading.AddTask("points of interest", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Points Of Interest Data...");
+        sObjectMgr->LoadPointsOfInterest();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Reputation Spillover Data...");
-    sObjectMgr->LoadReputationSpilloverTemplate();
+    loading.AddStage("spawns", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Reputation Reward Rates...");
+        sObjectMgr->LoadReputationRewardRate();
 
-    TC_LOG_INFO("server.loading", "Loading Points Of Interest Data...");
-    sObjectMgr->LoadPointsOfInterest();
+        TC_LOG_INFO("server.loading", "Loading Creature Reputation OnKill Data...");
+        sObjectMgr->LoadReputationOnKill();
 
-    TC_LOG_INFO("server.loading", "Loading Creature Base Stats...");
-    sObjectMgr->LoadCreatureClassLevelStats();
+        TC_LOG_INFO("server.loading", "Loading Reputation Spillover Data...");
+        sObjectMgr->LoadReputationSpilloverTemplate();
 
-    TC_LOG_INFO("server.loading", "Loading Creature Data...");
-    sObjectMgr->LoadCreatures();
+        TC_LOG_INFO("server.loading", "Loading Creature Base Stats...");
+        sObjectMgr->LoadCreatureClassLevelStats();
 
-    TC_LOG_INFO("server.loading", "Loading Temporary Summon Data...");
-    sObjectMgr->LoadTempSummons();                               // must be after LoadCreatureTemplates() and LoadGameObjectTemplates()
+        TC_LOG_INFO("server.loading", "Loading Creature Data...");
+        sObjectMgr->LoadCreatures();
 
-    TC_LOG_INFO("server.loading", "Loading pet levelup spells...");
-    sSpellMgr->LoadPetLevelupSpellMap();
+        TC_LOG_INFO("server.loading", "Loading Temporary Summon Data...");
+        sObjectMgr->LoadTempSummons();                               // must be after LoadCreatureTemplates() and LoadGameObjectTemplates()
 
-    TC_LOG_INFO("server.loading", "Loading pet default spells additional to levelup spells...");
-    sSpellMgr->LoadPetDefaultSpells();
+        TC_LOG_INFO("server.loading", "Loading pet levelup spells...");
+        sSpellMgr->LoadPetLevelupSpellMap();
 
-    TC_LOG_INFO("server.loading", "Loading Creature Addon Data...");
-    sObjectMgr->LoadCreatureAddons();                            // must be after LoadCreatureTemplates() and LoadCreatures()
+        TC_LOG_INFO("server.loading", "Loading pet default spells additional to levelup spells...");
+        sSpellMgr->LoadPetDefaultSpells();
 
-    TC_LOG_INFO("server.loading", "Loading Gameobject Data...");
-    sObjectMgr->LoadGameobjects();
+        TC_LOG_INFO("server.loading", "Loading Creature Addon Data...");
+        sObjectMgr->LoadCreatureAddons();                            // must be after LoadCreatureTemplates() and LoadCreatures()
 
-    TC_LOG_INFO("server.loading", "Loading GameObject Addon Data...");
-    sObjectMgr->LoadGameObjectAddons();                          // must be after LoadGameObjectTemplate() and LoadGameobjects()
+        TC_LOG_INFO("server.loading", "Loading Gameobject Data...");
+        sObjectMgr->LoadGameobjects();
 
-    TC_LOG_INFO("server.loading", "Loading GameObject Quest Items...");
-    sObjectMgr->LoadGameObjectQuestItems();
+        TC_LOG_INFO("server.loading", "Loading GameObject Addon Data...");
+        sObjectMgr->LoadGameObjectAddons();                          // must be after LoadGameObjectTemplate() and LoadGameobjects()
 
-    TC_LOG_INFO("server.loading", "Loading Creature Quest Items...");
-    sObjectMgr->LoadCreatureQuestItems();
+        TC_LOG_INFO("server.loading", "Loading GameObject Quest Items...");
+        sObjectMgr->LoadGameObjectQuestItems();
 
-    TC_LOG_INFO("server.loading", "Loading Creature Linked Respawn...");
-    sObjectMgr->LoadLinkedRespawn();                             // must be after LoadCreatures(), LoadGameObjects()
+        TC_LOG_INFO("server.loading", "Loading Creature Quest Items...");
+        sObjectMgr->LoadCreatureQuestItems();
 
-    TC_LOG_INFO("server.loading", "Loading Weather Data...");
-    WeatherMgr::LoadWeatherData();
+        TC_LOG_INFO("server.loading", "Loading Creature Linked Respawn...");
+        sObjectMgr->LoadLinkedRespawn();                             // must be after LoadCreatures(), LoadGameObjects()
 
-    TC_LOG_INFO("server.loading", "Loading Quests...");
-    sObjectMgr->LoadQuests();                                    // must be loaded after DBCs, creature_template, item_template, gameobject tables
+        TC_LOG_INFO("server.loading", "Loading Weather Data...");
+        WeatherMgr::LoadWeatherData();
 
-    TC_LOG_INFO("server.loading", "Checking Quest Disables");
-    DisableMgr::CheckQuestDisables();                           // must be after loading quests
+        TC_LOG_INFO("server.loading", "Loading Quests...");
+        sObjectMgr->LoadQuests();                                    // must be loaded after DBCs, creature_template, item_template, gameobject tables
 
-    TC_LOG_INFO("server.loading", "Loading Quest POI");
-    sObjectMgr->LoadQuestPOI();
+        TC_LOG_INFO("server.loading", "Checking Quest Disables");
+        DisableMgr::CheckQuestDisables();                           // must be after loading quests
 
-    TC_LOG_INFO("server.loading", "Loading Quests Starters and Enders...");
-    sObjectMgr->LoadQuestStartersAndEnders();                    // must be after quest load
+        TC_LOG_INFO("server.loading", "Loading Quests Starters and Enders...");
+        sObjectMgr->LoadQuestStartersAndEnders();                    // must be after quest load
 
-    TC_LOG_INFO("server.loading", "Loading Objects Pooling Data...");
-    sPoolMgr->LoadFromDB();
+        TC_LOG_INFO("server.loading", "Loading Objects Pooling Data...");
+        sPoolMgr->LoadFromDB();
 
-    TC_LOG_INFO("server.loading", "Loading Game Event Data...");               // must be after loading pools fully
-    sGameEventMgr->LoadFromDB();
+        TC_LOG_INFO("server.loading", "Loading Game Event Data...");               // must be after loading pools fully
+        sGameEventMgr->LoadFromDB();
 
-    TC_LOG_INFO("server.loading", "Loading UNIT_NPC_FLAG_SPELLCLICK Data..."); // must be after LoadQuests
-    sObjectMgr->LoadNPCSpellClickSpells();
+        TC_LOG_INFO("server.loading", "Loading UNIT_NPC_FLAG_SPELLCLICK Data..."); // must be after LoadQuests
+        sObjectMgr->LoadNPCSpellClickSpells();
 
-    TC_LOG_INFO("server.loading", "Loading Vehicle Template Accessories...");
-    sObjectMgr->LoadVehicleTemplateAccessories();                // must be after LoadCreatureTemplates() and LoadNPCSpellClickSpells()
+        TC_LOG_INFO("server.loading", "Loading Vehicle Template Accessories...");
+        sObjectMgr->LoadVehicleTemplateAccessories();                // must be after LoadCreatureTemplates() and LoadNPCSpellClickSpells()
 
-    TC_LOG_INFO("server.loading", "Loading Vehicle Accessories...");
-    sObjectMgr->LoadVehicleAccessories();                       // must be after LoadCreatureTemplates() and LoadNPCSpellClickSpells()
+        TC_LOG_INFO("server.loading", "Loading Vehicle Accessories...");
+        sObjectMgr->LoadVehicleAccessories();                       // must be after LoadCreatureTemplates() and LoadNPCSpellClickSpells()
 
-    TC_LOG_INFO("server.loading", "Loading SpellArea Data...");                // must be after quest load
-    sSpellMgr->LoadSpellAreas();
+        TC_LOG_INFO("server.loading", "Loading SpellArea Data...");                // must be after quest load
+        sSpellMgr->LoadSpellAreas();
 
-    TC_LOG_INFO("server.loading", "Loading AreaTrigger definitions...");
-    sObjectMgr->LoadAreaTriggerTeleports();
+        TC_LOG_INFO("server.loading", "Loading AreaTrigger definitions...");
+        sObjectMgr->LoadAreaTriggerTeleports();
 
-    TC_LOG_INFO("server.loading", "Loading Access Requirements...");
-    sObjectMgr->LoadAccessRequirements();                        // must be after item template load
+        TC_LOG_INFO("server.loading", "Loading Access Requirements...");
+        sObjectMgr->LoadAccessRequirements();                        // must be after item template load
 
-    TC_LOG_INFO("server.loading", "Loading Quest Area Triggers...");
-    sObjectMgr->LoadQuestAreaTriggers();                         // must be after LoadQuests
+        TC_LOG_INFO("server.loading", "Loading Quest Area Triggers...");
+        sObjectMgr->LoadQuestAreaTriggers();                         // must be after LoadQuests
 
-    TC_LOG_INFO("server.loading", "Loading Tavern Area Triggers...");
-    sObjectMgr->LoadTavernAreaTriggers();
+        TC_LOG_INFO("server.loading", "Loading Tavern Area Triggers...");
+        sObjectMgr->LoadTavernAreaTriggers();
 
-    TC_LOG_INFO("server.loading", "Loading AreaTrigger script names...");
-    sObjectMgr->LoadAreaTriggerScripts();
+        TC_LOG_INFO("server.loading", "Loading AreaTrigger script names...");
+        sObjectMgr->LoadAreaTriggerScripts();
 
-    TC_LOG_INFO("server.loading", "Loading LFG entrance positions..."); // Must be after areatriggers
-    sLFGMgr->LoadLFGDungeons();
+        TC_LOG_INFO("server.loading", "Loading LFG entrance positions..."); // Must be after areatriggers
+        sLFGMgr->LoadLFGDungeons();
 
-    TC_LOG_INFO("server.loading", "Loading Dungeon boss data...");
-    sObjectMgr->LoadInstanceEncounters();
+        TC_LOG_INFO("server.loading", "Loading Dungeon boss data...");
+        sObjectMgr->LoadInstanceEncounters();
 
-    TC_LOG_INFO("server.loading", "Loading LFG rewards...");
-    sLFGMgr->LoadRewards();
+        TC_LOG_INFO("server.loading", "Loading LFG rewards...");
+        sLFGMgr->LoadRewards();
 
-    TC_LOG_INFO("server.loading", "Loading Graveyard-zone links...");
-    sObjectMgr->LoadGraveyardZones();
+        TC_LOG_INFO("server.loading", "Loading Graveyard-zone links...");
+        sObjectMgr->LoadGraveyardZones();
 
-    TC_LOG_INFO("server.loading", "Loading spell pet auras...");
-    sSpellMgr->LoadSpellPetAuras();
+        TC_LOG_INFO("server.loading", "Loading spell pet auras...");
+        sSpellMgr->LoadSpellPetAuras();
 
-    TC_LOG_INFO("server.loading", "Loading Spell target coordinates...");
-    sSpellMgr->LoadSpellTargetPositions();
+        TC_LOG_INFO("server.loading", "Loading Spell target coordinates...");
+        sSpellMgr->LoadSpellTargetPositions();
 
-    TC_LOG_INFO("server.loading", "Loading enchant custom attributes...");
-    sSpellMgr->LoadEnchantCustomAttr();
+        TC_LOG_INFO("server.loading", "Loading enchant custom attributes...");
+        sSpellMgr->LoadEnchantCustomAttr();
 
-    TC_LOG_INFO("server.loading", "Loading linked spells...");
-    sSpellMgr->LoadSpellLinked();
+        TC_LOG_INFO("server.loading", "Loading linked spells...");
+        sSpellMgr->LoadSpellLinked();
 
-    TC_LOG_INFO("server.loading", "Loading Player Create Data...");
-    sObjectMgr->LoadPlayerInfo();
+        TC_LOG_INFO("server.loading", "Loading Player Create Data...");
+        sObjectMgr->LoadPlayerInfo();
 
-    TC_LOG_INFO("server.loading", "Loading Exploration BaseXP Data...");
-    sObjectMgr->LoadExplorationBaseXP();
+        TC_LOG_INFO("server.loading", "Loading Exploration BaseXP Data...");
+        sObjectMgr->LoadExplorationBaseXP();
 
-    TC_LOG_INFO("server.loading", "Loading Pet Name Parts...");
-    sObjectMgr->LoadPetNames();
+        CharacterDatabaseCleaner::CleanDatabase();
 
-    CharacterDatabaseCleaner::CleanDatabase();
+        TC_LOG_INFO("server.loading", "Loading the max pet number...");
+        sObjectMgr->LoadPetNumber();
 
-    TC_LOG_INFO("server.loading", "Loading the max pet number...");
-    sObjectMgr->LoadPetNumber();
+        TC_LOG_INFO("server.loading", "Loading pet level stats...");
+        sObjectMgr->LoadPetLevelInfo();
 
-    TC_LOG_INFO("server.loading", "Loading pet level stats...");
-    sObjectMgr->LoadPetLevelInfo();
+        TC_LOG_INFO("server.loading", "Loading Player level dependent mail rewards...");
+        sObjectMgr->LoadMailLevelRewards();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Player level dependent mail rewards...");
-    sObjectMgr->LoadMailLevelRewards();
+    loading.AddTask("quest poi", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Quest POI");
+        sObjectMgr->LoadQuestPOI();
+    });
+
+    loading.AddTask("pet names", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Pet Name Parts...");
+        sObjectMgr->LoadPetNames();
+    });
 
     // Loot tables
-    LoadLootTables();
+    loading.AddTask("loot templates", { "templates" }, []()
+    {
+        LoadLootTables();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Skill Discovery Table...");
-    LoadSkillDiscoveryTable();
+    loading.AddStage("skills and achievements", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Skill Discovery Table...");
+        LoadSkillDiscoveryTable();
 
-    TC_LOG_INFO("server.loading", "Loading Skill Extra Item Table...");
-    LoadSkillExtraItemTable();
+        TC_LOG_INFO("server.loading", "Loading Skill Extra Item Table...");
+        LoadSkillExtraItemTable();
 
-    TC_LOG_INFO("server.loading", "Loading Skill Perfection Data Table...");
-    LoadSkillPerfectItemTable();
+        TC_LOG_INFO("server.loading", "Loading Skill Perfection Data Table...");
+        LoadSkillPerfectItemTable();
 
-    TC_LOG_INFO("server.loading", "Loading Skill Fishing base level requirements...");
-    sObjectMgr->LoadFishingBaseSkillLevel();
+        TC_LOG_INFO("server.loading", "Loading Skill Fishing base level requirements...");
+        sObjectMgr->LoadFishingBaseSkillLevel();
 
-    TC_LOG_INFO("server.loading", "Loading Achievements...");
-    sAchievementMgr->LoadAchievementReferenceList();
-    TC_LOG_INFO("server.loading", "Loading Achievement Criteria Lists...");
-    sAchievementMgr->LoadAchievementCriteriaList();
-    TC_LOG_INFO("server.loading", "Loading Achievement Criteria Data...");
-    sAchievementMgr->LoadAchievementCriteriaData();
-    TC_LOG_INFO("server.loading", "Loading Achievement Rewards...");
-    sAchievementMgr->LoadRewards();
-    TC_LOG_INFO("server.loading", "Loading Achievement Reward Locales...");
-    sAchievementMgr->LoadRewardLocales();
-    TC_LOG_INFO("server.loading", "Loading Completed Achievements...");
-    sAchievementMgr->LoadCompletedAchievements();
+        TC_LOG_INFO("server.loading", "Loading Achievements...");
+        sAchievementMgr->LoadAchievementReferenceList();
+        TC_LOG_INFO("server.loading", "Loading Achievement Criteria Lists...");
+        sAchievementMgr->LoadAchievementCriteriaList();
+        TC_LOG_INFO("server.loading", "Loading Achievement Criteria Data...");
+        sAchievementMgr->LoadAchievementCriteriaData();
+        TC_LOG_INFO("server.loading", "Loading Achievement Rewards...");
+        sAchievementMgr->LoadRewards();
+        TC_LOG_INFO("server.loading", "Loading Achievement Reward Locales...");
+        sAchievementMgr->LoadRewardLocales();
+        TC_LOG_INFO("server.loading", "Loading Completed Achievements...");
+        sAchievementMgr->LoadCompletedAchievements();
+    });
 
     ///- Load dynamic data tables from the database
-    TC_LOG_INFO("server.loading", "Loading Item Auctions...");
-    sAuctionMgr->LoadAuctionItems();
+    loading.AddStage("dynamic data", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Item Auctions...");
+        sAuctionMgr->LoadAuctionItems();
 
-    TC_LOG_INFO("server.loading", "Loading Auctions...");
-    sAuctionMgr->LoadAuctions();
+        TC_LOG_INFO("server.loading", "Loading Auctions...");
+        sAuctionMgr->LoadAuctions();
 
-    TC_LOG_INFO("server.loading", "Loading Guilds...");
-    sGuildMgr->LoadGuilds();
+        TC_LOG_INFO("server.loading", "Loading Guilds...");
+        sGuildMgr->LoadGuilds();
 
-    TC_LOG_INFO("server.loading", "Loading ArenaTeams...");
-    sArenaTeamMgr->LoadArenaTeams();
+        TC_LOG_INFO("server.loading", "Loading ArenaTeams...");
+        sArenaTeamMgr->LoadArenaTeams();
 
-    TC_LOG_INFO("server.loading", "Loading Groups...");
-    sGroupMgr->LoadGroups();
+        TC_LOG_INFO("server.loading", "Loading Groups...");
+        sGroupMgr->LoadGroups();
 
-    TC_LOG_INFO("server.loading", "Loading ReservedNames...");
-    sObjectMgr->LoadReservedPlayersNames();
+        TC_LOG_INFO("server.loading", "Loading ReservedNames...");
+        sObjectMgr->LoadReservedPlayersNames();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading GameObjects for quests...");
-    sObjectMgr->LoadGameObjectForQuests();
+    loading.AddStage("quest objects", { "loot templates" }, [this]()
+    {
+        TC_LOG_INFO("server.loading", "Loading GameObjects for quests...");
+        sObjectMgr->LoadGameObjectForQuests();
 
-    TC_LOG_INFO("server.loading", "Loading BattleMasters...");
-    sBattlegroundMgr->LoadBattleMastersEntry();                 // must be after load CreatureTemplate
+        TC_LOG_INFO("server.loading", "Loading BattleMasters...");
+        sBattlegroundMgr->LoadBattleMastersEntry();                 // must be after load CreatureTemplate
 
-    TC_LOG_INFO("server.loading", "Loading GameTeleports...");
-    sObjectMgr->LoadGameTele();
+        TC_LOG_INFO("server.loading", "Loading Vendors...");
+        sObjectMgr->LoadVendors();                                   // must be after load CreatureTemplate and ItemTemplate
 
-    TC_LOG_INFO("server.loading", "Loading Gossip menu...");
-    sObjectMgr->LoadGossipMenu();
+        TC_LOG_INFO("server.loading", "Loading Trainers...");
+        sObjectMgr->LoadTrainerSpell();                              // must be after load CreatureTemplate
 
-    TC_LOG_INFO("server.loading", "Loading Gossip menu options...");
-    sObjectMgr->LoadGossipMenuItems();
+        TC_LOG_INFO("server.loading", "Loading Creature Formations...");
+        sFormationMgr->LoadCreatureFormations();
 
-    TC_LOG_INFO("server.loading", "Loading Vendors...");
-    sObjectMgr->LoadVendors();                                   // must be after load CreatureTemplate and ItemTemplate
+        TC_LOG_INFO("server.loading", "Loading World States...");              // must be loaded before battleground, outdoor PvP and conditions
+        LoadWorldStates();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Trainers...");
-    sObjectMgr->LoadTrainerSpell();                              // must be after load CreatureTemplate
+    loading.AddTask("game tele", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading GameTeleports...");
+        sObjectMgr->LoadGameTele();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Waypoints...");
-    sWaypointMgr->Load();
+    loading.AddTask("gossip menus", { "npc texts", "broadcast texts", "points of interest" }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Gossip menu...");
+        sObjectMgr->LoadGossipMenu();
 
-    TC_LOG_INFO("server.loading", "Loading SmartAI Waypoints...");
-    sSmartWaypointMgr->LoadFromDB();
+        TC_LOG_INFO("server.loading", "Loading Gossip menu options...");
+        sObjectMgr->LoadGossipMenuItems();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Creature Formations...");
-    sFormationMgr->LoadCreatureFormations();
+    loading.AddTask("waypoints", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Waypoints...");
+        sWaypointMgr->Load();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading World States...");              // must be loaded before battleground, outdoor PvP and conditions
-    LoadWorldStates();
+    loading.AddTask("smart waypoints", { }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading SmartAI Waypoints...");
+        sSmartWaypointMgr->LoadFromDB();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Conditions...");
-    sConditionMgr->LoadConditions();
+    loading.AddStage("conditions", { "loot templates", "gossip menus" }, [this]()
+    {
+        TC_LOG_INFO("server.loading", "Loading Conditions...");
+        sConditionMgr->LoadConditions();
 
-    TC_LOG_INFO("server.loading", "Loading faction change achievement pairs...");
-    sObjectMgr->LoadFactionChangeAchievements();
+        TC_LOG_INFO("server.loading", "Loading faction change achievement pairs...");
+        sObjectMgr->LoadFactionChangeAchievements();
 
-    TC_LOG_INFO("server.loading", "Loading faction change spell pairs...");
-    sObjectMgr->LoadFactionChangeSpells();
+        TC_LOG_INFO("server.loading", "Loading faction change spell pairs...");
+        sObjectMgr->LoadFactionChangeSpells();
 
-    TC_LOG_INFO("server.loading", "Loading faction change quest pairs...");
-    sObjectMgr->LoadFactionChangeQuests();
+        TC_LOG_INFO("server.loading", "Loading faction change quest pairs...");
+        sObjectMgr->LoadFactionChangeQuests();
 
-    TC_LOG_INFO("server.loading", "Loading faction change item pairs...");
-    sObjectMgr->LoadFactionChangeItems();
+        TC_LOG_INFO("server.loading", "Loading faction change item pairs...");
+        sObjectMgr->LoadFactionChangeItems();
 
-    TC_LOG_INFO("server.loading", "Loading faction change reputation pairs...");
-    sObjectMgr->LoadFactionChangeReputations();
+        TC_LOG_INFO("server.loading", "Loading faction change reputation pairs...");
+        sObjectMgr->LoadFactionChangeReputations();
 
-    TC_LOG_INFO("server.loading", "Loading faction change title pairs...");
-    sObjectMgr->LoadFactionChangeTitles();
+        TC_LOG_INFO("server.loading", "Loading faction change title pairs...");
+        sObjectMgr->LoadFactionChangeTitles();
 
-    TC_LOG_INFO("server.loading", "Loading GM tickets...");
-    sTicketMgr->LoadTickets();
+        TC_LOG_INFO("server.loading", "Loading GM tickets...");
+        sTicketMgr->LoadTickets();
 
-    TC_LOG_INFO("server.loading", "Loading GM surveys...");
-    sTicketMgr->LoadSurveys();
+        TC_LOG_INFO("server.loading", "Loading GM surveys...");
+        sTicketMgr->LoadSurveys();
 
-    TC_LOG_INFO("server.loading", "Loading client addons...");
-    AddonMgr::LoadFromDB();
+        TC_LOG_INFO("server.loading", "Loading client addons...");
+        AddonMgr::LoadFromDB();
 
-    ///- Handle outdated emails (delete/return)
-    TC_LOG_INFO("server.loading", "Returning old mails...");
-    sObjectMgr->ReturnOrDeleteOldMails(false);
+        ///- Handle outdated emails (delete/return)
+        TC_LOG_INFO("server.loading", "Returning old mails...");
+        sObjectMgr->ReturnOrDeleteOldMails(false);
 
-    TC_LOG_INFO("server.loading", "Loading Autobroadcasts...");
-    LoadAutobroadcasts();
+        TC_LOG_INFO("server.loading", "Loading Autobroadcasts...");
+        LoadAutobroadcasts();
 
-    ///- Load and initialize scripts
-    sObjectMgr->LoadSpellScripts();                              // must be after load Creature/Gameobject(Template/Data)
-    sObjectMgr->LoadEventScripts();                              // must be after load Creature/Gameobject(Template/Data)
-    sObjectMgr->LoadWaypointScripts();
+        ///- Load and initialize scripts
+        sObjectMgr->LoadSpellScripts();                              // must be after load Creature/Gameobject(Template/Data)
+        sObjectMgr->LoadEventScripts();                              // must be after load Creature/Gameobject(Template/Data)
+        sObjectMgr->LoadWaypointScripts();
 
-    TC_LOG_INFO("server.loading", "Loading spell script names...");
-    sObjectMgr->LoadSpellScriptNames();
+        TC_LOG_INFO("server.loading", "Loading spell script names...");
+        sObjectMgr->LoadSpellScriptNames();
+    });
+
+    loading.AddTask("creature texts", { "broadcast texts" }, []()
+    {
+        TC_LOG_INFO("server.loading", "Loading Creature Texts...");
+        sCreatureTextMgr->LoadCreatureTexts();
 
-    TC_LOG_INFO("server.loading", "Loading Creature Texts...");
-    sCreatureTextMgr->LoadCreatureTexts();
+        TC_LOG_INFO("server.loading", "Loading Creature Text Locales...");
+        sCreatureTextMgr->LoadCreatureTextLocales();
+    });
 
-    TC_LOG_INFO("server.loading", "Loading Creature Text Locales...");
-    sCreatureTextMgr->LoadCreatureTextLocales();
+    loading.Run(getIntConfig(CONFIG_LOADING_THREADS));
 
     TC_LOG_INFO("server.loading", "Initializing Scripts...");
     sScriptMgr->Initialize();
@@ -2046,6 +2127,19 @@ void World::Update(uint32 diff)
         if (m_updateTimeSum > m_int_configs[CONFIG_INTERVAL_LOG_UPDATE])
         {
             TC_LOG_DEBUG("misc", "Update time diff: %u. Players online: %u.", m_updateTimeSum / m_updateTimeCount, GetActiveSessionCount());
+            sWorldSocketMgr.LogSendStats();
+            sOpcodeProfiler->LogStats(10);
+            CharacterDatabase.LogQueueStats();
+            LoginDatabase.LogQueueStats();
+            WorldDatabase.LogQueueStats();
+            sGridPreloader->LogStats();
+            MapQueryCache::LogStats();
+            PathRequestQueue::LogStats();
+            PathGenerator::LogStats();
+            Unit::LogAuraModifierStats();
+            Unit::LogProcStats();
+            FreeListPool::LogStats();
+            SmartScript::LogEventStats();
             m_updateTimeSum = m_updateTime;
             m_updateTimeCount = 1;
         }
@@ -155,6 +155,7 @@ enum WorldBoolConfigs
     CONFIG_QUEST_ENABLE_QUEST_TRACKER,
     CONFIG_WARDEN_ENABLED,
     CONFIG_ENABLE_MMAPS,
+    CONFIG_MMAP_ASYNC_PATHS,
     CONFIG_WINTERGRASP_ENABLE,
     CONFIG_UI_QUESTLEVELS_IN_DIALOGS,     // Should we add quest levels to the title in the NPC dialogs?
     CONFIG_EVENT_ANNOUNCE,
@@ -174,6 +175,8 @@ enum WorldBoolConfigs
     CONFIG_HOTSWAP_BUILD_FILE_RECREATION_ENABLED,
     CONFIG_HOTSWAP_INSTALL_ENABLED,
     CONFIG_HOTSWAP_PREFIX_CORRECTION_ENABLED,
+    CONFIG_COMPRESSION_PARALLEL,
+    CONFIG_OPCODE_PROFILER,
     BOOL_CONFIG_VALUE_COUNT
 };
 
@@ -204,6 +207,7 @@ enum WorldFloatConfigs
 enum WorldIntConfigs
 {
     CONFIG_COMPRESSION = 0,
+    CONFIG_COMPRESSION_THRESHOLD,
     CONFIG_INTERVAL_SAVE,
     CONFIG_INTERVAL_GRIDCLEAN,
     CONFIG_INTERVAL_MAPUPDATE,
@@ -367,6 +371,12 @@ enum WorldIntConfigs
     CONFIG_AUCTION_GETALL_DELAY,
     CONFIG_AUCTION_SEARCH_DELAY,
     CONFIG_TALENTS_INSPECTING,
+    CONFIG_GRID_PRELOAD_THREADS,
+    CONFIG_GRID_PRELOAD_LOOKAHEAD,
+    CONFIG_MAP_QUERY_CACHE_ENTRIES,
+    CONFIG_MMAP_PATH_BUDGET,
+    CONFIG_SESSION_UPDATE_TIME_BUDGET,
+    CONFIG_LOADING_THREADS,
     INT_CONFIG_VALUE_COUNT
 };
 
@@ -26,6 +26,7 @@ EndScriptData */
 #include "Config.h"
 #include "Language.h"
 #include "ObjectAccessor.h"
+#include "OpcodeProfiler.h"
 #include "Player.h"
 #include "ScriptMgr.h"
 #include "GitRevision.h"
@@ -77,6 +78,7 @@ public:
             { "idleshutdown", rbac::RBAC_PERM_COMMAND_SERVER_IDLESHUTDOWN, true, NULL,                        "", serverIdleShutdownCommandTable },
             { "info",         rbac::RBAC_PERM_COMMAND_SERVER_INFO,         true, &HandleServerInfoCommand,    "" },
             { "motd",         rbac::RBAC_PERM_COMMAND_SERVER_MOTD,         true, &HandleServerMotdCommand,    "" },
+            { "opcodestats",  rbac::RBAC_PERM_COMMAND_SERVER_OPCODESTATS,  true, &HandleServerOpcodeStatsCommand, "" },
             { "plimit",       rbac::RBAC_PERM_COMMAND_SERVER_PLIMIT,       true, &HandleServerPLimitCommand,  "" },
             { "restart",      rbac::RBAC_PERM_COMMAND_SERVER_RESTART,      true, NULL,                        "", serverRestartCommandTable },
             { "shutdown",     rbac::RBAC_PERM_COMMAND_SERVER_SHUTDOWN,     true, NULL,                        "", serverShutdownCommandTable },
@@ -126,6 +128,57 @@ public:
         return true;
     }
 
+    // Display the client opcodes whose handlers took most time since the last reset
+    static bool HandleServerOpcodeStatsCommand(ChatHandler* handler, char const* args)
+    {
+        uint32 count = 10;
+        if (*args)
+        {
+            char* paramStr = strtok((char*)args, " ");
+            if (!paramStr)
+                return false;
+
+            if (strcmp(paramStr, "on") == 0)
+            {
+                sOpcodeProfiler->SetEnabled(true);
+                handler->SendSysMessage("Opcode profiling enabled.");
+                return true;
+            }
+            else if (strcmp(paramStr, "off") == 0)
+            {
+                sOpcodeProfiler->SetEnabled(false);
+                handler->SendSysMessage("Opcode profiling disabled.");
+                return true;
+            }
+            else if (strcmp(paramStr, "reset") == 0)
+            {
+                sOpcodeProfiler->Reset();
+                handler->SendSysMessage("Opcode statistics reset.");
+                return true;
+            }
+
+            int32 value = atoi(paramStr);
+            if (value <= 0)
+                return false;
+
+            count = uint32(value);
+        }
+
+        if (!sOpcodeProfiler->IsEnabled())
+            handler->SendSysMessage("Opcode profiling is disabled, statistics may be outdated.");
+
+        std::vector<OpcodeProfiler::OpcodeStats> stats = sOpcodeProfiler->GetStats();
+        if (stats.size() > count)
+            stats.resize(count);
+
+        for (OpcodeProfiler::OpcodeStats const& opcodeStats : stats)
+            handler->PSendSysMessage("%s: count " UI64FMTD ", total " UI64FMTD " us, avg " UI64FMTD " ns, p99 " UI64FMTD " ns, max " UI64FMTD " ns, " UI64FMTD " bytes",
+                GetOpcodeNameForLogging(opcodeStats.Opcode).c_str(), opcodeStats.Count, opcodeStats.TotalTime / 1000, opcodeStats.TotalTime / opcodeStats.Count,
+                opcodeStats.P99Time, opcodeStats.MaxTime, opcodeStats.Bytes);
+
+        return true;
+    }
+
     static bool HandleServerPLimitCommand(ChatHandler* handler, char const* args)
     {
         if (*args)
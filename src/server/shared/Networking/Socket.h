@@ -21,15 +21,18 @@
 #include "MessageBuffer.h"
 #include "Log.h"
 #include <atomic>
-#include <queue>
+#include <deque>
+#include <limits>
 #include <memory>
 #include <functional>
 #include <type_traits>
+#include <vector>
 #include <boost/asio/ip/tcp.hpp>
 
 using boost::asio::ip::tcp;
 
 #define READ_BLOCK_SIZE 4096
+#define MAX_WRITE_BUFFERS 64     // buffers gathered into a single write, keep below IOV_MAX
 #ifdef BOOST_ASIO_HAS_IOCP
 #define TC_SOCKET_USE_IOCP
 #endif
@@ -39,9 +42,10 @@ class Socket : public std::enable_shared_from_this<T>
 {
 public:
     explicit Socket(tcp::socket&& socket) : _socket(std::move(socket)), _remoteAddress(_socket.remote_endpoint().address()),
-        _remotePort(_socket.remote_endpoint().port()), _readBuffer(), _closed(false), _closing(false), _isWritingAsync(false)
+        _remotePort(_socket.remote_endpoint().port()), _readBuffer(), _closed(false), _closing(false), _isWritingAsync(false), _writeSizeLimit(std::numeric_limits<std::size_t>::max())
     {
         _readBuffer.Resize(READ_BLOCK_SIZE);
+        _writeBuffers.reserve(MAX_WRITE_BUFFERS);
     }
 
     virtual ~Socket()
@@ -103,7 +107,7 @@ public:
 
     void QueuePacket(MessageBuffer&& buffer)
     {
-        _writeQueue.push(std::move(buffer));
+        _writeQueue.push_back(std::move(buffer));
 
 #ifdef TC_SOCKET_USE_IOCP
         AsyncProcessQueue();
@@ -144,8 +148,8 @@ protected:
         _isWritingAsync = true;
 
 #ifdef TC_SOCKET_USE_IOCP
-        MessageBuffer& buffer = _writeQueue.front();
-        _socket.async_write_some(boost::asio::buffer(buffer.GetReadPointer(), buffer.GetActiveSize()), std::bind(&Socket<T>::WriteHandler,
+        PrepareWriteBuffers();
+        _socket.async_write_some(_writeBuffers, std::bind(&Socket<T>::WriteHandler,
             this->shared_from_this(), std::placeholders::_1, std::placeholders::_2));
 #else
         _socket.async_write_some(boost::asio::null_buffers(), std::bind(&Socket<T>::WriteHandlerWrapper,
@@ -155,6 +159,17 @@ protected:
         return false;
     }
 
+    /// Limits the amount of bytes passed to a single write call, 0 means no limit
+    void SetWriteSizeLimit(std::size_t limit)
+    {
+        _writeSizeLimit = limit ? limit : std::numeric_limits<std::size_t>::max();
+    }
+
+    boost::asio::io_service& GetIoService()
+    {
+        return _socket.get_io_service();
+    }
+
     void SetNoDelay(bool enable)
     {
         boost::system::error_code err;
@@ -177,6 +192,42 @@ private:
         ReadHandler();
     }
 
+    /// Gathers the front of the write queue into _writeBuffers, returns the amount of bytes gathered
+    std::size_t PrepareWriteBuffers()
+    {
+        _writeBuffers.clear();
+
+        std::size_t bytes = 0;
+        for (MessageBuffer& buffer : _writeQueue)
+        {
+            std::size_t size = buffer.GetActiveSize();
+            if (!_writeBuffers.empty() && (size > _writeSizeLimit - bytes || _writeBuffers.size() == MAX_WRITE_BUFFERS))
+                break;
+
+            // a single buffer exceeding the limit is sent in parts
+            size = std::min(size, _writeSizeLimit);
+            _writeBuffers.push_back(boost::asio::const_buffer(buffer.GetReadPointer(), size));
+            bytes += size;
+        }
+
+        return bytes;
+    }
+
+    /// Removes written bytes from the write queue
+    void WriteQueueCompleted(std::size_t bytes)
+    {
+        while (bytes && !_writeQueue.empty())
+        {
+            MessageBuffer& buffer = _writeQueue.front();
+            std::size_t written = std::min(bytes, buffer.GetActiveSize());
+            buffer.ReadCompleted(written);
+            bytes -= written;
+
+            if (!buffer.GetActiveSize())
+                _writeQueue.pop_front();
+        }
+    }
+
 #ifdef TC_SOCKET_USE_IOCP
 
     void WriteHandler(boost::system::error_code error, std::size_t transferedBytes)
@@ -184,9 +235,7 @@ private:
         if (!error)
         {
             _isWritingAsync = false;
-            _writeQueue.front().ReadCompleted(transferedBytes);
-            if (!_writeQueue.front().GetActiveSize())
-                _writeQueue.pop();
+            WriteQueueCompleted(transferedBytes);
 
             if (!_writeQueue.empty())
                 AsyncProcessQueue();
@@ -210,37 +259,34 @@ private:
         if (_writeQueue.empty())
             return false;
 
-        MessageBuffer& queuedMessage = _writeQueue.front();
-
-        std::size_t bytesToSend = queuedMessage.GetActiveSize();
+        std::size_t bytesToSend = PrepareWriteBuffers();
 
         boost::system::error_code error;
-        std::size_t bytesSent = _socket.write_some(boost::asio::buffer(queuedMessage.GetReadPointer(), bytesToSend), error);
+        std::size_t bytesSent = _socket.write_some(_writeBuffers, error);
 
         if (error)
         {
             if (error == boost::asio::error::would_block || error == boost::asio::error::try_again)
                 return AsyncProcessQueue();
 
-            _writeQueue.pop();
-            if (_closing && _writeQueue.empty())
-                CloseSocket();
+            // the connection is broken, nothing queued behind the failed write can be sent anymore
+            _writeQueue.clear();
+            CloseSocket();
             return false;
         }
         else if (bytesSent == 0)
         {
-            _writeQueue.pop();
-            if (_closing && _writeQueue.empty())
-                CloseSocket();
+            _writeQueue.clear();
+            CloseSocket();
             return false;
         }
         else if (bytesSent < bytesToSend) // now n > 0
         {
-            queuedMessage.ReadCompleted(bytesSent);
+            WriteQueueCompleted(bytesSent);
             return AsyncProcessQueue();
         }
 
-        _writeQueue.pop();
+        WriteQueueCompleted(bytesSent);
         if (_closing && _writeQueue.empty())
             CloseSocket();
         return !_writeQueue.empty();
@@ -254,12 +300,14 @@ private:
     uint16 _remotePort;
 
     MessageBuffer _readBuffer;
-    std::queue<MessageBuffer> _writeQueue;
+    std::deque<MessageBuffer> _writeQueue;
+    std::vector<boost::asio::const_buffer> _writeBuffers;
 
     std::atomic<bool> _closed;
     std::atomic<bool> _closing;
 
     bool _isWritingAsync;
+    std::size_t _writeSizeLimit;
 };
 
 #endif // __SOCKET_H__
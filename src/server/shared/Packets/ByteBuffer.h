@@ -94,8 +94,27 @@ class TC_SHARED_API ByteBuffer
             return *this;
         }
 
+        ByteBuffer& operator=(ByteBuffer&& right)
+        {
+            if (this != &right)
+            {
+                _rpos = right._rpos;
+                _wpos = right._wpos;
+                _storage = right.Move();
+            }
+
+            return *this;
+        }
+
         virtual ~ByteBuffer() { }
 
+        std::vector<uint8>&& Move()
+        {
+            _rpos = 0;
+            _wpos = 0;
+            return std::move(_storage);
+        }
+
         void clear()
         {
             _storage.clear();
@@ -22,12 +22,18 @@
 #include "DetourNavMeshBuilder.h"
 #include "DetourNavMesh.h"
 #include "IntermediateValues.h"
+#include "Timer.h"
 
+#include <algorithm>
+#include <cinttypes>
 #include <limits.h>
 
 #define MMAP_MAGIC 0x4d4d4150   // 'MMAP'
 #define MMAP_VERSION 5
 
+// input hashes of the tiles built so far, appended after every tile so that interrupted builds resume
+#define MMAP_CHECKPOINT_FILE "mmaps/checkpoint.txt"
+
 struct MmapTileHeader
 {
     uint32 mmapMagic;
@@ -40,11 +46,43 @@ struct MmapTileHeader
         mmapVersion(MMAP_VERSION), size(0), usesLiquids(true) {}
 };
 
+// 64 bit FNV-1a
+static uint64 hashData(uint64 hash, void const* data, size_t size)
+{
+    unsigned char const* bytes = static_cast<unsigned char const*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= UI64LIT(0x100000001B3);
+    }
+    return hash;
+}
+
+// missing files are hashed too, a tile whose input appears or disappears has to be rebuilt
+static uint64 hashFile(uint64 hash, char const* fileName)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (!file)
+        return hashData(hash, "missing", 7);
+
+    unsigned char buffer[65536];
+    while (size_t count = fread(buffer, 1, sizeof(buffer), file))
+        hash = hashData(hash, buffer, count);
+
+    fclose(file);
+    return hash;
+}
+
+static uint32 packCheckpointKey(uint32 mapID, uint32 tileX, uint32 tileY)
+{
+    return (mapID << 16) | (tileX << 8) | tileY;
+}
+
 namespace MMAP
 {
     MapBuilder::MapBuilder(float maxWalkableAngle, bool skipLiquid,
         bool skipContinents, bool skipJunkMaps, bool skipBattlegrounds,
-        bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath) :
+        bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath, bool forceRebuild) :
         m_terrainBuilder     (NULL),
         m_debugOutput        (debugOutput),
         m_offMeshFilePath    (offMeshFilePath),
@@ -53,13 +91,24 @@ namespace MMAP
         m_skipBattlegrounds  (skipBattlegrounds),
         m_maxWalkableAngle   (maxWalkableAngle),
         m_bigBaseUnit        (bigBaseUnit),
+        m_forceRebuild       (forceRebuild),
         m_rcContext          (NULL),
-        _cancelationToken    (false)
+        m_settingsHash       (UI64LIT(0xCBF29CE484222325)),
+        m_checkpointFile     (NULL)
     {
         m_terrainBuilder = new TerrainBuilder(skipLiquid);
 
         m_rcContext = new rcContext(false);
 
+        // everything except the map files that changes the output of all tiles
+        uint32 version[2] = { MMAP_VERSION, uint32(DT_NAVMESH_VERSION) };
+        m_settingsHash = hashData(m_settingsHash, version, sizeof(version));
+        m_settingsHash = hashData(m_settingsHash, &m_maxWalkableAngle, sizeof(m_maxWalkableAngle));
+        bool flags[2] = { m_bigBaseUnit, m_terrainBuilder->usesLiquids() };
+        m_settingsHash = hashData(m_settingsHash, flags, sizeof(flags));
+        if (m_offMeshFilePath)
+            m_settingsHash = hashFile(m_settingsHash, m_offMeshFilePath);
+
         discoverTiles();
     }
 
@@ -74,6 +123,9 @@ namespace MMAP
 
         delete m_terrainBuilder;
         delete m_rcContext;
+
+        if (m_checkpointFile)
+            fclose(m_checkpointFile);
     }
 
     /**************************************************************************/
@@ -160,56 +212,294 @@ namespace MMAP
 
     void MapBuilder::WorkerThread()
     {
-        while (1)
+        // all jobs are queued before the workers start
+        TileBuildJob job;
+        while (_queue.Pop(job))
+            buildTileJob(job);
+    }
+
+    void MapBuilder::buildAllMaps(int threads)
+    {
+        m_tiles.sort([](MapTiles a, MapTiles b)
         {
-            uint32 mapId = 0;
+            return a.m_tiles->size() > b.m_tiles->size();
+        });
 
-            _queue.WaitAndPop(mapId);
+        std::vector<uint32> mapIds;
+        for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+        {
+            uint32 mapId = it->m_mapId;
+            if (!shouldSkipMap(mapId))
+                mapIds.push_back(mapId);
+        }
+
+        buildMaps(mapIds, threads);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::buildMaps(std::vector<uint32> const& mapIds, int threads)
+    {
+        loadCheckpoint();
+
+        // the navmesh parameters of a map depend on all of its tiles, set them up before any tile is built
+        std::vector<MapBuildState*> maps;
+        for (uint32 mapID : mapIds)
+        {
+            std::set<uint32>* tiles = getTileList(mapID);
+
+            // make sure we process maps which don't have tiles
+            if (!tiles->size())
+            {
+                // convert coord bounds to grid bounds
+                uint32 minX, minY, maxX, maxY;
+                getGridBounds(mapID, minX, minY, maxX, maxY);
+
+                // add all tiles within bounds to tile list.
+                for (uint32 i = minX; i <= maxX; ++i)
+                    for (uint32 j = minY; j <= maxY; ++j)
+                        tiles->insert(StaticMapTree::packTileID(i, j));
+            }
 
-            if (_cancelationToken)
-                return;
+            if (tiles->empty())
+            {
+                printf("[Map %03i] Complete!\n", mapID);
+                continue;
+            }
 
-            buildMap(mapId);
+            dtNavMesh* navMesh = NULL;
+            buildNavMesh(mapID, navMesh);
+            if (!navMesh)
+            {
+                printf("[Map %03i] Failed creating navmesh!\n", mapID);
+                continue;
+            }
+
+            MapBuildState* map = new MapBuildState(mapID, uint32(tiles->size()));
+            map->NavMeshParams = *navMesh->getParams();
+            dtFreeNavMesh(navMesh);
+
+            // the models of a tile are referenced by its .vmtile, changes of the models alone are not detected
+            char fileName[255];
+            sprintf(fileName, "vmaps/%03u.vmtree", mapID);
+            map->InputHash = hashData(m_settingsHash, &map->NavMeshParams, sizeof(map->NavMeshParams));
+            map->InputHash = hashFile(map->InputHash, fileName);
+            maps.push_back(map);
+
+            printf("[Map %03i] We have %u tiles.                          \n", mapID, (unsigned int)tiles->size());
+            for (std::set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
+            {
+                TileBuildJob job;
+                job.Map = map;
+
+                // unpack tile coords
+                StaticMapTree::unpackTileID((*it), job.TileX, job.TileY);
+                _queue.Push(job);
+            }
         }
+
+        // every thread takes the next tile as soon as it is done with its last one, regardless of the map
+        for (int i = 0; i < threads; ++i)
+            _workerThreads.push_back(std::thread(&MapBuilder::WorkerThread, this));
+
+        if (threads <= 0)
+            WorkerThread();
+
+        for (auto& thread : _workerThreads)
+            thread.join();
+
+        _workerThreads.clear();
+
+        printTimingReport(maps);
+
+        for (MapBuildState* map : maps)
+            delete map;
     }
 
-    void MapBuilder::buildAllMaps(int threads)
+    /**************************************************************************/
+    void MapBuilder::buildTileJob(TileBuildJob const& job)
     {
-        for (int i = 0; i < threads; ++i)
+        MapBuildState& map = *job.Map;
+        uint32 startTime = getMSTime();
         {
-            _workerThreads.push_back(std::thread(&MapBuilder::WorkerThread, this));
+            std::lock_guard<std::mutex> lock(map.TimeLock);
+            if (!map.Started)
+            {
+                map.Started = true;
+                map.StartTime = startTime;
+            }
         }
 
-        m_tiles.sort([](MapTiles a, MapTiles b)
+        uint64 inputHash = getTileInputHash(map, job.TileX, job.TileY);
+
+        bool skip = false;
+        bool seed = false;
+        if (!m_forceRebuild)
         {
-            return a.m_tiles->size() > b.m_tiles->size();
+            std::lock_guard<std::mutex> lock(m_checkpointLock);
+            auto itr = m_checkpoint.find(packCheckpointKey(map.MapId, job.TileX, job.TileY));
+            if (itr != m_checkpoint.end())
+            {
+                if (itr->second.InputHash == inputHash)
+                    skip = !itr->second.Written || shouldSkipTile(map.MapId, job.TileX, job.TileY);
+            }
+            else
+                skip = seed = shouldSkipTile(map.MapId, job.TileX, job.TileY);
+        }
+
+        if (seed)
+        {
+            // every tile built here gets a checkpoint, so the tile on disk was built before checkpoints
+            // existed and is assumed to match its current inputs
+            TileCheckpoint checkpoint;
+            checkpoint.InputHash = inputHash;
+            checkpoint.Written = true;
+            saveCheckpoint(map.MapId, job.TileX, job.TileY, checkpoint);
+        }
+
+        if (skip)
+            ++map.SkippedTiles;
+        else
+        {
+            // tiles are only added to the navmesh to validate them, every job uses its own
+            dtNavMesh* navMesh = dtAllocNavMesh();
+            if (navMesh->init(&map.NavMeshParams))
+            {
+                if (buildTile(map.MapId, job.TileX, job.TileY, navMesh))
+                {
+                    TileCheckpoint checkpoint;
+                    checkpoint.InputHash = inputHash;
+                    checkpoint.Written = shouldSkipTile(map.MapId, job.TileX, job.TileY);
+                    saveCheckpoint(map.MapId, job.TileX, job.TileY, checkpoint);
+                }
+            }
+            else
+                printf("[Map %03i] Failed creating navmesh!\n", map.MapId);
+
+            dtFreeNavMesh(navMesh);
+
+            uint32 buildTime = GetMSTimeDiffToNow(startTime);
+            printf("[Map %03i] [%02u,%02u]: Built in %u ms\n", map.MapId, job.TileX, job.TileY, buildTime);
+
+            ++map.BuiltTiles;
+            map.BuildTime += buildTime;
+
+            std::lock_guard<std::mutex> lock(map.TimeLock);
+            if (buildTime >= map.SlowestTileTime)
+            {
+                map.SlowestTileTime = buildTime;
+                map.SlowestTile = StaticMapTree::packTileID(job.TileX, job.TileY);
+            }
+        }
+
+        if (--map.RemainingTiles)
+            return;
+
+        uint32 wallTime;
+        {
+            std::lock_guard<std::mutex> lock(map.TimeLock);
+            map.WallTime = wallTime = GetMSTimeDiffToNow(map.StartTime);
+        }
+
+        printf("[Map %03i] Complete! %u tiles built, %u unchanged, %u ms\n", map.MapId, uint32(map.BuiltTiles), uint32(map.SkippedTiles), wallTime);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::printTimingReport(std::vector<MapBuildState*> const& maps) const
+    {
+        if (maps.empty())
+            return;
+
+        std::vector<MapBuildState*> sorted(maps);
+        std::sort(sorted.begin(), sorted.end(), [](MapBuildState const* a, MapBuildState const* b)
+        {
+            return a->BuildTime > b->BuildTime;
         });
 
-        for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+        printf("\n Map | Built | Unchanged | Tile time (s) | Wall time (s) | Avg tile (ms) | Slowest tile\n");
+        for (MapBuildState const* map : sorted)
         {
-            uint32 mapId = it->m_mapId;
-            if (!shouldSkipMap(mapId))
+            uint32 built = map->BuiltTiles;
+            uint64 buildTime = map->BuildTime;
+            uint32 slowestX = 0, slowestY = 0;
+            StaticMapTree::unpackTileID(map->SlowestTile, slowestX, slowestY);
+
+            printf(" %03u | %5u | %9u | %13.1f | %13.1f | %13u | ", map->MapId, built, uint32(map->SkippedTiles),
+                float(buildTime) / 1000.0f, float(map->WallTime) / 1000.0f, built ? uint32(buildTime / built) : 0);
+
+            if (built)
+                printf("[%02u,%02u] %u ms\n", slowestX, slowestY, map->SlowestTileTime);
+            else
+                printf("-\n");
+        }
+        printf("\n");
+    }
+
+    /**************************************************************************/
+    void MapBuilder::loadCheckpoint()
+    {
+        if (m_checkpointFile)
+            return;
+
+        if (FILE* file = fopen(MMAP_CHECKPOINT_FILE, "r"))
+        {
+            uint32 mapID, tileX, tileY, written;
+            uint64 inputHash;
+            while (fscanf(file, "%u %u %u %" SCNu64 " %u", &mapID, &tileX, &tileY, &inputHash, &written) == 5)
             {
-                if (threads > 0)
-                    _queue.Push(mapId);
-                else
-                    buildMap(mapId);
+                TileCheckpoint& checkpoint = m_checkpoint[packCheckpointKey(mapID, tileX, tileY)];
+                checkpoint.InputHash = inputHash;
+                checkpoint.Written = written != 0;
             }
+            fclose(file);
+
+            printf("Loaded %u tile checkpoints, unchanged tiles will be skipped.\n", uint32(m_checkpoint.size()));
         }
 
-        while (!_queue.Empty())
+        // rewrite it without the entries of rebuilt tiles, new ones are appended as tiles finish
+        m_checkpointFile = fopen(MMAP_CHECKPOINT_FILE, "w");
+        if (!m_checkpointFile)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+            perror("Failed to open " MMAP_CHECKPOINT_FILE " for writing, interrupted builds will start over!\n");
+            return;
         }
 
-        _cancelationToken = true;
+        for (std::map<uint32, TileCheckpoint>::const_iterator itr = m_checkpoint.begin(); itr != m_checkpoint.end(); ++itr)
+            fprintf(m_checkpointFile, "%u %u %u " UI64FMTD " %u\n", itr->first >> 16, (itr->first >> 8) & 0xFF, itr->first & 0xFF,
+                itr->second.InputHash, uint32(itr->second.Written));
 
-        _queue.Cancel();
+        fflush(m_checkpointFile);
+    }
 
-        for (auto& thread : _workerThreads)
+    /**************************************************************************/
+    void MapBuilder::saveCheckpoint(uint32 mapID, uint32 tileX, uint32 tileY, TileCheckpoint const& checkpoint)
+    {
+        std::lock_guard<std::mutex> lock(m_checkpointLock);
+        m_checkpoint[packCheckpointKey(mapID, tileX, tileY)] = checkpoint;
+
+        if (!m_checkpointFile)
+            return;
+
+        fprintf(m_checkpointFile, "%u %u %u " UI64FMTD " %u\n", mapID, tileX, tileY, checkpoint.InputHash, uint32(checkpoint.Written));
+        fflush(m_checkpointFile);
+    }
+
+    /**************************************************************************/
+    uint64 MapBuilder::getTileInputHash(MapBuildState const& map, uint32 tileX, uint32 tileY) const
+    {
+        uint64 hash = map.InputHash;
+        char fileName[255];
+
+        // the heightmap of the tile and the borders of its neighbours, see TerrainBuilder::loadMap
+        static int const neighbours[5][2] = { { 0, 0 }, { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        for (int i = 0; i < 5; ++i)
         {
-            thread.join();
+            sprintf(fileName, "maps/%03u%02i%02i.map", map.MapId, int(tileY) + neighbours[i][1], int(tileX) + neighbours[i][0]);
+            hash = hashFile(hash, fileName);
         }
+
+        // buildTile passes the coordinates swapped to loadVMap
+        sprintf(fileName, "vmaps/%s", StaticMapTree::getTileFileName(map.MapId, tileY, tileX).c_str());
+        return hashFile(hash, fileName);
     }
 
     /**************************************************************************/
@@ -358,61 +648,13 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildMap(uint32 mapID)
+    void MapBuilder::buildMap(uint32 mapID, int threads)
     {
-#ifndef __APPLE__
-        //printf("[Thread %u] Building map %03u:\n", uint32(ACE_Thread::self()), mapID);
-#endif
-
-        std::set<uint32>* tiles = getTileList(mapID);
-
-        // make sure we process maps which don't have tiles
-        if (!tiles->size())
-        {
-            // convert coord bounds to grid bounds
-            uint32 minX, minY, maxX, maxY;
-            getGridBounds(mapID, minX, minY, maxX, maxY);
-
-            // add all tiles within bounds to tile list.
-            for (uint32 i = minX; i <= maxX; ++i)
-                for (uint32 j = minY; j <= maxY; ++j)
-                    tiles->insert(StaticMapTree::packTileID(i, j));
-        }
-
-        if (!tiles->empty())
-        {
-            // build navMesh
-            dtNavMesh* navMesh = NULL;
-            buildNavMesh(mapID, navMesh);
-            if (!navMesh)
-            {
-                printf("[Map %03i] Failed creating navmesh!\n", mapID);
-                return;
-            }
-
-            // now start building mmtiles for each tile
-            printf("[Map %03i] We have %u tiles.                          \n", mapID, (unsigned int)tiles->size());
-            for (std::set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
-            {
-                uint32 tileX, tileY;
-
-                // unpack tile coords
-                StaticMapTree::unpackTileID((*it), tileX, tileY);
-
-                if (shouldSkipTile(mapID, tileX, tileY))
-                    continue;
-
-                buildTile(mapID, tileX, tileY, navMesh);
-            }
-
-            dtFreeNavMesh(navMesh);
-        }
-
-        printf("[Map %03i] Complete!\n", mapID);
+        buildMaps(std::vector<uint32>(1, mapID), threads);
     }
 
     /**************************************************************************/
-    void MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
+    bool MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
     {
         printf("[Map %03i] Building tile [%02u,%02u]\n", mapID, tileX, tileY);
 
@@ -426,7 +668,7 @@ namespace MMAP
 
         // if there is no data, give up now
         if (!meshData.solidVerts.size() && !meshData.liquidVerts.size())
-            return;
+            return true;
 
         // remove unused vertices
         TerrainBuilder::cleanVertices(meshData.solidVerts, meshData.solidTris);
@@ -438,7 +680,7 @@ namespace MMAP
         allVerts.append(meshData.solidVerts);
 
         if (!allVerts.size())
-            return;
+            return true;
 
         // get bounds of current tile
         float bmin[3], bmax[3];
@@ -447,7 +689,7 @@ namespace MMAP
         m_terrainBuilder->loadOffMeshConnections(mapID, tileX, tileY, meshData, m_offMeshFilePath);
 
         // build navmesh tile
-        buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
+        return buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
     }
 
     /**************************************************************************/
@@ -504,6 +746,8 @@ namespace MMAP
         if (!navMesh->init(&navMeshParams))
         {
             printf("[Map %03i] Failed creating navmesh!                \n", mapID);
+            dtFreeNavMesh(navMesh);
+            navMesh = NULL;
             return;
         }
 
@@ -514,6 +758,7 @@ namespace MMAP
         if (!file)
         {
             dtFreeNavMesh(navMesh);
+            navMesh = NULL;
             char message[1024];
             sprintf(message, "[Map %03i] Failed to open %s for writing!\n", mapID, fileName);
             perror(message);
@@ -526,7 +771,7 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
+    bool MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
         MeshData &meshData, float bmin[3], float bmax[3],
         dtNavMesh* navMesh)
     {
@@ -703,7 +948,7 @@ namespace MMAP
             delete[] pmmerge;
             delete[] dmmerge;
             delete[] tiles;
-            return;
+            return false;
         }
         rcMergePolyMeshes(m_rcContext, pmmerge, nmerge, *iv.polyMesh);
 
@@ -714,7 +959,7 @@ namespace MMAP
             delete[] pmmerge;
             delete[] dmmerge;
             delete[] tiles;
-            return;
+            return false;
         }
         rcMergePolyMeshDetails(m_rcContext, dmmerge, nmerge, *iv.polyMeshDetail);
 
@@ -768,6 +1013,9 @@ namespace MMAP
         unsigned char* navData = NULL;
         int navDataSize = 0;
 
+        // tiles without anything to build on count as built, only errors leave them to be built again
+        bool success = false;
+
         do
         {
             // these values are checked within dtCreateNavMeshData - handle them here
@@ -789,6 +1037,7 @@ namespace MMAP
 
                 // message is an annoyance
                 //printf("%sNo vertices to build tile!              \n", tileString);
+                success = true;
                 break;
             }
             if (!params.polyCount || !params.polys ||
@@ -798,6 +1047,7 @@ namespace MMAP
                 // keep in mind that we do output those into debug info
                 // drop tiles with only exact count - some tiles may have geometry while having less tiles
                 printf("%s No polygons to build on tile!              \n", tileString);
+                success = true;
                 break;
             }
             if (!params.detailMeshes || !params.detailVerts || !params.detailTris)
@@ -851,6 +1101,7 @@ namespace MMAP
 
             // now that tile is written to disk, we can unload it
             navMesh->removeTile(tileRef, NULL, NULL);
+            success = true;
         }
         while (0);
 
@@ -867,6 +1118,8 @@ namespace MMAP
             iv.generateObjFile(mapID, tileX, tileY, meshData);
             iv.writeIV(mapID, tileX, tileY);
         }
+
+        return success;
     }
 
     /**************************************************************************/
@@ -28,7 +28,9 @@
 #include <vector>
 #include <set>
 #include <list>
+#include <map>
 #include <atomic>
+#include <mutex>
 #include <thread>
 
 using namespace VMAP;
@@ -71,6 +73,46 @@ namespace MMAP
         rcPolyMeshDetail* dmesh;
     };
 
+    // a map whose tiles are being built, shared by the tile jobs of the map
+    struct MapBuildState
+    {
+        MapBuildState(uint32 mapId, uint32 tileCount) : MapId(mapId), InputHash(0), RemainingTiles(tileCount),
+            BuiltTiles(0), SkippedTiles(0), BuildTime(0), SlowestTileTime(0), SlowestTile(0), Started(false), StartTime(0), WallTime(0)
+        {
+            memset(&NavMeshParams, 0, sizeof(NavMeshParams));
+        }
+
+        uint32 MapId;
+        dtNavMeshParams NavMeshParams;
+        uint64 InputHash;                       // inputs shared by all tiles: navmesh params, vmtree, settings
+
+        std::atomic<uint32> RemainingTiles;
+        std::atomic<uint32> BuiltTiles;
+        std::atomic<uint32> SkippedTiles;
+        std::atomic<uint64> BuildTime;          // milliseconds spent building tiles, summed over all threads
+
+        std::mutex TimeLock;                    // guards the members below
+        uint32 SlowestTileTime;
+        uint32 SlowestTile;
+        bool Started;
+        uint32 StartTime;
+        uint32 WallTime;                        // milliseconds from the first tile started until the last one finished
+    };
+
+    struct TileBuildJob
+    {
+        MapBuildState* Map;
+        uint32 TileX;
+        uint32 TileY;
+    };
+
+    // input hash of every tile built so far and whether it produced a .mmtile
+    struct TileCheckpoint
+    {
+        uint64 InputHash;
+        bool Written;
+    };
+
     class MapBuilder
     {
         public:
@@ -81,12 +123,13 @@ namespace MMAP
                 bool skipBattlegrounds   = false,
                 bool debugOutput         = false,
                 bool bigBaseUnit         = false,
-                const char* offMeshFilePath = NULL);
+                const char* offMeshFilePath = NULL,
+                bool forceRebuild        = false);
 
             ~MapBuilder();
 
             // builds all mmap tiles for the specified map id (ignores skip settings)
-            void buildMap(uint32 mapID);
+            void buildMap(uint32 mapID, int threads = 0);
             void buildMeshFromFile(char* name);
 
             // builds an mmap tile for the specified map and its mesh
@@ -98,16 +141,26 @@ namespace MMAP
             void WorkerThread();
 
         private:
+            // builds the tiles of all given maps, spreading single tiles over the threads
+            void buildMaps(std::vector<uint32> const& mapIds, int threads);
+            void buildTileJob(TileBuildJob const& job);
+            void printTimingReport(std::vector<MapBuildState*> const& maps) const;
+
+            // incremental builds - tiles are only rebuilt if one of their input files changed
+            void loadCheckpoint();
+            void saveCheckpoint(uint32 mapID, uint32 tileX, uint32 tileY, TileCheckpoint const& checkpoint);
+            uint64 getTileInputHash(MapBuildState const& map, uint32 tileX, uint32 tileY) const;
+
             // detect maps and tiles
             void discoverTiles();
             std::set<uint32>* getTileList(uint32 mapID);
 
             void buildNavMesh(uint32 mapID, dtNavMesh* &navMesh);
 
-            void buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
+            bool buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
 
             // move map building
-            void buildMoveMapTile(uint32 mapID,
+            bool buildMoveMapTile(uint32 mapID,
                 uint32 tileX,
                 uint32 tileY,
                 MeshData &meshData,
@@ -136,13 +189,18 @@ namespace MMAP
 
             float m_maxWalkableAngle;
             bool m_bigBaseUnit;
+            bool m_forceRebuild;
 
             // build performance - not really used for now
             rcContext* m_rcContext;
 
             std::vector<std::thread> _workerThreads;
-            ProducerConsumerQueue<uint32> _queue;
-            std::atomic<bool> _cancelationToken;
+            ProducerConsumerQueue<TileBuildJob> _queue;
+
+            uint64 m_settingsHash;                  // build settings and offmesh connections
+            std::map<uint32, TileCheckpoint> m_checkpoint;
+            std::mutex m_checkpointLock;
+            FILE* m_checkpointFile;
     };
 }
 
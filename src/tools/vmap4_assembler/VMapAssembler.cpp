@@ -16,25 +16,86 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <iostream>
+#include <thread>
+
+#include <boost/filesystem.hpp>
 
 #include "TileAssembler.h"
 
+// 64 bit FNV-1a of all files in the directory, in the order of their names
+uint64 checksumDirectory(std::string const& dir)
+{
+    namespace fs = boost::filesystem;
+
+    std::vector<fs::path> files;
+    for (fs::directory_iterator itr(dir); itr != fs::directory_iterator(); ++itr)
+        if (fs::is_regular_file(itr->status()))
+            files.push_back(itr->path());
+
+    std::sort(files.begin(), files.end());
+
+    uint64 hash = UI64LIT(0xCBF29CE484222325);
+    for (fs::path const& file : files)
+    {
+        std::string name = file.filename().string();
+        for (char c : name)
+        {
+            hash ^= uint8(c);
+            hash *= UI64LIT(0x100000001B3);
+        }
+
+        FILE* f = fopen(file.string().c_str(), "rb");
+        if (!f)
+            continue;
+
+        unsigned char buffer[65536];
+        while (size_t count = fread(buffer, 1, sizeof(buffer), f))
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                hash ^= buffer[i];
+                hash *= UI64LIT(0x100000001B3);
+            }
+        }
+        fclose(f);
+    }
+
+    return hash;
+}
+
 int main(int argc, char* argv[])
 {
-    if (argc != 3)
+    uint32 threads = std::max(std::thread::hardware_concurrency(), 1u);
+    bool checksum = false;
+    std::vector<std::string> dirs;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--checksum") == 0)
+            checksum = true;
+        else
+            dirs.push_back(argv[i]);
+    }
+
+    if (dirs.size() != 2)
     {
-        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir>" << std::endl;
+        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir> [--threads #] [--checksum]" << std::endl;
+        std::cout << "  --threads   number of maps and models converted at once, default: number of cores" << std::endl;
+        std::cout << "  --checksum  print a checksum of the output, equal for all thread counts" << std::endl;
         return 1;
     }
 
-    std::string src = argv[1];
-    std::string dest = argv[2];
+    std::string src = dirs[0];
+    std::string dest = dirs[1];
 
-    std::cout << "using " << src << " as source directory and writing output to " << dest << std::endl;
+    std::cout << "using " << src << " as source directory and writing output to " << dest << " with " << threads << " threads" << std::endl;
 
-    VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest);
+    VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest, threads);
 
     if (!ta->convertWorld2())
     {
@@ -44,6 +105,10 @@ int main(int argc, char* argv[])
     }
 
     delete ta;
+
+    if (checksum)
+        printf("Output checksum: %016" PRIX64 "\n", checksumDirectory(dest));
+
     std::cout << "Ok, all done" << std::endl;
     return 0;
 }
@@ -95,7 +95,7 @@ void ExtractGameobjectModels()
         bool result = false;
         if (!strcmp(ch_ext, ".wmo"))
         {
-            result = ExtractSingleWmo(path);
+            result = ExtractSingleWmo(path, gOpenArchives);
         }
         else if (!strcmp(ch_ext, ".mdl"))
         {
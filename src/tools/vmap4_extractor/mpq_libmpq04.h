@@ -27,13 +27,19 @@
 #include <vector>
 #include <deque>
 
+class MPQArchive;
+typedef std::deque<MPQArchive*> ArchiveSet;
+
+// archives opened by the main thread, workers reading files at the same time open their own ones
+extern ArchiveSet gOpenArchives;
+
 class MPQArchive
 {
 
 public:
     mpq_archive_s *mpq_a;
 
-    MPQArchive(const char* filename);
+    MPQArchive(const char* filename, ArchiveSet& archives);
     ~MPQArchive() { close(); }
 
     void GetFileListTo(std::vector<std::string>& filelist) {
@@ -67,7 +73,6 @@ public:
 private:
     void close();
 };
-typedef std::deque<MPQArchive*> ArchiveSet;
 
 class MPQFile
 {
@@ -80,7 +85,7 @@ class MPQFile
     void operator=(const MPQFile& /*f*/) = delete;
 
 public:
-    MPQFile(const char* filename);    // filenames are not case sensitive
+    MPQFile(const char* filename, ArchiveSet const& archives = gOpenArchives);    // filenames are not case sensitive
     ~MPQFile() { close(); }
     size_t read(void* dest, size_t bytes);
     size_t getSize() { return size; }
@@ -33,8 +33,11 @@
     #include <sys/stat.h>
 #endif
 
+#include <atomic>
 #include <cstdio>
 #include <iostream>
+#include <set>
+#include <thread>
 #include <vector>
 #include <errno.h>
 
@@ -48,8 +51,6 @@
 
 //-----------------------------------------------------------------------------
 
-extern ArchiveSet gOpenArchives;
-
 typedef struct
 {
     char name[64];
@@ -63,6 +64,7 @@ char output_path[128]=".";
 char input_path[1024]=".";
 bool hasInputPathParam = false;
 bool preciseVectorData = false;
+uint32 threadCount = std::max(std::thread::hardware_concurrency(), 1u);
 
 // Constants
 
@@ -113,38 +115,91 @@ void ReadLiquidTypeTableDBC()
     printf("Done! (%u LiqTypes loaded)\n", (unsigned int)LiqType_count);
 }
 
-bool ExtractWmo()
+void OpenArchives(std::vector<std::string> const& archiveNames, ArchiveSet& archives)
+{
+    for (size_t i=0; i < archiveNames.size(); ++i)
+    {
+        MPQArchive *archive = new MPQArchive(archiveNames[i].c_str(), archives);
+        if (archives.empty() || archives.front() != archive)
+            delete archive;
+    }
+}
+
+void CloseArchives(ArchiveSet& archives)
 {
-    bool success = true;
+    for (ArchiveSet::const_iterator ar_itr = archives.begin(); ar_itr != archives.end(); ++ar_itr)
+        delete *ar_itr;
+
+    archives.clear();
+}
 
+bool ExtractWmo(std::vector<std::string> const& archiveNames)
+{
     //const char* ParsArchiveNames[] = {"patch-2.MPQ", "patch.MPQ", "common.MPQ", "expansion.MPQ"};
 
-    for (ArchiveSet::const_iterator ar_itr = gOpenArchives.begin(); ar_itr != gOpenArchives.end() && success; ++ar_itr)
+    // files with the same name are written to the same output file, the first one listed wins
+    std::vector<std::string> wmoFiles;
+    std::set<std::string> localFiles;
+    for (ArchiveSet::const_iterator ar_itr = gOpenArchives.begin(); ar_itr != gOpenArchives.end(); ++ar_itr)
     {
         std::vector<std::string> filelist;
 
         (*ar_itr)->GetFileListTo(filelist);
-        for (std::vector<std::string>::iterator fname = filelist.begin(); fname != filelist.end() && success; ++fname)
+        for (std::vector<std::string>::iterator fname = filelist.begin(); fname != filelist.end(); ++fname)
         {
-            if (fname->find(".wmo") != std::string::npos)
-                success = ExtractSingleWmo(*fname);
+            if (fname->find(".wmo") != std::string::npos && localFiles.insert(GetLocalWmoName(*fname)).second)
+                wmoFiles.push_back(*fname);
         }
     }
 
-    if (success)
+    // every model is written to its own file, so they can be extracted in any order
+    std::atomic<uint32> next(0);
+    std::atomic<bool> failed(false);
+    // libmpq keeps the read state in the archive handles, so every worker reads through its own ones
+    auto worker = [&](bool ownArchives)
+    {
+        ArchiveSet workerArchives;
+        if (ownArchives)
+            OpenArchives(archiveNames, workerArchives);
+
+        ArchiveSet const& archives = ownArchives ? workerArchives : gOpenArchives;
+        for (uint32 i = next++; i < wmoFiles.size() && !failed; i = next++)
+            if (!ExtractSingleWmo(wmoFiles[i], archives))
+                failed = true;
+
+        CloseArchives(workerArchives);
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32 i = 1; i < threadCount; ++i)
+        workers.push_back(std::thread(worker, true));
+
+    worker(false);
+
+    for (std::thread& thread : workers)
+        thread.join();
+
+    if (!failed)
         printf("\nExtract wmo complete (No (fatal) errors)\n");
 
-    return success;
+    return !failed;
+}
+
+std::string GetLocalWmoName(std::string const& fname)
+{
+    char szLocalFile[1024];
+    sprintf(szLocalFile, "%s/%s", szWorkDirWmo, GetPlainName(fname.c_str()));
+    fixnamen(szLocalFile,strlen(szLocalFile));
+    return szLocalFile;
 }
 
-bool ExtractSingleWmo(std::string& fname)
+bool ExtractSingleWmo(std::string& fname, ArchiveSet const& archives)
 {
     // Copy files from archive
 
-    char szLocalFile[1024];
     const char * plain_name = GetPlainName(fname.c_str());
-    sprintf(szLocalFile, "%s/%s", szWorkDirWmo, plain_name);
-    fixnamen(szLocalFile,strlen(szLocalFile));
+    std::string localFile = GetLocalWmoName(fname);
+    const char* szLocalFile = localFile.c_str();
 
     if (FileExists(szLocalFile))
         return true;
@@ -168,9 +223,9 @@ bool ExtractSingleWmo(std::string& fname)
         return true;
 
     bool file_ok = true;
-    std::cout << "Extracting " << fname << std::endl;
+    printf("Extracting %s\n", fname.c_str());
     WMORoot froot(fname);
-    if(!froot.open())
+    if(!froot.open(archives))
     {
         printf("Couldn't open RootWmo!!!\n");
         return true;
@@ -197,7 +252,7 @@ bool ExtractSingleWmo(std::string& fname)
 
             std::string s = groupFileName;
             WMOGroup fgroup(s);
-            if(!fgroup.open())
+            if(!fgroup.open(archives))
             {
                 printf("Could not open all Group file for: %s\n", plain_name);
                 file_ok = false;
@@ -407,6 +462,18 @@ bool processArgv(int argc, char ** argv, const char *versionString)
         {
             preciseVectorData = true;
         }
+        else if(strcmp("-t",argv[i]) == 0)
+        {
+            if((i+1)<argc)
+            {
+                threadCount = std::max(atoi(argv[i + 1]), 1);
+                ++i;
+            }
+            else
+            {
+                result = false;
+            }
+        }
         else
         {
             result = false;
@@ -416,10 +483,11 @@ bool processArgv(int argc, char ** argv, const char *versionString)
     if(!result)
     {
         printf("Extract %s.\n",versionString);
-        printf("%s [-?][-s][-l][-d <path>]\n", argv[0]);
+        printf("%s [-?][-s][-l][-d <path>][-t <threads>]\n", argv[0]);
         printf("   -s : (default) small size (data size optimization), ~500MB less vmap data.\n");
         printf("   -l : large size, ~500MB more vmap data. (might contain more details)\n");
         printf("   -d <path>: Path to the vector data source folder.\n");
+        printf("   -t <threads>: Number of models extracted at once, default: number of cores.\n");
         printf("   -? : This message.\n");
     }
     return result;
@@ -472,12 +540,7 @@ int main(int argc, char ** argv)
     // prepare archive name list
     std::vector<std::string> archiveNames;
     fillArchiveNameVector(archiveNames);
-    for (size_t i=0; i < archiveNames.size(); ++i)
-    {
-        MPQArchive *archive = new MPQArchive(archiveNames[i].c_str());
-        if (gOpenArchives.empty() || gOpenArchives.front() != archive)
-            delete archive;
-    }
+    OpenArchives(archiveNames, gOpenArchives);
 
     if (gOpenArchives.empty())
     {
@@ -488,7 +551,7 @@ int main(int argc, char ** argv)
 
     // extract data
     if (success)
-        success = ExtractWmo();
+        success = ExtractWmo(archiveNames);
 
     //xxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
     //map.dbc
@@ -19,6 +19,8 @@
 #ifndef VMAPEXPORT_H
 #define VMAPEXPORT_H
 
+#include "mpq_libmpq04.h"
+
 #include <string>
 
 enum ModelFlags
@@ -34,7 +36,8 @@ extern const char * szRawVMAPMagic;                         // vmap magic string
 bool FileExists(const char * file);
 void strToLower(char* str);
 
-bool ExtractSingleWmo(std::string& fname);
+bool ExtractSingleWmo(std::string& fname, ArchiveSet const& archives);
+std::string GetLocalWmoName(std::string const& fname);
 bool ExtractSingleModel(std::string& fname);
 
 void ExtractGameobjectModels();
@@ -37,9 +37,9 @@ WMORoot::WMORoot(std::string &filename)
     memset(bbcorn2, 0, sizeof(bbcorn2));
 }
 
-bool WMORoot::open()
+bool WMORoot::open(ArchiveSet const& archives)
 {
-    MPQFile f(filename.c_str());
+    MPQFile f(filename.c_str(), archives);
     if(f.isEof ())
     {
         printf("No such file.\n");
@@ -145,9 +145,9 @@ WMOGroup::WMOGroup(const std::string &filename) :
     memset(bbcorn2, 0, sizeof(bbcorn2));
 }
 
-bool WMOGroup::open()
+bool WMOGroup::open(ArchiveSet const& archives)
 {
-    MPQFile f(filename.c_str());
+    MPQFile f(filename.c_str(), archives);
     if(f.isEof ())
     {
         printf("No such file.\n");
@@ -25,6 +25,7 @@
 #include <set>
 #include "vec3d.h"
 #include "loadlib/loadlib.h"
+#include "mpq_libmpq04.h"
 
 // MOPY flags
 #define WMO_MATERIAL_NOCAMCOLLIDE    0x01
@@ -54,7 +55,7 @@ public:
 
     WMORoot(std::string& filename);
 
-    bool open();
+    bool open(ArchiveSet const& archives);
     bool ConvertToVMAPRootWmo(FILE* output);
 };
 
@@ -113,7 +114,7 @@ public:
     WMOGroup(std::string const& filename);
     ~WMOGroup();
 
-    bool open();
+    bool open(ArchiveSet const& archives);
     int ConvertToVMAPGroupWmo(FILE* output, WMORoot* rootWMO, bool preciseVectorData);
 };
 